@@ -14,6 +14,9 @@
 #
 # For sequential tests set topology to 1 1 1
 #
+# Each test cleans the outputs out of its directory before it runs, so
+# the tests of a directory hold a lock on it and are never run together.
+#
 function (pf_add_parallel_test inputfile topology)
   string(REGEX REPLACE "/\.tcl" "" testname ${inputfile})
   string(REGEX REPLACE " " "_" postfix ${topology})
@@ -23,10 +26,11 @@ function (pf_add_parallel_test inputfile topology)
   list(APPEND args ${targs})
 
   add_test (NAME ${testname}_${postfix} COMMAND ${CMAKE_COMMAND} "-DPARFLOW_TEST=${args}" -DMPIEXEC=${MPIEXEC} -DMPIEXEC_NUMPROC_FLAG=${MPIEXEC_NUMPROC_FLAG} "-DMPIEXEC_PREFLAGS=${MPIEXEC_PREFLAGS}" "-DMPIEXEC_POSTFLAGS=${MPIEXEC_POSTFLAGS}" -P ${CMAKE_SOURCE_DIR}/cmake/modules/RunParallelTest.cmake WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR})
-  set_tests_properties(${testname}_${postfix} PROPERTIES TIMEOUT 3600)
+  set_tests_properties(${testname}_${postfix} PROPERTIES TIMEOUT 3600 RESOURCE_LOCK ${CMAKE_CURRENT_SOURCE_DIR})
 
   if( ${PARFLOW_HAVE_MEMORYCHECK} )
     add_test (NAME ${testname}_${postfix}_memcheck COMMAND ${CMAKE_COMMAND} -DPARFLOW_HAVE_MEMORYCHECK=${PARFLOW_HAVE_MEMORYCHECK} -DPARFLOW_MEMORYCHECK_COMMAND=${PARFLOW_MEMORYCHECK_COMMAND} -DPARFLOW_MEMORYCHECK_COMMAND_OPTIONS=${PARFLOW_MEMORYCHECK_COMMAND_OPTIONS} "-DPARFLOW_TEST=${args}" -DMPIEXEC=${MPIEXEC} -DMPIEXEC_NUMPROC_FLAG=${MPIEXEC_NUMPROC_FLAG} "-DMPIEXEC_PREFLAGS=${MPIEXEC_PREFLAGS}" "-DMPIEXEC_POSTFLAGS=${MPIEXEC_POSTFLAGS}" -P ${CMAKE_SOURCE_DIR}/cmake/modules/RunParallelTest.cmake WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR})
+    set_tests_properties(${testname}_${postfix}_memcheck PROPERTIES RESOURCE_LOCK ${CMAKE_CURRENT_SOURCE_DIR})
   endif ()
 
 endfunction()
@@ -43,10 +47,11 @@ function (pf_add_sequential_test inputfile)
   list(APPEND args 1 1 1)
 
   add_test (NAME ${testname} COMMAND ${CMAKE_COMMAND} "-DPARFLOW_TEST=${args}" -P ${CMAKE_SOURCE_DIR}/cmake/modules/RunParallelTest.cmake WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR})
-  set_tests_properties(${testname} PROPERTIES TIMEOUT 3600)
+  set_tests_properties(${testname} PROPERTIES TIMEOUT 3600 RESOURCE_LOCK ${CMAKE_CURRENT_SOURCE_DIR})
 
   if( ${PARFLOW_HAVE_MEMORYCHECK} )
     add_test (NAME ${testname}_memcheck COMMAND ${CMAKE_COMMAND} -DPARFLOW_HAVE_MEMORYCHECK=${PARFLOW_HAVE_MEMORYCHECK} -DPARFLOW_MEMORYCHECK_COMMAND=${PARFLOW_MEMORYCHECK_COMMAND} -DPARFLOW_MEMORYCHECK_COMMAND_OPTIONS=${PARFLOW_MEMORYCHECK_COMMAND_OPTIONS} "-DPARFLOW_TEST=${args}" -DMPIEXEC=${MPIEXEC} -DMPIEXEC_NUMPROC_FLAG=${MPIEXEC_NUMPROC_FLAG} "-DMPIEXEC_PREFLAGS=${MPIEXEC_PREFLAGS}" "-DMPIEXEC_POSTFLAGS=${MPIEXEC_POSTFLAGS}" -P ${CMAKE_SOURCE_DIR}/cmake/modules/RunParallelTest.cmake WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR})
+    set_tests_properties(${testname}_memcheck PROPERTIES RESOURCE_LOCK ${CMAKE_CURRENT_SOURCE_DIR})
   endif()
 
 endfunction()
@@ -32,10 +32,10 @@
  *
  * \Ref{amps_Wait} is used to block until the communication initiated by
  * them has completed.  {\bf handle} is the communications handle that
- * was returned by the \Ref{amps_ISend}, \Ref{amps_IRecv}, or
- * \Ref{amps_IExchangePackage} commands.  You must always do an
- * \Ref{amps_Wait} on to finalize an initiated non-blocking
- * communication.
+ * was returned by the \Ref{amps_ISend}, \Ref{amps_IRecv},
+ * \Ref{amps_IExchangePackage}, or \Ref{amps_IAllReduce} commands.  You
+ * must always do an \Ref{amps_Wait} on to finalize an initiated
+ * non-blocking communication.
  *
  * {\large Example:}
  * \begin{verbatim}
@@ -79,6 +79,11 @@ int amps_Wait(amps_Handle handle)
 {
   if (handle)
   {
+#ifdef AMPS_HANDLE_REDUCE
+    if (handle->type == AMPS_HANDLE_REDUCE)
+      _amps_wait_reduce(handle);
+    else
+#endif
     if (handle->type)
       amps_Recv(handle->comm, handle->id, handle->invoice);
     else
@@ -14,6 +14,7 @@ set(AMPS_SRC_FILES
   amps_print.c
   amps_recv.c
   amps_send.c
+  amps_shmem.c
   amps_sizeofinvoice.c
   amps_test.c
   amps_unpack.c
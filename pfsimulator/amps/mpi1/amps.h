@@ -130,20 +130,32 @@
  *
  * {\large Notes:}
  *
- * Currently there is only the global communication context.
+ * Currently there is only the global communication context.  After
+ * \Ref{amps_IOServerSplit} it only includes the compute nodes, or on
+ * an I/O server only the I/O servers.
  *
  * @memo Global communication context
  */
-#define amps_CommWorld MPI_COMM_WORLD
+extern MPI_Comm amps_CommWorld;
 
 extern MPI_Comm amps_CommNode;
 extern MPI_Comm amps_CommWrite;
 
+/*
+ * Communicator with all the nodes, compute and I/O servers, used to
+ * ship output to the I/O servers.  MPI_COMM_NULL unless
+ * amps_IOServerSplit was called with I/O servers.  Ranks in it are the
+ * MPI_COMM_WORLD ranks, compute nodes come first.
+ */
+extern MPI_Comm amps_CommIO;
+
+#define AMPS_IO_SERVERS 1
+
 /* Communicators for I/O */
 extern MPI_Comm nodeComm;
 extern MPI_Comm writeComm;
 
-/* Global ranks and size of MPI_COMM_WORLD*/
+/* Global ranks and size of amps_CommWorld */
 extern int amps_rank;
 extern int amps_size;
 
@@ -323,6 +335,49 @@ typedef struct amps_buffer {
 /*===========================================================================*/
 
 
+/*
+ * Halo exchange engines used by amps_IExchangePackage.  The engine is
+ * selected by setting amps_exchange_method before the first exchange.
+ *
+ * AMPS_EXCHANGE_POINT_TO_POINT  one send and receive per neighbor
+ * AMPS_EXCHANGE_NEIGHBOR        MPI_Neighbor_alltoallw on a distributed
+ *                               graph communicator built from the
+ *                               package's sources and destinations
+ * AMPS_EXCHANGE_PACKED          halo values are copied through flat
+ *                               address lists into contiguous buffers and
+ *                               sent as plain MPI_DOUBLE messages
+ * AMPS_EXCHANGE_SHARED          as PACKED, but values of neighbors on the
+ *                               same node that live in the shared memory
+ *                               arena (amps_SharedMemoryInit) are copied
+ *                               directly, only off node neighbors get
+ *                               messages
+ *
+ * When amps_exchange_timing is set, message counts, bytes and pack, wait
+ * and unpack times are accumulated per neighbor, see
+ * amps_PrintExchangeTiming.
+ */
+#define AMPS_EXCHANGE_POINT_TO_POINT 0
+#define AMPS_EXCHANGE_NEIGHBOR       1
+#define AMPS_EXCHANGE_PACKED         2
+#define AMPS_EXCHANGE_SHARED         3
+
+extern int amps_exchange_method;
+extern int amps_exchange_timing;
+
+/* Node shared memory arena, see amps_shmem.c */
+extern MPI_Win amps_shared_win;
+extern char  **amps_shared_node_base;
+extern int    *amps_shared_node_rank;
+
+/*
+ * Allocate count objects of type, cleared, from the node shared memory
+ * arena.  NULL if there is no arena or it is full; the caller falls back
+ * to its usual allocator.  Only vector data is placed here, and only
+ * from the main thread.  Free with amps_SharedFree.
+ */
+#define amps_SharedCTAlloc(type, count) \
+  ((count) ? (type*)amps_SharedAlloc((size_t)(sizeof(type) * (count))) : NULL)
+
 #ifdef AMPS_MPI_NOT_USE_PERSISTENT
 
 typedef struct {
@@ -337,6 +392,28 @@ typedef struct {
   MPI_Request   *requests;
 
   int recv_remaining;
+
+  /* Neighborhood collective exchange state, receive entries first */
+  int neighbor_commited;
+  MPI_Comm neighbor_comm;
+  MPI_Datatype  *neighbor_types;
+  int           *neighbor_counts;
+  MPI_Aint      *neighbor_displs;
+  MPI_Request neighbor_request;
+
+  /* Explicit buffer exchange state, receive entries first; -1 in
+   * packed_commited marks packages that are not all doubles */
+  int packed_commited;
+  double       **packed_index;
+  int           *packed_offsets;
+  double        *packed_buffer;
+  MPI_Request   *packed_requests;
+
+  /* Entries copied through the node shared memory arena, their zero
+   * length requests only signal that the data is ready */
+  int           *packed_shared;
+  double       **packed_shared_index;
+  MPI_Request   *packed_done_requests;
 } amps_PackageStruct;
 
 typedef amps_PackageStruct *amps_Package;
@@ -357,6 +434,28 @@ typedef struct {
   MPI_Status    *status;
 
   int commited;
+
+  /* Neighborhood collective exchange state, receive entries first */
+  int neighbor_commited;
+  MPI_Comm neighbor_comm;
+  MPI_Datatype  *neighbor_types;
+  int           *neighbor_counts;
+  MPI_Aint      *neighbor_displs;
+  MPI_Request neighbor_request;
+
+  /* Explicit buffer exchange state, receive entries first; -1 in
+   * packed_commited marks packages that are not all doubles */
+  int packed_commited;
+  double       **packed_index;
+  int           *packed_offsets;
+  double        *packed_buffer;
+  MPI_Request   *packed_requests;
+
+  /* Entries copied through the node shared memory arena, their zero
+   * length requests only signal that the data is ready */
+  int           *packed_shared;
+  double       **packed_shared_index;
+  MPI_Request   *packed_done_requests;
 } amps_PackageStruct;
 
 typedef amps_PackageStruct *amps_Package;
@@ -364,12 +463,18 @@ typedef amps_PackageStruct *amps_Package;
 #endif
 
 
+/* Handle type of amps_IAllReduce, id is the number of requests */
+#define AMPS_HANDLE_REDUCE 2
+
 typedef struct _amps_HandleObject {
   int type;
   amps_Comm comm;
   int id;
   amps_Invoice invoice;
   amps_Package package;
+
+  char        *buffer;        /* amps_IAllReduce values */
+  MPI_Request *requests;
 } amps_HandleObject;
 
 typedef amps_HandleObject *amps_Handle;
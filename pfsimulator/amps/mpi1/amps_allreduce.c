@@ -30,6 +30,107 @@
 
 #include <strings.h>
 
+/* Data, length, stride and MPI type of an invoice entry */
+static void _amps_reduce_entry(amps_InvoiceEntry *ptr, char **data, int *len,
+                               int *stride, MPI_Datatype *mpi_type,
+                               int *element_size)
+{
+  if (ptr->len_type == AMPS_INVOICE_POINTER)
+    *len = *(ptr->ptr_len);
+  else
+    *len = ptr->len;
+
+  if (ptr->stride_type == AMPS_INVOICE_POINTER)
+    *stride = *(ptr->ptr_stride);
+  else
+    *stride = ptr->stride;
+
+  if (ptr->data_type == AMPS_INVOICE_POINTER)
+    *data = *((char**)(ptr->data));
+  else
+    *data = (char*)ptr->data;
+
+  *mpi_type = MPI_CHAR;
+  *element_size = 0;
+
+  switch (ptr->type)
+  {
+    case AMPS_INVOICE_BYTE_CTYPE:
+      *mpi_type = MPI_BYTE;
+      *element_size = sizeof(char);
+      break;
+
+    case AMPS_INVOICE_CHAR_CTYPE:
+      *mpi_type = MPI_CHAR;
+      *element_size = sizeof(char);
+      break;
+
+    case AMPS_INVOICE_SHORT_CTYPE:
+      *mpi_type = MPI_SHORT;
+      *element_size = sizeof(short);
+      break;
+
+    case AMPS_INVOICE_INT_CTYPE:
+      *mpi_type = MPI_INT;
+      *element_size = sizeof(int);
+      break;
+
+    case AMPS_INVOICE_LONG_CTYPE:
+      *mpi_type = MPI_LONG;
+      *element_size = sizeof(long);
+      break;
+
+    case AMPS_INVOICE_FLOAT_CTYPE:
+      *mpi_type = MPI_FLOAT;
+      *element_size = sizeof(float);
+      break;
+
+    case AMPS_INVOICE_DOUBLE_CTYPE:
+      *mpi_type = MPI_DOUBLE;
+      *element_size = sizeof(double);
+      break;
+
+    default:
+      printf("AMPS Operation not supported\n");
+  }
+}
+
+/* Copy an entry into a contigous buffer */
+static void _amps_reduce_copy_in(char *data, int len, int stride,
+                                 int element_size, char *buffer)
+{
+  char *ptr_src;
+  char *ptr_dest;
+
+  if (stride == 1)
+    bcopy(data, buffer, (size_t)(len * element_size));
+  else
+    for (ptr_src = data, ptr_dest = buffer;
+         ptr_src < data + len * stride * element_size;
+         ptr_src += stride * element_size, ptr_dest += element_size)
+      bcopy(ptr_src, ptr_dest, (size_t)(element_size));
+}
+
+/* Copy a contigous buffer back into the user variables of an entry */
+static void _amps_reduce_copy_out(char *buffer, int len, int stride,
+                                  int element_size, char *data)
+{
+  char *ptr_src;
+  char *ptr_dest;
+
+  if (stride == 1)
+    bcopy(buffer, data, (size_t)(len * element_size));
+  else
+    for (ptr_src = buffer, ptr_dest = data;
+         ptr_src < buffer + len * element_size;
+         ptr_src += element_size, ptr_dest += stride * element_size)
+      bcopy(ptr_src, ptr_dest, (size_t)(element_size));
+}
+
+/* Each entry starts on a double boundary of the amps_IAllReduce buffer */
+#define AMPS_REDUCE_ALIGN(size) \
+  ((((size) + sizeof(double) - 1) / sizeof(double)) * sizeof(double))
+
 /*===========================================================================*/
 /**
  * The collective operation \Ref{amps_AllReduce} is used to take information
@@ -73,95 +174,23 @@ int amps_AllReduce(amps_Comm comm, amps_Invoice invoice, MPI_Op operation)
   char *in_buffer;
   char *out_buffer;
 
-  char *ptr_src;
-  char *ptr_dest;
-
-  MPI_Datatype mpi_type = MPI_CHAR;
-  int element_size = 0;
+  MPI_Datatype mpi_type;
+  int element_size;
 
   ptr = invoice->list;
 
   while (ptr != NULL)
   {
-    if (ptr->len_type == AMPS_INVOICE_POINTER)
-      len = *(ptr->ptr_len);
-    else
-      len = ptr->len;
-
-    if (ptr->stride_type == AMPS_INVOICE_POINTER)
-      stride = *(ptr->ptr_stride);
-    else
-      stride = ptr->stride;
-
-    if (ptr->data_type == AMPS_INVOICE_POINTER)
-      data = *((char**)(ptr->data));
-    else
-      data = (char*)ptr->data;
-
-
-    switch (ptr->type)
-    {
-      case AMPS_INVOICE_BYTE_CTYPE:
-	mpi_type = MPI_BYTE;
-        element_size = sizeof(char);
-        break;
-
-      case AMPS_INVOICE_CHAR_CTYPE:
-        mpi_type = MPI_CHAR;
-        element_size = sizeof(char);
-        break;
-
-      case AMPS_INVOICE_SHORT_CTYPE:
-        mpi_type = MPI_SHORT;
-        element_size = sizeof(short);
-        break;
-
-      case AMPS_INVOICE_INT_CTYPE:
-        mpi_type = MPI_INT;
-        element_size = sizeof(int);
-        break;
-
-      case AMPS_INVOICE_LONG_CTYPE:
-        mpi_type = MPI_LONG;
-        element_size = sizeof(long);
-        break;
-
-      case AMPS_INVOICE_FLOAT_CTYPE:
-        mpi_type = MPI_FLOAT;
-        element_size = sizeof(float);
-        break;
-
-      case AMPS_INVOICE_DOUBLE_CTYPE:
-        mpi_type = MPI_DOUBLE;
-        element_size = sizeof(double);
-        break;
-
-      default:
-        printf("AMPS Operation not supported\n");
-    }
+    _amps_reduce_entry(ptr, &data, &len, &stride, &mpi_type, &element_size);
 
     in_buffer = (char*)malloc((size_t)(element_size * len));
     out_buffer = (char*)malloc((size_t)(element_size * len));
 
-    /* Copy into a contigous buffer */
-    if (stride == 1)
-      bcopy(data, in_buffer, (size_t)(len * element_size));
-    else
-      for (ptr_src = data, ptr_dest = in_buffer;
-           ptr_src < data + len * stride * element_size;
-           ptr_src += stride * element_size, ptr_dest += element_size)
-        bcopy(ptr_src, ptr_dest, (size_t)(element_size));
+    _amps_reduce_copy_in(data, len, stride, element_size, in_buffer);
 
     MPI_Allreduce(in_buffer, out_buffer, len, mpi_type, operation, comm);
 
-    /* Copy back into user variables */
-    if (stride == 1)
-      bcopy(out_buffer, data, (size_t)(len * element_size));
-    else
-      for (ptr_src = out_buffer, ptr_dest = data;
-           ptr_src < out_buffer + len * element_size;
-           ptr_src += element_size, ptr_dest += stride * element_size)
-        bcopy(ptr_src, ptr_dest, (size_t)(element_size));
+    _amps_reduce_copy_out(out_buffer, len, stride, element_size, data);
 
     free(in_buffer);
     free(out_buffer);
@@ -172,3 +201,117 @@ int amps_AllReduce(amps_Comm comm, amps_Invoice invoice, MPI_Op operation)
   return 0;
 }
 
+/*===========================================================================*/
+/**
+ *
+ * \Ref{amps_IAllReduce} starts the same reduction as \Ref{amps_AllReduce}
+ * without waiting for it.  The values in {\bf invoice} are copied when the
+ * reduction starts and the combined result is copied back into them by the
+ * \Ref{amps_Wait} on the returned handle, so work that does not touch
+ * them can be done while the reduction is in progress.
+ *
+ * {\large Example:}
+ * \begin{verbatim}
+ * amps_Invoice invoice;
+ * amps_Handle  handle;
+ * double       d;
+ *
+ * invoice = amps_NewInvoice("%d", &d);
+ *
+ * handle = amps_IAllReduce(amps_CommWorld, invoice, amps_Add);
+ *
+ * // do some work
+ *
+ * amps_Wait(handle);
+ *
+ * amps_FreeInvoice(invoice);
+ *
+ * \end{verbatim}
+ *
+ * @memo Non-blocking reduction operation
+ * @param comm communication context for the reduction [IN]
+ * @param invoice invoice to reduce [IN/OUT]
+ * @param operation reduction operation to perform [IN]
+ * @return Handle for the reduction
+ */
+amps_Handle amps_IAllReduce(amps_Comm comm, amps_Invoice invoice,
+                            MPI_Op operation)
+{
+  amps_InvoiceEntry *ptr;
+  amps_Handle handle;
+
+  int len;
+  int stride;
+  int num;
+  size_t size;
+
+  char *data;
+
+  MPI_Datatype mpi_type;
+  int element_size;
+
+  num = 0;
+  size = 0;
+  for (ptr = invoice->list; ptr != NULL; ptr = ptr->next)
+  {
+    _amps_reduce_entry(ptr, &data, &len, &stride, &mpi_type, &element_size);
+    size += AMPS_REDUCE_ALIGN((size_t)(len * element_size));
+    num++;
+  }
+
+  handle = amps_NewHandle(comm, 0, invoice, NULL);
+  handle->type = AMPS_HANDLE_REDUCE;
+  handle->buffer = (char*)malloc(size + 1);
+  handle->requests = (MPI_Request*)malloc(sizeof(MPI_Request)
+                                          * (size_t)(num + 1));
+
+  num = 0;
+  size = 0;
+  for (ptr = invoice->list; ptr != NULL; ptr = ptr->next)
+  {
+    _amps_reduce_entry(ptr, &data, &len, &stride, &mpi_type, &element_size);
+
+    _amps_reduce_copy_in(data, len, stride, element_size,
+                         handle->buffer + size);
+
+    MPI_Iallreduce(MPI_IN_PLACE, handle->buffer + size, len, mpi_type,
+                   operation, comm, &(handle->requests[num]));
+
+    size += AMPS_REDUCE_ALIGN((size_t)(len * element_size));
+    num++;
+  }
+
+  handle->id = num;
+
+  return handle;
+}
+
+void _amps_wait_reduce(amps_Handle handle)
+{
+  amps_InvoiceEntry *ptr;
+
+  int len;
+  int stride;
+  size_t size;
+
+  char *data;
+
+  MPI_Datatype mpi_type;
+  int element_size;
+
+  MPI_Waitall(handle->id, handle->requests, MPI_STATUSES_IGNORE);
+
+  size = 0;
+  for (ptr = handle->invoice->list; ptr != NULL; ptr = ptr->next)
+  {
+    _amps_reduce_entry(ptr, &data, &len, &stride, &mpi_type, &element_size);
+
+    _amps_reduce_copy_out(handle->buffer + size, len, stride, element_size,
+                          data);
+
+    size += AMPS_REDUCE_ALIGN((size_t)(len * element_size));
+  }
+
+  free(handle->buffer);
+  free(handle->requests);
+}
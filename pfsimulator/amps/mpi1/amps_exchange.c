@@ -28,6 +28,857 @@
 
 #include "amps.h"
 
+int amps_exchange_method = AMPS_EXCHANGE_POINT_TO_POINT;
+int amps_exchange_timing = FALSE;
+
+/*---------------------------------------------------------------------------
+ * Exchange timing
+ *
+ * Counters are kept per neighbor rank for the lifetime of the run.  Wait
+ * time is the time spent blocked in the wait, charged to the neighbor
+ * whose receive ended the block; the neighborhood collective completes as
+ * a whole so its wait time is only reported in the total.
+ *---------------------------------------------------------------------------*/
+
+typedef struct {
+  long send_messages;
+  long send_bytes;
+  long recv_messages;
+  long recv_bytes;
+  double pack_time;
+  double wait_time;
+  double unpack_time;
+} amps_ExchangeTimingStruct;
+
+static amps_ExchangeTimingStruct *amps_exchange_timing_data = NULL;
+static amps_ExchangeTimingStruct amps_exchange_timing_total;
+
+static amps_ExchangeTimingStruct *_amps_exchange_timing(int rank)
+{
+  if (!amps_exchange_timing_data)
+  {
+    amps_exchange_timing_data = (amps_ExchangeTimingStruct*)
+                                calloc((size_t)amps_size,
+                                       sizeof(amps_ExchangeTimingStruct));
+  }
+
+  return amps_exchange_timing_data + rank;
+}
+
+/* Count the messages of one exchange, after the package is committed */
+static void _amps_time_messages(amps_Package package)
+{
+  amps_ExchangeTimingStruct *data;
+  int num_recv = package->num_recv;
+  int size;
+  int i;
+
+  for (i = 0; i < num_recv; i++)
+  {
+    if (package->packed_commited > 0)
+    {
+      size = (package->packed_offsets[i + 1] - package->packed_offsets[i])
+             * (int)sizeof(double);
+    }
+    else
+    {
+      MPI_Type_size(package->recv_invoices[i]->mpi_type, &size);
+    }
+
+    data = _amps_exchange_timing(package->src[i]);
+    data->recv_messages++;
+    data->recv_bytes += size;
+  }
+
+  for (i = 0; i < package->num_send; i++)
+  {
+    if (package->packed_commited > 0)
+    {
+      size = (package->packed_offsets[num_recv + i + 1]
+              - package->packed_offsets[num_recv + i])
+             * (int)sizeof(double);
+    }
+    else
+    {
+      MPI_Type_size(package->send_invoices[i]->mpi_type, &size);
+    }
+
+    data = _amps_exchange_timing(package->dest[i]);
+    data->send_messages++;
+    data->send_bytes += size;
+  }
+}
+
+/* Wait for the receives one at a time so blocked time can be charged to
+ * a neighbor, then for the sends; recv_done is called on each receive */
+static void _amps_timed_waitall(amps_Package package, MPI_Request *requests,
+                                void (*recv_done)(amps_Package, int))
+{
+  double start;
+  double time;
+  int n;
+  int index;
+
+  for (n = 0; n < package->num_recv; n++)
+  {
+    start = MPI_Wtime();
+    MPI_Waitany(package->num_recv, requests, &index, MPI_STATUS_IGNORE);
+    time = MPI_Wtime() - start;
+
+    _amps_exchange_timing(package->src[index])->wait_time += time;
+    amps_exchange_timing_total.wait_time += time;
+
+    if (recv_done)
+    {
+      (*recv_done)(package, index);
+    }
+  }
+
+  start = MPI_Wtime();
+  MPI_Waitall(package->num_send, requests + package->num_recv,
+              MPI_STATUSES_IGNORE);
+  amps_exchange_timing_total.wait_time += MPI_Wtime() - start;
+}
+
+/*===========================================================================*/
+/**
+ *
+ * Write the halo exchange counters of this rank to {\bf file} as CSV, one
+ * row per neighbor followed by a row with the totals.  Counters are only
+ * collected when {\bf amps_exchange_timing} is set.
+ *
+ * @memo Print halo exchange timing
+ * @param file open file to write to
+ */
+void amps_PrintExchangeTiming(FILE *file)
+{
+  static const char *engines[] = { "PointToPoint", "Neighbor", "Packed", "Shared" };
+  amps_ExchangeTimingStruct *data;
+  amps_ExchangeTimingStruct total = amps_exchange_timing_total;
+  int rank;
+
+  fprintf(file, "Engine,Rank,Neighbor,Sends,Send Bytes,Receives,Receive Bytes,"
+          "Pack (s),Wait (s),Unpack (s)\n");
+
+  for (rank = 0; rank < amps_size && amps_exchange_timing_data; rank++)
+  {
+    data = amps_exchange_timing_data + rank;
+    if (data->send_messages + data->recv_messages)
+    {
+      fprintf(file, "%s,%d,%d,%ld,%ld,%ld,%ld,%f,%f,%f\n",
+              engines[amps_exchange_method], amps_rank, rank,
+              data->send_messages, data->send_bytes,
+              data->recv_messages, data->recv_bytes,
+              data->pack_time, data->wait_time, data->unpack_time);
+
+      total.send_messages += data->send_messages;
+      total.send_bytes += data->send_bytes;
+      total.recv_messages += data->recv_messages;
+      total.recv_bytes += data->recv_bytes;
+    }
+  }
+
+  fprintf(file, "%s,%d,all,%ld,%ld,%ld,%ld,%f,%f,%f\n",
+          engines[amps_exchange_method], amps_rank,
+          total.send_messages, total.send_bytes,
+          total.recv_messages, total.recv_bytes,
+          total.pack_time, total.wait_time, total.unpack_time);
+}
+
+void amps_FreeExchangeTiming()
+{
+  free(amps_exchange_timing_data);
+  amps_exchange_timing_data = NULL;
+}
+
+/*---------------------------------------------------------------------------
+ * Neighborhood collective exchange
+ *
+ * The first exchange of a package builds a distributed graph communicator
+ * whose in and out neighbors are the package's sources and destinations,
+ * and one datatype per neighbor (the same absolute address types used by
+ * the point to point exchange).  Each exchange is then a single
+ * MPI_Neighbor_alltoallw, persistent when MPI-4 is available.  This is a
+ * collective over amps_CommWorld, so every rank must exchange every
+ * package, including ranks with no neighbors.
+ *---------------------------------------------------------------------------*/
+
+static void _amps_commit_neighbor_exchange(amps_Package package)
+{
+  int num_recv = package->num_recv;
+  int num = package->num_recv + package->num_send;
+  int i;
+
+  /* Keep the arrays non-NULL for ranks without neighbors */
+  package->neighbor_types = (MPI_Datatype*)calloc((size_t)(num + 1),
+                                                  sizeof(MPI_Datatype));
+  package->neighbor_counts = (int*)calloc((size_t)(num + 1), sizeof(int));
+  package->neighbor_displs = (MPI_Aint*)calloc((size_t)(num + 1),
+                                               sizeof(MPI_Aint));
+
+  for (i = 0; i < package->num_recv; i++)
+  {
+    amps_create_mpi_type(amps_CommWorld, package->recv_invoices[i]);
+    MPI_Type_commit(&(package->recv_invoices[i]->mpi_type));
+
+    package->neighbor_types[i] = package->recv_invoices[i]->mpi_type;
+    package->neighbor_counts[i] = 1;
+  }
+
+  for (i = 0; i < package->num_send; i++)
+  {
+    amps_create_mpi_type(amps_CommWorld, package->send_invoices[i]);
+    MPI_Type_commit(&(package->send_invoices[i]->mpi_type));
+
+    package->neighbor_types[num_recv + i] = package->send_invoices[i]->mpi_type;
+    package->neighbor_counts[num_recv + i] = 1;
+  }
+
+  /* Unit weights (the counts) rather than MPI_UNWEIGHTED, all edges are
+   * treated alike either way */
+  MPI_Dist_graph_create_adjacent(amps_CommWorld,
+                                 package->num_recv, package->src,
+                                 package->neighbor_counts,
+                                 package->num_send, package->dest,
+                                 package->neighbor_counts + num_recv,
+                                 MPI_INFO_NULL, 0, &(package->neighbor_comm));
+
+#if MPI_VERSION >= 4
+  MPI_Neighbor_alltoallw_init(MPI_BOTTOM,
+                              package->neighbor_counts + num_recv,
+                              package->neighbor_displs + num_recv,
+                              package->neighbor_types + num_recv,
+                              MPI_BOTTOM,
+                              package->neighbor_counts,
+                              package->neighbor_displs,
+                              package->neighbor_types,
+                              package->neighbor_comm, MPI_INFO_NULL,
+                              &(package->neighbor_request));
+#endif
+
+  package->neighbor_commited = TRUE;
+}
+
+amps_Handle _amps_neighbor_exchange(amps_Package package)
+{
+  int num_recv = package->num_recv;
+
+  if (!package->neighbor_commited)
+  {
+    _amps_commit_neighbor_exchange(package);
+  }
+
+  if (amps_exchange_timing)
+  {
+    _amps_time_messages(package);
+  }
+
+#if MPI_VERSION >= 4
+  MPI_Start(&(package->neighbor_request));
+#else
+  MPI_Ineighbor_alltoallw(MPI_BOTTOM,
+                          package->neighbor_counts + num_recv,
+                          package->neighbor_displs + num_recv,
+                          package->neighbor_types + num_recv,
+                          MPI_BOTTOM,
+                          package->neighbor_counts,
+                          package->neighbor_displs,
+                          package->neighbor_types,
+                          package->neighbor_comm,
+                          &(package->neighbor_request));
+#endif
+
+  return(amps_NewHandle(amps_CommWorld, 0, NULL, package));
+}
+
+void _amps_wait_neighbor_exchange(amps_Handle handle)
+{
+  int i;
+
+  for (i = 0; i < handle->package->num_recv; i++)
+  {
+    AMPS_CLEAR_INVOICE(handle->package->recv_invoices[i]);
+  }
+
+  if (amps_exchange_timing)
+  {
+    double start = MPI_Wtime();
+    MPI_Wait(&(handle->package->neighbor_request), MPI_STATUS_IGNORE);
+    amps_exchange_timing_total.wait_time += MPI_Wtime() - start;
+  }
+  else
+  {
+    MPI_Wait(&(handle->package->neighbor_request), MPI_STATUS_IGNORE);
+  }
+}
+
+void _amps_free_neighbor_exchange(amps_Package package)
+{
+  int i;
+
+  if (!package->neighbor_commited)
+  {
+    return;
+  }
+
+  for (i = 0; i < package->num_recv; i++)
+  {
+    if (package->recv_invoices[i]->mpi_type != MPI_DATATYPE_NULL)
+    {
+      MPI_Type_free(&(package->recv_invoices[i]->mpi_type));
+    }
+  }
+
+  for (i = 0; i < package->num_send; i++)
+  {
+    if (package->send_invoices[i]->mpi_type != MPI_DATATYPE_NULL)
+    {
+      MPI_Type_free(&(package->send_invoices[i]->mpi_type));
+    }
+  }
+
+#if MPI_VERSION >= 4
+  MPI_Request_free(&(package->neighbor_request));
+#endif
+  MPI_Comm_free(&(package->neighbor_comm));
+
+  free(package->neighbor_types);
+  free(package->neighbor_counts);
+  free(package->neighbor_displs);
+
+  package->neighbor_commited = FALSE;
+}
+
+/*---------------------------------------------------------------------------
+ * Explicit buffer exchange
+ *
+ * The first exchange of a package flattens every invoice into a list of
+ * the addresses of the values it describes, receive invoices first.  The
+ * lists are stored back to back so packed_offsets[i] is both the start of
+ * invoice i in packed_index and in packed_buffer, which is allocated with
+ * MPI_Alloc_mem so the MPI library can register it once.  Each exchange
+ * gathers the send values into the buffer, starts persistent contiguous
+ * MPI_DOUBLE requests and scatters each receive as it completes; the
+ * copies are OpenMP parallel when ParFlow is built with OpenMP.  Only
+ * invoices of doubles are flattened, packages with other entries are
+ * marked with -1 and use the datatype exchange.
+ *---------------------------------------------------------------------------*/
+
+static void _amps_packed_flatten_vector(double **data, int dim, int *len,
+                                        int *stride, double **index,
+                                        int *count)
+{
+  int i;
+
+  /* Same walk as amps_vector_in, data is left on the last element */
+  if (dim == 0)
+  {
+    for (i = 0; i < len[0]; i++)
+    {
+      if (index)
+      {
+        index[*count] = *data + i * stride[0];
+      }
+      (*count)++;
+    }
+    *data += (len[0] - 1) * stride[0];
+  }
+  else
+  {
+    for (i = 0; i < len[dim]; i++)
+    {
+      _amps_packed_flatten_vector(data, dim - 1, len, stride, index, count);
+
+      if (i < len[dim] - 1)
+      {
+        *data += stride[dim];
+      }
+    }
+  }
+}
+
+/* Returns the number of values in the invoice, or -1 if it can not be
+ * flattened; the addresses are stored in index when it is not NULL */
+static int _amps_packed_flatten(amps_Invoice inv, double **index)
+{
+  amps_InvoiceEntry *ptr;
+  double *data;
+  int count = 0;
+  int len;
+  int stride;
+  int dim;
+  int i;
+
+  for (ptr = inv->list; ptr != NULL; ptr = ptr->next)
+  {
+    if (ptr->ignore)
+    {
+      return -1;
+    }
+
+    if (ptr->data_type == AMPS_INVOICE_POINTER)
+      data = *((double**)(ptr->data));
+    else
+      data = (double*)ptr->data;
+
+    if (ptr->type == AMPS_INVOICE_DOUBLE_CTYPE)
+    {
+      len = (ptr->len_type == AMPS_INVOICE_POINTER) ?
+            *(ptr->ptr_len) : ptr->len;
+      stride = (ptr->stride_type == AMPS_INVOICE_POINTER) ?
+               *(ptr->ptr_stride) : ptr->stride;
+
+      for (i = 0; i < len; i++)
+      {
+        if (index)
+        {
+          index[count] = data + i * stride;
+        }
+        count++;
+      }
+    }
+    else if (ptr->type - AMPS_INVOICE_LAST_CTYPE == AMPS_INVOICE_DOUBLE_CTYPE)
+    {
+      dim = (ptr->dim_type == AMPS_INVOICE_POINTER) ?
+            *(ptr->ptr_dim) : ptr->dim;
+
+      _amps_packed_flatten_vector(&data, dim - 1, ptr->ptr_len,
+                                  ptr->ptr_stride, index, &count);
+    }
+    else
+    {
+      return -1;
+    }
+  }
+
+  return count;
+}
+
+/*---------------------------------------------------------------------------
+ * Shared memory entries
+ *
+ * With AMPS_EXCHANGE_SHARED each sender tells every receiver on its node,
+ * once, the offsets of its send values in its segment of the shared
+ * memory arena, or that some of them are not in the arena.  Entries whose
+ * values are all in the arena are then read directly by the receiver:
+ * the sender issues MPI_Win_sync and a zero length ready message when the
+ * exchange starts, the receiver syncs, copies and answers with a zero
+ * length done message, which the sender waits for before its values may
+ * change again.
+ *---------------------------------------------------------------------------*/
+
+#define AMPS_PACKED_TAG 0
+#define AMPS_SHARED_SETUP_TAG 1
+#define AMPS_SHARED_DONE_TAG 2
+
+static void _amps_commit_shared_exchange(amps_Package package)
+{
+  int num_recv = package->num_recv;
+  int num = package->num_recv + package->num_send;
+  int *offsets = package->packed_offsets;
+  MPI_Request *requests;
+  long **setup;
+  char *base;
+  int count;
+  int rank;
+  int i;
+  int j;
+
+  package->packed_shared = (int*)calloc((size_t)(num + 1), sizeof(int));
+  package->packed_shared_index = (double**)calloc((size_t)(offsets[num_recv] + 1),
+                                                  sizeof(double*));
+  package->packed_done_requests = (MPI_Request*)malloc(sizeof(MPI_Request)
+                                                       * (size_t)(num + 1));
+
+  requests = (MPI_Request*)malloc(sizeof(MPI_Request) * (size_t)(num + 1));
+  setup = (long**)calloc((size_t)(num + 1), sizeof(long*));
+
+  for (i = 0; i < num; i++)
+  {
+    rank = (i < num_recv) ? package->src[i] : package->dest[i - num_recv];
+    count = offsets[i + 1] - offsets[i];
+
+    requests[i] = MPI_REQUEST_NULL;
+    package->packed_done_requests[i] = MPI_REQUEST_NULL;
+
+    if (amps_shared_node_rank[rank] == MPI_UNDEFINED)
+    {
+      continue;
+    }
+
+    setup[i] = (long*)malloc(sizeof(long) * (size_t)(count + 1));
+
+    if (i < num_recv)
+    {
+      MPI_Irecv(setup[i], count + 1, MPI_LONG, rank, AMPS_SHARED_SETUP_TAG,
+                amps_CommWorld, &(requests[i]));
+    }
+    else
+    {
+      setup[i][0] = TRUE;
+      for (j = 0; j < count; j++)
+      {
+        setup[i][j + 1] =
+          amps_SharedMemoryOffset(package->packed_index[offsets[i] + j]);
+        if (setup[i][j + 1] < 0)
+        {
+          setup[i][0] = FALSE;
+          break;
+        }
+      }
+
+      package->packed_shared[i] = (int)setup[i][0];
+
+      MPI_Isend(setup[i], setup[i][0] ? count + 1 : 1, MPI_LONG, rank,
+                AMPS_SHARED_SETUP_TAG, amps_CommWorld, &(requests[i]));
+    }
+  }
+
+  MPI_Waitall(num, requests, MPI_STATUSES_IGNORE);
+
+  for (i = 0; i < num_recv; i++)
+  {
+    if (setup[i] && setup[i][0])
+    {
+      base = amps_shared_node_base[amps_shared_node_rank[package->src[i]]];
+      for (j = 0; j < offsets[i + 1] - offsets[i]; j++)
+      {
+        package->packed_shared_index[offsets[i] + j] =
+          (double*)(base + setup[i][j + 1]);
+      }
+
+      package->packed_shared[i] = TRUE;
+    }
+  }
+
+  for (i = 0; i < num; i++)
+  {
+    if (package->packed_shared[i])
+    {
+      if (i < num_recv)
+      {
+        MPI_Send_init(NULL, 0, MPI_DOUBLE, package->src[i],
+                      AMPS_SHARED_DONE_TAG, amps_CommWorld,
+                      &(package->packed_done_requests[i]));
+      }
+      else
+      {
+        MPI_Recv_init(NULL, 0, MPI_DOUBLE, package->dest[i - num_recv],
+                      AMPS_SHARED_DONE_TAG, amps_CommWorld,
+                      &(package->packed_done_requests[i]));
+      }
+    }
+
+    free(setup[i]);
+  }
+
+  free(setup);
+  free(requests);
+}
+
+static void _amps_commit_packed_exchange(amps_Package package)
+{
+  amps_Invoice invoice;
+  int num_recv = package->num_recv;
+  int num = package->num_recv + package->num_send;
+  int count;
+  int i;
+
+  package->packed_offsets = (int*)calloc((size_t)(num + 1), sizeof(int));
+
+  for (i = 0; i < num; i++)
+  {
+    invoice = (i < num_recv) ? package->recv_invoices[i] :
+              package->send_invoices[i - num_recv];
+
+    count = _amps_packed_flatten(invoice, NULL);
+    if (count < 0)
+    {
+      free(package->packed_offsets);
+      package->packed_offsets = NULL;
+      package->packed_commited = -1;
+      return;
+    }
+
+    package->packed_offsets[i + 1] = package->packed_offsets[i] + count;
+  }
+
+  count = package->packed_offsets[num];
+
+  package->packed_index = (double**)calloc((size_t)(count + 1),
+                                           sizeof(double*));
+  package->packed_requests = (MPI_Request*)calloc((size_t)(num + 1),
+                                                  sizeof(MPI_Request));
+  MPI_Alloc_mem((MPI_Aint)((count + 1) * sizeof(double)), MPI_INFO_NULL,
+                &(package->packed_buffer));
+
+  for (i = 0; i < num; i++)
+  {
+    invoice = (i < num_recv) ? package->recv_invoices[i] :
+              package->send_invoices[i - num_recv];
+
+    _amps_packed_flatten(invoice,
+                         package->packed_index + package->packed_offsets[i]);
+  }
+
+  if (amps_exchange_method == AMPS_EXCHANGE_SHARED &&
+      amps_shared_win != MPI_WIN_NULL)
+  {
+    _amps_commit_shared_exchange(package);
+  }
+
+  /* Shared entries keep their request as a zero length ready message */
+  for (i = 0; i < num; i++)
+  {
+    count = package->packed_offsets[i + 1] - package->packed_offsets[i];
+    if (package->packed_shared && package->packed_shared[i])
+    {
+      count = 0;
+    }
+
+    if (i < num_recv)
+    {
+      MPI_Recv_init(package->packed_buffer + package->packed_offsets[i],
+                    count, MPI_DOUBLE, package->src[i], AMPS_PACKED_TAG,
+                    amps_CommWorld, &(package->packed_requests[i]));
+    }
+    else
+    {
+      MPI_Send_init(package->packed_buffer + package->packed_offsets[i],
+                    count, MPI_DOUBLE, package->dest[i - num_recv],
+                    AMPS_PACKED_TAG, amps_CommWorld,
+                    &(package->packed_requests[i]));
+    }
+  }
+
+  package->packed_commited = TRUE;
+}
+
+/* Copy invoices first to last - 1 into the buffer */
+static void _amps_packed_gather(amps_Package package, int first, int last)
+{
+  double **index = package->packed_index;
+  double *buffer = package->packed_buffer;
+  int begin = package->packed_offsets[first];
+  int end = package->packed_offsets[last];
+  int j;
+
+#ifdef PARFLOW_HAVE_OMP
+#pragma omp parallel for
+#endif
+  for (j = begin; j < end; j++)
+  {
+    buffer[j] = *index[j];
+  }
+}
+
+/* Copy invoices first to last - 1 out of the buffer */
+static void _amps_packed_scatter(amps_Package package, int first, int last)
+{
+  double **index = package->packed_index;
+  double *buffer = package->packed_buffer;
+  int begin = package->packed_offsets[first];
+  int end = package->packed_offsets[last];
+  int j;
+
+#ifdef PARFLOW_HAVE_OMP
+#pragma omp parallel for
+#endif
+  for (j = begin; j < end; j++)
+  {
+    *index[j] = buffer[j];
+  }
+}
+
+/* Finish receive i once its message arrived, reading shared entries
+ * directly from the sender */
+static void _amps_packed_unpack(amps_Package package, int i)
+{
+  double **index = package->packed_index;
+  double **shared_index = package->packed_shared_index;
+  int begin = package->packed_offsets[i];
+  int end = package->packed_offsets[i + 1];
+  int j;
+
+  if (package->packed_shared && package->packed_shared[i])
+  {
+    MPI_Win_sync(amps_shared_win);
+
+#ifdef PARFLOW_HAVE_OMP
+#pragma omp parallel for
+#endif
+    for (j = begin; j < end; j++)
+    {
+      *index[j] = *shared_index[j];
+    }
+
+    MPI_Start(&(package->packed_done_requests[i]));
+  }
+  else
+  {
+    _amps_packed_scatter(package, i, i + 1);
+  }
+}
+
+static void _amps_packed_timed_unpack(amps_Package package, int i)
+{
+  double start = MPI_Wtime();
+  double time;
+
+  _amps_packed_unpack(package, i);
+
+  time = MPI_Wtime() - start;
+  _amps_exchange_timing(package->src[i])->unpack_time += time;
+  amps_exchange_timing_total.unpack_time += time;
+}
+
+amps_Handle _amps_packed_exchange(amps_Package package)
+{
+  int num_recv = package->num_recv;
+  int num = package->num_recv + package->num_send;
+  double start;
+  double time;
+  int i;
+
+  if (!package->packed_commited)
+  {
+    _amps_commit_packed_exchange(package);
+  }
+
+  if (package->packed_commited < 0)
+  {
+    return NULL;
+  }
+
+  if (amps_exchange_timing)
+  {
+    _amps_time_messages(package);
+  }
+
+  if (amps_exchange_timing || package->packed_shared)
+  {
+    for (i = num_recv; i < num; i++)
+    {
+      if (package->packed_shared && package->packed_shared[i])
+      {
+        continue;
+      }
+
+      start = MPI_Wtime();
+      _amps_packed_gather(package, i, i + 1);
+      time = MPI_Wtime() - start;
+
+      if (amps_exchange_timing)
+      {
+        _amps_exchange_timing(package->dest[i - num_recv])->pack_time += time;
+        amps_exchange_timing_total.pack_time += time;
+      }
+    }
+  }
+  else
+  {
+    _amps_packed_gather(package, num_recv, num);
+  }
+
+  if (package->packed_shared)
+  {
+    /* Make this rank's values visible before the ready messages */
+    MPI_Win_sync(amps_shared_win);
+
+    for (i = num_recv; i < num; i++)
+    {
+      if (package->packed_shared[i])
+      {
+        MPI_Start(&(package->packed_done_requests[i]));
+      }
+    }
+  }
+
+  if (num)
+  {
+    MPI_Startall(num, package->packed_requests);
+  }
+
+  return(amps_NewHandle(amps_CommWorld, 0, NULL, package));
+}
+
+void _amps_wait_packed_exchange(amps_Handle handle)
+{
+  amps_Package package = handle->package;
+  int num_recv = package->num_recv;
+  int num = package->num_recv + package->num_send;
+  int i;
+
+  for (i = 0; i < num_recv; i++)
+  {
+    AMPS_CLEAR_INVOICE(package->recv_invoices[i]);
+  }
+
+  if (amps_exchange_timing)
+  {
+    _amps_timed_waitall(package, package->packed_requests,
+                        _amps_packed_timed_unpack);
+  }
+  else if (num)
+  {
+    MPI_Waitall(num, package->packed_requests, MPI_STATUSES_IGNORE);
+
+    if (package->packed_shared)
+    {
+      for (i = 0; i < num_recv; i++)
+      {
+        _amps_packed_unpack(package, i);
+      }
+    }
+    else
+    {
+      _amps_packed_scatter(package, 0, num_recv);
+    }
+  }
+
+  /* Receivers are done reading the values sent through shared memory */
+  if (package->packed_shared && num)
+  {
+    MPI_Waitall(num, package->packed_done_requests, MPI_STATUSES_IGNORE);
+  }
+}
+
+void _amps_free_packed_exchange(amps_Package package)
+{
+  int i;
+
+  if (package->packed_commited <= 0)
+  {
+    package->packed_commited = FALSE;
+    return;
+  }
+
+  for (i = 0; i < package->num_recv + package->num_send; i++)
+  {
+    MPI_Request_free(&(package->packed_requests[i]));
+
+    if (package->packed_shared && package->packed_shared[i])
+    {
+      MPI_Request_free(&(package->packed_done_requests[i]));
+    }
+  }
+
+  MPI_Free_mem(package->packed_buffer);
+  free(package->packed_index);
+  free(package->packed_offsets);
+  free(package->packed_requests);
+
+  if (package->packed_shared)
+  {
+    free(package->packed_shared);
+    free(package->packed_shared_index);
+    free(package->packed_done_requests);
+    package->packed_shared = NULL;
+  }
+
+  package->packed_commited = FALSE;
+}
+
 #ifdef AMPS_MPI_NOT_USE_PERSISTENT
 
 void _amps_wait_exchange(amps_Handle handle)
@@ -37,16 +888,35 @@ void _amps_wait_exchange(amps_Handle handle)
 
   MPI_Status *status;
 
+  if (handle->package->neighbor_commited)
+  {
+    _amps_wait_neighbor_exchange(handle);
+    return;
+  }
+
+  if (handle->package->packed_commited > 0)
+  {
+    _amps_wait_packed_exchange(handle);
+    return;
+  }
+
   if (handle->package->num_recv + handle->package->num_send)
   {
-    status = (MPI_Status*)calloc((handle->package->num_recv +
-                                  handle->package->num_send), sizeof(MPI_Status));
+    if (amps_exchange_timing)
+    {
+      _amps_timed_waitall(handle->package, handle->package->requests, NULL);
+    }
+    else
+    {
+      status = (MPI_Status*)calloc((handle->package->num_recv +
+                                    handle->package->num_send), sizeof(MPI_Status));
 
-    MPI_Waitall(handle->package->num_recv + handle->package->num_send,
-                handle->package->requests,
-                status);
+      MPI_Waitall(handle->package->num_recv + handle->package->num_send,
+                  handle->package->requests,
+                  status);
 
-    free(status);
+      free(status);
+    }
 
     for (i = 0; i < handle->package->num_recv; i++)
     {
@@ -72,8 +942,22 @@ void _amps_wait_exchange(amps_Handle handle)
 
 amps_Handle amps_IExchangePackage(amps_Package package)
 {
+  amps_Handle handle;
   int i;
 
+  if (amps_exchange_method == AMPS_EXCHANGE_NEIGHBOR)
+  {
+    return _amps_neighbor_exchange(package);
+  }
+
+  /* Packages that can not be flattened fall through to the datatypes */
+  if ((amps_exchange_method == AMPS_EXCHANGE_PACKED ||
+       amps_exchange_method == AMPS_EXCHANGE_SHARED) &&
+      (handle = _amps_packed_exchange(package)))
+  {
+    return handle;
+  }
+
   /*--------------------------------------------------------------------
    * post receives for data to get
    *--------------------------------------------------------------------*/
@@ -81,12 +965,12 @@ amps_Handle amps_IExchangePackage(amps_Package package)
 
   for (i = 0; i < package->num_recv; i++)
   {
-    amps_create_mpi_type(MPI_COMM_WORLD, package->recv_invoices[i]);
+    amps_create_mpi_type(amps_CommWorld, package->recv_invoices[i]);
 
     MPI_Type_commit(&(package->recv_invoices[i]->mpi_type));
 
     MPI_Irecv(MPI_BOTTOM, 1, package->recv_invoices[i]->mpi_type,
-              package->src[i], 0, MPI_COMM_WORLD,
+              package->src[i], 0, amps_CommWorld,
               &(package->requests[i]));
   }
 
@@ -95,15 +979,20 @@ amps_Handle amps_IExchangePackage(amps_Package package)
    *--------------------------------------------------------------------*/
   for (i = 0; i < package->num_send; i++)
   {
-    amps_create_mpi_type(MPI_COMM_WORLD, package->send_invoices[i]);
+    amps_create_mpi_type(amps_CommWorld, package->send_invoices[i]);
 
     MPI_Type_commit(&(package->send_invoices[i]->mpi_type));
 
     MPI_Isend(MPI_BOTTOM, 1, package->send_invoices[i]->mpi_type,
-              package->dest[i], 0, MPI_COMM_WORLD,
+              package->dest[i], 0, amps_CommWorld,
               &(package->requests[package->num_recv + i]));
   }
 
+  if (amps_exchange_timing)
+  {
+    _amps_time_messages(package);
+  }
+
   return(amps_NewHandle(NULL, 0, NULL, package));
 }
 
@@ -114,6 +1003,18 @@ void _amps_wait_exchange(amps_Handle handle)
   int i;
   int num;
 
+  if (handle->package->neighbor_commited)
+  {
+    _amps_wait_neighbor_exchange(handle);
+    return;
+  }
+
+  if (handle->package->packed_commited > 0)
+  {
+    _amps_wait_packed_exchange(handle);
+    return;
+  }
+
   num = handle->package->num_send + handle->package->num_recv;
 
   if (num)
@@ -126,8 +1027,16 @@ void _amps_wait_exchange(amps_Handle handle)
       }
     }
 
-    MPI_Waitall(num, handle->package->recv_requests,
-                handle->package->status);
+    if (amps_exchange_timing)
+    {
+      _amps_timed_waitall(handle->package, handle->package->recv_requests,
+                          NULL);
+    }
+    else
+    {
+      MPI_Waitall(num, handle->package->recv_requests,
+                  handle->package->status);
+    }
   }
 
 #ifdef AMPS_MPI_PACKAGE_LOWSTORAGE
@@ -205,9 +1114,23 @@ void _amps_wait_exchange(amps_Handle handle)
  */
 amps_Handle amps_IExchangePackage(amps_Package package)
 {
+  amps_Handle handle;
   int i;
   int num;
 
+  if (amps_exchange_method == AMPS_EXCHANGE_NEIGHBOR)
+  {
+    return _amps_neighbor_exchange(package);
+  }
+
+  /* Packages that can not be flattened fall through to the datatypes */
+  if ((amps_exchange_method == AMPS_EXCHANGE_PACKED ||
+       amps_exchange_method == AMPS_EXCHANGE_SHARED) &&
+      (handle = _amps_packed_exchange(package)))
+  {
+    return handle;
+  }
+
   num = package->num_send + package->num_recv;
 
   /*-------------------------------------------------------------------
@@ -239,7 +1162,7 @@ amps_Handle amps_IExchangePackage(amps_Package package)
     {
       for (i = 0; i < package->num_recv; i++)
       {
-        amps_create_mpi_type(MPI_COMM_WORLD, package->recv_invoices[i]);
+        amps_create_mpi_type(amps_CommWorld, package->recv_invoices[i]);
         MPI_Type_commit(&(package->recv_invoices[i]->mpi_type));
 
         // Temporaries needed by insure++
@@ -247,7 +1170,7 @@ amps_Handle amps_IExchangePackage(amps_Package package)
         MPI_Request *request_ptr = &(package->recv_requests[i]);
         MPI_Recv_init(MPI_BOTTOM, 1,
                       type,
-                      package->src[i], 0, MPI_COMM_WORLD,
+                      package->src[i], 0, amps_CommWorld,
                       request_ptr);
       }
     }
@@ -259,7 +1182,7 @@ amps_Handle amps_IExchangePackage(amps_Package package)
     {
       for (i = 0; i < package->num_send; i++)
       {
-        amps_create_mpi_type(MPI_COMM_WORLD,
+        amps_create_mpi_type(amps_CommWorld,
                              package->send_invoices[i]);
 
         MPI_Type_commit(&(package->send_invoices[i]->mpi_type));
@@ -269,12 +1192,17 @@ amps_Handle amps_IExchangePackage(amps_Package package)
         MPI_Request* request_ptr = &(package->send_requests[i]);
         MPI_Ssend_init(MPI_BOTTOM, 1,
                        type,
-                       package->dest[i], 0, MPI_COMM_WORLD,
+                       package->dest[i], 0, amps_CommWorld,
                        request_ptr);
       }
     }
   }
 
+  if (amps_exchange_timing)
+  {
+    _amps_time_messages(package);
+  }
+
   if (num)
   {
     /*--------------------------------------------------------------------
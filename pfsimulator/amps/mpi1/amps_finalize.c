@@ -63,11 +63,21 @@ extern int amps_mpi_initialized;
 
 int amps_Finalize()
 {
+  amps_FreeExchangeTiming();
+
   if (amps_mpi_initialized)
   {
+    amps_SharedMemoryFinalize();
+
     MPI_Comm_free(&amps_CommNode);
     MPI_Comm_free(&amps_CommWrite);
 
+    if (amps_CommIO != MPI_COMM_NULL)
+    {
+      MPI_Comm_free(&amps_CommIO);
+      MPI_Comm_free(&amps_CommWorld);
+    }
+
     MPI_Finalize();
   }
 
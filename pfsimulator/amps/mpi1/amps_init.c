@@ -52,8 +52,10 @@ int amps_node_rank;
 int amps_node_size;
 int amps_write_rank;
 int amps_write_size;
+MPI_Comm amps_CommWorld = MPI_COMM_NULL;
 MPI_Comm amps_CommNode = MPI_COMM_NULL;
 MPI_Comm amps_CommWrite = MPI_COMM_NULL;
+MPI_Comm amps_CommIO = MPI_COMM_NULL;
 
 #ifdef AMPS_F2CLIB_FIX
 int MAIN__()
@@ -80,6 +82,45 @@ uint32_t Adler32(unsigned char *data, size_t len) /* where data is the location
   return (b << 16) | a;
 }
 
+/*
+ * Create amps_CommNode with the amps_CommWorld nodes sharing memory with
+ * this node and amps_CommWrite with the first node of each of them.
+ */
+static void _amps_init_node_comms(void)
+{
+  /* Create communicator with one rank per compute node */
+#if MPI_VERSION >= 3
+  MPI_Comm_split_type(amps_CommWorld, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &amps_CommNode);
+#else
+  /* Split the node level communicator based on Adler32 hash keys of processor name */
+  char processor_name[MPI_MAX_PROCESSOR_NAME];
+  int namelen;
+  MPI_Get_processor_name(processor_name, &namelen);
+  uint32_t checkSum = Adler32((unsigned char*)processor_name, namelen);
+  /* Comm split only accepts non-negative numbers */
+  /* Not super great for hashing purposes but hoping MPI-3 code will be used on most cases */
+  checkSum &= INT_MAX;
+  MPI_Comm_split(amps_CommWorld, checkSum, amps_rank, &amps_CommNode);
+#endif
+  
+  MPI_Comm_rank(amps_CommNode, &amps_node_rank);
+  MPI_Comm_size(amps_CommNode, &amps_node_size);
+  int color;
+  if (amps_node_rank == 0)
+  {
+    color = 0;
+  }
+  else
+  {
+    color = 1;
+  }
+  MPI_Comm_split(amps_CommWorld, color, amps_rank, &amps_CommWrite);
+  if (amps_node_rank == 0)
+  {
+    MPI_Comm_size(amps_CommWrite, &amps_write_size);
+  }
+}
+
 /**
  *
  * Every {\em AMPS} program must call this function to initialize the
@@ -120,41 +161,12 @@ int amps_Init(int *argc, char **argv[])
   MPI_Init(argc, argv);
   amps_mpi_initialized = TRUE;
 
-  MPI_Comm_size(MPI_COMM_WORLD, &amps_size);
-  MPI_Comm_rank(MPI_COMM_WORLD, &amps_rank);
+  amps_CommWorld = MPI_COMM_WORLD;
 
-  /* Create communicator with one rank per compute node */
-#if MPI_VERSION >= 3
-  MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &amps_CommNode);
-#else
-  /* Split the node level communicator based on Adler32 hash keys of processor name */
-  char processor_name[MPI_MAX_PROCESSOR_NAME];
-  int namelen;
-  MPI_Get_processor_name(processor_name, &namelen);
-  uint32_t checkSum = Adler32((unsigned char*)processor_name, namelen);
-  /* Comm split only accepts non-negative numbers */
-  /* Not super great for hashing purposes but hoping MPI-3 code will be used on most cases */
-  checkSum &= INT_MAX;
-  MPI_Comm_split(MPI_COMM_WORLD, checkSum, amps_rank, &amps_CommNode);
-#endif
-  
-  MPI_Comm_rank(amps_CommNode, &amps_node_rank);
-  MPI_Comm_size(amps_CommNode, &amps_node_size);
-  int color;
-  if (amps_node_rank == 0)
-  {
-    color = 0;
-  }
-  else
-  {
-    color = 1;
-  }
-  MPI_Comm_split(MPI_COMM_WORLD, color, amps_rank, &amps_CommWrite);
-  if (amps_node_rank == 0)
-  {
-    MPI_Comm_size(amps_CommWrite, &amps_write_size);
-  }
+  MPI_Comm_size(amps_CommWorld, &amps_size);
+  MPI_Comm_rank(amps_CommWorld, &amps_rank);
 
+  _amps_init_node_comms();
 
 #ifdef AMPS_STDOUT_NOBUFF
   setbuf(stdout, NULL);
@@ -176,14 +188,14 @@ int amps_Init(int *argc, char **argv[])
     length = strlen(temp_path) + 1;
   }
 
-  MPI_Bcast(&length, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&length, 1, MPI_INT, 0, amps_CommWorld);
 
   if (amps_rank)
   {
     temp_path = malloc(length);
   }
 
-  MPI_Bcast(temp_path, length, MPI_CHAR, 0, MPI_COMM_WORLD);
+  MPI_Bcast(temp_path, length, MPI_CHAR, 0, amps_CommWorld);
 
   if (chdir(temp_path))
     printf("AMPS Error: can't set working directory to %s", temp_path);
@@ -200,9 +212,14 @@ int amps_Init(int *argc, char **argv[])
 #endif
 
 #ifdef AMPS_PRINT_HOSTNAME
-  MPI_Get_processor_name(processor_name, &namelen);
+  {
+    char processor_name[MPI_MAX_PROCESSOR_NAME];
+    int namelen;
+
+    MPI_Get_processor_name(processor_name, &namelen);
 
-  printf("Process %d on %s\n", amps_rank, processor_name);
+    printf("Process %d on %s\n", amps_rank, processor_name);
+  }
 #endif
 
   return 0;
@@ -232,8 +249,10 @@ int amps_Init(int *argc, char **argv[])
  */
 int amps_EmbeddedInit(void)
 {
-  MPI_Comm_size(MPI_COMM_WORLD, &amps_size);
-  MPI_Comm_rank(MPI_COMM_WORLD, &amps_rank);
+  amps_CommWorld = MPI_COMM_WORLD;
+
+  MPI_Comm_size(amps_CommWorld, &amps_size);
+  MPI_Comm_rank(amps_CommWorld, &amps_rank);
 
 #ifdef AMPS_STDOUT_NOBUFF
   setbuf(stdout, NULL);
@@ -257,4 +276,65 @@ int amps_EmbeddedInit(void)
   return 0;
 }
 
+/**
+ *
+ * Split the last {\bf num_io_servers} nodes off as I/O servers.  On
+ * every node \Ref{amps_CommWorld} is replaced by a communicator with
+ * either only the compute nodes or only the I/O servers, the node and
+ * write communicators are rebuilt to match and \Ref{amps_Rank} and
+ * \Ref{amps_Size} refer to the new context.  amps_CommIO is set to a
+ * communicator with all the nodes, ranked as in MPI_COMM_WORLD, for the
+ * messages between compute nodes and I/O servers.
+ *
+ * This must be called on all nodes after \Ref{amps_Init} and before any
+ * other communication or shared memory allocation.
+ *
+ * {\large Example:}
+ * \begin{verbatim}
+ * if (amps_IOServerSplit(2))
+ * {
+ *   serve output requests from amps_CommIO
+ * }
+ * \end{verbatim}
+ *
+ * {\large Notes:}
+ *
+ * {\bf num_io_servers} must be less than the number of nodes.  Nothing
+ * is done when it is 0.
+ *
+ * @memo Split off I/O server nodes
+ * @param num_io_servers Number of I/O server nodes [IN]
+ * @return TRUE on I/O servers, FALSE on compute nodes
+ */
+int amps_IOServerSplit(int num_io_servers)
+{
+  int world_size;
+  int world_rank;
+  int is_server;
+
+  if (num_io_servers <= 0)
+  {
+    return FALSE;
+  }
+
+  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+  MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+  is_server = (world_rank >= world_size - num_io_servers);
+
+  MPI_Comm_dup(MPI_COMM_WORLD, &amps_CommIO);
+  MPI_Comm_split(MPI_COMM_WORLD, is_server, world_rank, &amps_CommWorld);
+
+  MPI_Comm_size(amps_CommWorld, &amps_size);
+  MPI_Comm_rank(amps_CommWorld, &amps_rank);
 
+  if (amps_CommNode != MPI_COMM_NULL)
+  {
+    MPI_Comm_free(&amps_CommNode);
+    MPI_Comm_free(&amps_CommWrite);
+  }
+
+  _amps_init_node_comms();
+
+  return is_server;
+}
@@ -62,6 +62,9 @@ amps_Package amps_NewPackage(amps_Comm     comm,
 
 void amps_FreePackage(amps_Package package)
 {
+  _amps_free_neighbor_exchange(package);
+  _amps_free_packed_exchange(package);
+
   if (package->num_recv + package->num_send)
   {
     free(package->requests);
@@ -103,6 +106,9 @@ void amps_FreePackage(amps_Package package)
 
   if (package)
   {
+    _amps_free_neighbor_exchange(package);
+    _amps_free_packed_exchange(package);
+
     if (package->commited)
     {
       for (i = 0; i < package->num_recv; i++)
@@ -1,5 +1,7 @@
 /* amps_allreduce.c */
 int amps_AllReduce(amps_Comm comm, amps_Invoice invoice, MPI_Op operation);
+amps_Handle amps_IAllReduce(amps_Comm comm, amps_Invoice invoice, MPI_Op operation);
+void _amps_wait_reduce(amps_Handle handle);
 
 /* amps_bcast.c */
 int amps_BCast(amps_Comm comm, int source, amps_Invoice invoice);
@@ -16,6 +18,14 @@ amps_CPUClock_t amps_CPUClock(void);
 int amps_CreateInvoice(amps_Comm comm, amps_Invoice inv);
 
 /* amps_exchange.c */
+amps_Handle _amps_neighbor_exchange(amps_Package package);
+void _amps_wait_neighbor_exchange(amps_Handle handle);
+void _amps_free_neighbor_exchange(amps_Package package);
+amps_Handle _amps_packed_exchange(amps_Package package);
+void _amps_wait_packed_exchange(amps_Handle handle);
+void _amps_free_packed_exchange(amps_Package package);
+void amps_PrintExchangeTiming(FILE *file);
+void amps_FreeExchangeTiming(void);
 void _amps_wait_exchange(amps_Handle handle);
 amps_Handle amps_IExchangePackage(amps_Package package);
 void _amps_wait_exchange(amps_Handle handle);
@@ -36,6 +46,7 @@ amps_File amps_Fopen(char *filename, char *type);
 /* amps_init.c */
 int amps_Init(int *argc, char **argv []);
 int amps_EmbeddedInit(void);
+int amps_IOServerSplit(int num_io_servers);
 
 /* amps_invoice.c */
 void amps_AppendInvoice(amps_Invoice *invoice, amps_Invoice append_invoice);
@@ -99,6 +110,13 @@ int amps_SFclose(amps_File file);
 /* amps_sfopen.c */
 amps_File amps_SFopen(const char *filename, const char *type);
 
+/* amps_shmem.c */
+int amps_SharedMemoryInit(long size);
+void amps_SharedMemoryFinalize(void);
+long amps_SharedMemoryOffset(void *ptr);
+void *amps_SharedAlloc(size_t size);
+void amps_SharedFree(void *ptr);
+
 /* amps_sizeofinvoice.c */
 long amps_sizeof_invoice(amps_Comm comm, amps_Invoice inv);
 
@@ -0,0 +1,219 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+
+#include <string.h>
+
+#include "amps.h"
+
+/*---------------------------------------------------------------------------
+ * Node shared memory arena
+ *
+ * amps_SharedMemoryInit allocates an MPI-3 shared memory window over
+ * amps_CommNode with one segment per rank.  Vector data is explicitly
+ * allocated from this rank's segment with amps_SharedAlloc, so the vectors
+ * of ranks on the same node can be addressed directly; everything else
+ * keeps using amps_TAlloc.  The segment is managed first fit with a header
+ * in front of each block, free blocks are merged with the blocks that
+ * follow them when searched.  The arena is not locked, it must only be
+ * used from the main thread.
+ *---------------------------------------------------------------------------*/
+
+typedef struct {
+  size_t size;          /* bytes in the block including this header */
+  size_t used;
+} amps_SharedBlock;
+
+MPI_Win amps_shared_win = MPI_WIN_NULL;
+char  **amps_shared_node_base = NULL;
+int    *amps_shared_node_rank = NULL;
+
+static char   *amps_shared_base = NULL;
+static size_t amps_shared_size = 0;
+
+#define AMPS_SHARED_ALIGN(size) \
+  (((size) + sizeof(amps_SharedBlock) - 1) / sizeof(amps_SharedBlock) \
+   * sizeof(amps_SharedBlock))
+
+/*===========================================================================*/
+/**
+ *
+ * Allocate the node shared memory arena with {\bf size} bytes for this
+ * rank.  This is collective over all ranks and must be called before the
+ * data that should be shared is allocated.
+ *
+ * @memo Allocate the node shared memory arena
+ * @param size bytes of shared memory for this rank
+ * @return Error code
+ */
+int amps_SharedMemoryInit(long size)
+{
+  MPI_Group world_group;
+  MPI_Group node_group;
+  MPI_Info info;
+  MPI_Aint segment_size;
+  int disp_unit;
+  int *world_ranks;
+  int i;
+
+  if (amps_shared_base || size < (long)(2 * sizeof(amps_SharedBlock)))
+  {
+    return 1;
+  }
+
+  amps_shared_size = AMPS_SHARED_ALIGN((size_t)size);
+
+  MPI_Info_create(&info);
+  MPI_Info_set(info, "alloc_shared_noncontig", "true");
+  MPI_Win_allocate_shared((MPI_Aint)amps_shared_size, 1, info, amps_CommNode,
+                          &amps_shared_base, &amps_shared_win);
+  MPI_Info_free(&info);
+
+  /* One passive target epoch for the lifetime of the window, MPI_Win_sync
+   * orders the direct loads and stores */
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, amps_shared_win);
+
+  ((amps_SharedBlock*)amps_shared_base)->size = amps_shared_size;
+  ((amps_SharedBlock*)amps_shared_base)->used = FALSE;
+
+  amps_shared_node_base = (char**)calloc((size_t)amps_node_size,
+                                         sizeof(char*));
+  for (i = 0; i < amps_node_size; i++)
+  {
+    MPI_Win_shared_query(amps_shared_win, i, &segment_size, &disp_unit,
+                         &(amps_shared_node_base[i]));
+  }
+
+  world_ranks = (int*)malloc(sizeof(int) * (size_t)amps_size);
+  amps_shared_node_rank = (int*)malloc(sizeof(int) * (size_t)amps_size);
+  for (i = 0; i < amps_size; i++)
+  {
+    world_ranks[i] = i;
+  }
+
+  MPI_Comm_group(amps_CommWorld, &world_group);
+  MPI_Comm_group(amps_CommNode, &node_group);
+  MPI_Group_translate_ranks(world_group, amps_size, world_ranks,
+                            node_group, amps_shared_node_rank);
+  MPI_Group_free(&world_group);
+  MPI_Group_free(&node_group);
+
+  free(world_ranks);
+
+  return 0;
+}
+
+void amps_SharedMemoryFinalize()
+{
+  if (!amps_shared_base)
+  {
+    return;
+  }
+
+  MPI_Win_unlock_all(amps_shared_win);
+  MPI_Win_free(&amps_shared_win);
+
+  free(amps_shared_node_base);
+  free(amps_shared_node_rank);
+
+  amps_shared_node_base = NULL;
+  amps_shared_node_rank = NULL;
+  amps_shared_base = NULL;
+  amps_shared_size = 0;
+}
+
+/* Offset of ptr in this rank's segment or -1 if it is not in it */
+long amps_SharedMemoryOffset(void *ptr)
+{
+  if (amps_shared_base && (char*)ptr >= amps_shared_base &&
+      (char*)ptr < amps_shared_base + amps_shared_size)
+  {
+    return (long)((char*)ptr - amps_shared_base);
+  }
+
+  return -1;
+}
+
+/* Cleared block of size bytes from this rank's segment, NULL if there is
+ * no arena or no free block is large enough */
+void *amps_SharedAlloc(size_t size)
+{
+  amps_SharedBlock *block;
+  amps_SharedBlock *next;
+  amps_SharedBlock *split;
+  char *end = amps_shared_base + amps_shared_size;
+  size_t need;
+
+  if (!amps_shared_base)
+  {
+    return NULL;
+  }
+
+  need = AMPS_SHARED_ALIGN(size) + sizeof(amps_SharedBlock);
+
+  for (block = (amps_SharedBlock*)amps_shared_base; (char*)block < end;
+       block = (amps_SharedBlock*)((char*)block + block->size))
+  {
+    if (block->used)
+    {
+      continue;
+    }
+
+    next = (amps_SharedBlock*)((char*)block + block->size);
+    while ((char*)next < end && !next->used)
+    {
+      block->size += next->size;
+      next = (amps_SharedBlock*)((char*)block + block->size);
+    }
+
+    if (block->size >= need)
+    {
+      if (block->size - need >= 2 * sizeof(amps_SharedBlock))
+      {
+        split = (amps_SharedBlock*)((char*)block + need);
+        split->size = block->size - need;
+        split->used = FALSE;
+        block->size = need;
+      }
+
+      block->used = TRUE;
+      memset(block + 1, 0, size);
+      return (void*)(block + 1);
+    }
+  }
+
+  return NULL;
+}
+
+/* Return a block from amps_SharedAlloc to the arena */
+void amps_SharedFree(void *ptr)
+{
+  if (amps_SharedMemoryOffset(ptr) >= 0)
+  {
+    ((amps_SharedBlock*)ptr - 1)->used = FALSE;
+  }
+}
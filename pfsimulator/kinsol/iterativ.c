@@ -139,6 +139,54 @@ int ClassicalGS(N_Vector *v, real **h, int k, int p, real *new_vk_norm,
   return(0);
 }
 
+/************************ ClassicalGS2 *******************************
+ * Classical Gram-Schmidt with one reorthogonalization pass (CGS2).
+ * The second pass makes the result as orthogonal as modified
+ * Gram-Schmidt while every pass needs a single N_VDotProdMulti.
+ **********************************************************************/
+
+int ClassicalGS2(N_Vector *v, real **h, int k, int p, real *new_vk_norm,
+                 real *s)
+{
+  int i, k_minus_1, i0, n;
+  real new_norm_2;
+
+  k_minus_1 = k - 1;
+  i0 = MAX(k - p, 0);
+  n = k - i0;
+
+  /* First pass: h = V^T v[k], v[k] = v[k] - V h */
+
+  N_VDotProdMulti(n, v[k], v + i0, s);
+
+  for (i = i0; i < k; i++)
+  {
+    h[i][k_minus_1] = s[i - i0];
+    N_VLinearSum(ONE, v[k], -s[i - i0], v[i], v[k]);
+  }
+
+  /* Second pass, also computing the norm of v[k] which is the last
+   * vector of the batch */
+
+  N_VDotProdMulti(n + 1, v[k], v + i0, s);
+
+  new_norm_2 = s[n];
+  for (i = i0; i < k; i++)
+  {
+    h[i][k_minus_1] += s[i - i0];
+    N_VLinearSum(ONE, v[k], -s[i - i0], v[i], v[k]);
+    new_norm_2 -= SQR(s[i - i0]);
+  }
+
+  /* v[k] is orthogonal to the v[i] after the first pass up to
+   * roundoff, so removing the small corrections changes its squared
+   * norm by the sum of their squares */
+
+  *new_vk_norm = (new_norm_2 > ZERO) ? RSqrt(new_norm_2) : ZERO;
+
+  return(0);
+}
+
 /*************** QRfact **********************************************
  * This implementation of QRfact is a slight modification of a previous
  * routine (called qrfact) written by Milo Dorr.
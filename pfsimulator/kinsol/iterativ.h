@@ -57,9 +57,13 @@ enum precond_type { NONE, LEFT, RIGHT, BOTH };
 *                Gram-Schmidt routine ClassicalGS listed in this *
 *                file.                                           *
 *                                                                *
+* CLASSICAL_GS2 : The iterative solver uses the classical        *
+*                Gram-Schmidt routine with reorthogonalization   *
+*                ClassicalGS2 listed in this file.               *
+*                                                                *
 ******************************************************************/
 
-enum gs_type { MODIFIED_GS, CLASSICAL_GS };
+enum gs_type { MODIFIED_GS, CLASSICAL_GS, CLASSICAL_GS2 };
 
 
 /******************************************************************
@@ -165,6 +169,30 @@ int ClassicalGS(N_Vector *v, real **h, int k, int p, real *new_vk_norm,
                 N_Vector temp, real *s);
 
 
+/******************************************************************
+*                                                                *
+* Function: ClassicalGS2                                         *
+*----------------------------------------------------------------*
+* ClassicalGS2 performs a classical Gram-Schmidt                 *
+* orthogonalization of the N_Vector v[k] against the p unit      *
+* N_Vectors at v[k-1], v[k-2], ..., v[k-p], followed by one      *
+* unconditional reorthogonalization pass. The inner products of  *
+* each pass are computed with N_VDotProdMulti, so each pass does *
+* one global reduction however large p is. The parameters v, h,  *
+* k, p, and new_vk_norm are as described in the documentation    *
+* for ModifiedGS.                                                *
+*                                                                *
+* s is a length p+1 array of reals which can be used as          *
+* workspace by the ClassicalGS2 routine.                         *
+*                                                                *
+* ClassicalGS2 returns 0 to indicate success. It cannot fail.    *
+*                                                                *
+******************************************************************/
+
+int ClassicalGS2(N_Vector *v, real **h, int k, int p, real *new_vk_norm,
+                 real *s);
+
+
 /******************************************************************
 *                                                                *
 * Function: QRfact                                               *
@@ -19,6 +19,7 @@
 #include "llnlmath.h"
 #include "iterativ.h"
 #include "spgmr.h"
+#include "pspgmr.h"
 
 
 /* Error Messages */
@@ -73,6 +74,16 @@ typedef struct {
   SpgmrMem g_spgmr_mem;
   /* spgmr_mem is memory used by the
    * generic Spgmr solver                           */
+
+  PSpgmrMem g_pspgmr_mem;
+  /* pspgmr_mem is memory used by the
+   * pipelined Spgmr solver, NULL unless
+   * it was selected                                */
+
+  real *g_res_hist;
+  /* res_hist holds the residual norm of
+   * each linear iteration when the history
+   * is logged, otherwise NULL                      */
 } KINSpgmrMemRec, *KINSpgmrMem;
 
 
@@ -120,6 +131,8 @@ static int KINSpgmrPSolve(void *kinsol_mem, N_Vector r, N_Vector z, int lr);
 #define precondflag (kin_mem->kin_precondflag)
 
 #define spgmr_mem (kinspgmr_mem->g_spgmr_mem)
+#define pspgmr_mem (kinspgmr_mem->g_pspgmr_mem)
+#define res_hist (kinspgmr_mem->g_res_hist)
 #define nli     (kinspgmr_mem->g_nli)
 #define npe     (kinspgmr_mem->g_npe)
 #define nps     (kinspgmr_mem->g_nps)
@@ -220,6 +233,9 @@ int KINSpgmr(void *kinsol_mem, int maxl, int maxlrst, int msbpre,
   kin_mem->kin_msbpre = (msbpre <= 0)
                         ? KINSPGMR_MSBPRE : msbpre;
 
+  kinspgmr_mem->g_pspgmr_mem = NULL;
+  kinspgmr_mem->g_res_hist = NULL;
+
   /* Call SpgmrMalloc to allocate workspace for Spgmr */
   spgmr_mem = SpgmrMalloc(Neq, kinspgmr_mem->g_maxl, machenv);
 
@@ -236,6 +252,117 @@ int KINSpgmr(void *kinsol_mem, int maxl, int maxlrst, int msbpre,
   return(0);
 }
 
+/*************** KINSpgmrSetGSType ************************************
+*
+*  This routine selects the Gram-Schmidt routine used by SPGMR to
+*  orthogonalize the Krylov basis. It must be called after KINSpgmr.
+*
+**********************************************************************/
+
+int KINSpgmrSetGSType(void *kinsol_mem, int gstype)
+{
+  KINMem kin_mem;
+  KINSpgmrMem kinspgmr_mem;
+
+  kin_mem = (KINMem)kinsol_mem;
+
+  if (kin_mem == NULL)
+    return(KIN_MEM_NULL);
+
+  kinspgmr_mem = (KINSpgmrMem)lmem;
+
+  if (kinspgmr_mem == NULL)
+  {
+    fprintf(msgfp, MSG_MEM_FAIL);
+    return(KINSPGMR_MEM_FAIL);
+  }
+
+  kinspgmr_mem->g_gstype = gstype;
+
+  return(0);
+}
+
+
+/*************** KINSpgmrSetPipelined *********************************
+*
+*  This routine replaces the workspace of SPGMR with that of the
+*  pipelined solver PSPGMR, which KINSpgmrSolve then calls instead. It
+*  must be called after KINSpgmr.
+*
+**********************************************************************/
+
+int KINSpgmrSetPipelined(void *kinsol_mem, boole pipelined)
+{
+  KINMem kin_mem;
+  KINSpgmrMem kinspgmr_mem;
+
+  kin_mem = (KINMem)kinsol_mem;
+  if (kin_mem == NULL)
+    return(KIN_MEM_NULL);
+
+  kinspgmr_mem = (KINSpgmrMem)lmem;
+  if (kinspgmr_mem == NULL)
+  {
+    fprintf(msgfp, MSG_MEM_FAIL);
+    return(KINSPGMR_MEM_FAIL);
+  }
+
+  if (!pipelined || (pspgmr_mem != NULL))
+    return(0);
+
+  pspgmr_mem = PSpgmrMalloc(Neq, kinspgmr_mem->g_maxl, machenv);
+  if (pspgmr_mem == NULL)
+  {
+    fprintf(msgfp, MSG_MEM_FAIL);
+    return(SPGMR_MEM_FAIL);
+  }
+
+  SpgmrFree(spgmr_mem);
+  spgmr_mem = NULL;
+
+  return(0);
+}
+
+/*************** KINSpgmrSetHistory ***********************************
+*
+*  This routine allocates the residual history of the linear solves,
+*  one value per iteration of a single call to the generic solver.
+*  It must be called after KINSpgmr.
+*
+**********************************************************************/
+
+int KINSpgmrSetHistory(void *kinsol_mem, boole history)
+{
+  KINMem kin_mem;
+  KINSpgmrMem kinspgmr_mem;
+
+  kin_mem = (KINMem)kinsol_mem;
+  if (kin_mem == NULL)
+    return(KIN_MEM_NULL);
+
+  kinspgmr_mem = (KINSpgmrMem)lmem;
+  if (kinspgmr_mem == NULL)
+  {
+    fprintf(msgfp, MSG_MEM_FAIL);
+    return(KINSPGMR_MEM_FAIL);
+  }
+
+  free(res_hist);
+  res_hist = NULL;
+
+  if (history)
+  {
+    res_hist = (real*)malloc((size_t)((kinspgmr_mem->g_maxlrst + 1)
+                                      * kinspgmr_mem->g_maxl) * sizeof(real));
+    if (res_hist == NULL)
+    {
+      fprintf(msgfp, MSG_MEM_FAIL);
+      return(KINSPGMR_MEM_FAIL);
+    }
+  }
+
+  return(0);
+}
 
 /* Additional readability Replacements */
 #define pretype (kinspgmr_mem->g_pretype)
@@ -345,7 +472,7 @@ static int KINSpgmrSolve(KINMem kin_mem, N_Vector xx, N_Vector bb,
                          real *res_norm)
 {
   KINSpgmrMem kinspgmr_mem;
-  int ret, nli_inc, nps_inc;
+  int i, ret, nli_inc, nps_inc;
 
   kinspgmr_mem = (KINSpgmrMem)lmem;
 
@@ -357,10 +484,16 @@ static int KINSpgmrSolve(KINMem kin_mem, N_Vector xx, N_Vector bb,
   kinspgmr_mem->g_new_uu = TRUE;  /* set flag required for user Jacobian rtn */
 
   /* Call SpgmrSolve  */
-  ret = SpgmrSolve(spgmr_mem, kin_mem, xx, bb, pretype, gstype, eps,
-                   maxlinrestarts, kin_mem, fscale, fscale,
-                   KINSpgmrAtimes, KINSpgmrPSolve,
-                   res_norm, &nli_inc, &nps_inc);
+  if (pspgmr_mem != NULL)
+    ret = PSpgmrSolve(pspgmr_mem, kin_mem, xx, bb, pretype, eps,
+                      maxlinrestarts, kin_mem, fscale, fscale,
+                      KINSpgmrAtimes, KINSpgmrPSolve,
+                      res_norm, &nli_inc, &nps_inc, res_hist);
+  else
+    ret = SpgmrSolve(spgmr_mem, kin_mem, xx, bb, pretype, gstype, eps,
+                     maxlinrestarts, kin_mem, fscale, fscale,
+                     KINSpgmrAtimes, KINSpgmrPSolve,
+                     res_norm, &nli_inc, &nps_inc, res_hist);
   /* Increment counters nli, nps, and ncfl
    * (nni is updated in the KINSol main iteration loop) */
   nli += nli_inc;
@@ -369,6 +502,13 @@ static int KINSpgmrSolve(KINMem kin_mem, N_Vector xx, N_Vector bb,
   if (kin_mem->kin_printfl == 3)
     fprintf(msgfp, "KINSpgmrSolve: nli_inc=%d\n", nli_inc);
 
+  if ((res_hist != NULL) && (msgfp != NULL))
+  {
+    for (i = 0; i < nli_inc; i++)
+      fprintf(msgfp, "KINSpgmrSolve: linear iteration %d residual norm %12.6e\n",
+              i + 1, res_hist[i]);
+  }
+
   if (ioptExists)
   {
     iopt[SPGMR_NLI] = nli;
@@ -428,6 +568,8 @@ static int KINSpgmrFree(KINMem kin_mem)
   kinspgmr_mem = (KINSpgmrMem)lmem;
 
   SpgmrFree(spgmr_mem);
+  PSpgmrFree(pspgmr_mem);
+  free(res_hist);
   free(lmem);
   return(0);
 }
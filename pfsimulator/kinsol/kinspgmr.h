@@ -328,6 +328,56 @@ int KINSpgmr(void *kin_mem, int maxl, int maxlrst, int msbpre,
              KINSpgmruserAtimesFn userAtimes,
              void *P_data);
 
+
+/******************************************************************
+*                                                                *
+* Function : KINSpgmrSetGSType                                   *
+*----------------------------------------------------------------*
+* KINSpgmrSetGSType selects the Gram-Schmidt orthogonalization   *
+* used by SPGMR, one of MODIFIED_GS (the default), CLASSICAL_GS  *
+* or CLASSICAL_GS2 from iterativ.h. It must be called after      *
+* KINSpgmr.                                                      *
+*                                                                *
+*       KINSpgmrSetGSType returns SUCCESS, KIN_MEM_NULL or       *
+*       KINSPGMR_MEM_FAIL.                                       *
+*                                                                *
+******************************************************************/
+
+int KINSpgmrSetGSType(void *kin_mem, int gstype);
+
+
+/******************************************************************
+*                                                                *
+* Function : KINSpgmrSetPipelined                                *
+*----------------------------------------------------------------*
+* KINSpgmrSetPipelined selects the pipelined variant of SPGMR    *
+* (see pspgmr.h) when pipelined is TRUE. It must be called after *
+* KINSpgmr and before KINSol; the Gram-Schmidt type set by       *
+* KINSpgmrSetGSType does not apply to the pipelined solver.      *
+*                                                                *
+*       KINSpgmrSetPipelined returns SUCCESS, KIN_MEM_NULL,      *
+*       KINSPGMR_MEM_FAIL or SPGMR_MEM_FAIL.                     *
+*                                                                *
+******************************************************************/
+
+int KINSpgmrSetPipelined(void *kin_mem, boole pipelined);
+
+
+/******************************************************************
+*                                                                *
+* Function : KINSpgmrSetHistory                                  *
+*----------------------------------------------------------------*
+* KINSpgmrSetHistory, with history TRUE, makes each linear solve *
+* write the residual norm estimate of every linear iteration to  *
+* the KINSol message file. It must be called after KINSpgmr.     *
+*                                                                *
+*       KINSpgmrSetHistory returns SUCCESS, KIN_MEM_NULL or      *
+*       KINSPGMR_MEM_FAIL.                                       *
+*                                                                *
+******************************************************************/
+
+int KINSpgmrSetHistory(void *kin_mem, boole history);
+
 END_EXTERN_C
 
 #endif
@@ -0,0 +1,500 @@
+/******************************************************************
+* File          : pspgmr.c                                       *
+*----------------------------------------------------------------*
+* This is the implementation file for the pipelined scaled       *
+* preconditioned GMRES (PSPGMR) iterative linear solver.         *
+*                                                                *
+******************************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "iterativ.h"
+#include "spgmr.h"
+#include "pspgmr.h"
+#include "llnltyps.h"
+#include "vector.h"
+#include "llnlmath.h"
+
+
+#define ZERO RCONST(0.0)
+#define ONE  RCONST(1.0)
+
+
+/*************** Private Helper Function Prototype *******************/
+
+static int PSpgmrATimes(void *A_data, void *P_data, N_Vector s1,
+                        N_Vector s2, ATimesFn atimes, PSolveFn psolve,
+                        boole preOnLeft, boole preOnRight, N_Vector v,
+                        N_Vector z, N_Vector vtemp, int *nps);
+
+
+/*************** PSpgmrMalloc ****************************************/
+
+PSpgmrMem PSpgmrMalloc(integer N, int l_max, void *machEnv)
+{
+  PSpgmrMem mem;
+  int k;
+
+  mem = (PSpgmrMem)calloc(1, sizeof(PSpgmrMemRec));
+  if (mem == NULL)
+    return(NULL);
+
+  mem->spgmr_mem = SpgmrMalloc(N, l_max, machEnv);
+  if (mem->spgmr_mem == NULL)
+  {
+    free(mem);
+    return(NULL);
+  }
+
+  /* Get memory for the triangular factor R and the reduction. */
+
+  mem->R = (real**)calloc((size_t)(l_max + 1), sizeof(real *));
+  mem->dots = (real*)malloc((size_t)(l_max + 2) * sizeof(real));
+  mem->dot_x = (N_Vector*)malloc((size_t)(l_max + 2) * sizeof(N_Vector));
+  mem->dot_y = (N_Vector*)malloc((size_t)(l_max + 2) * sizeof(N_Vector));
+  if ((mem->R == NULL) || (mem->dots == NULL) || (mem->dot_x == NULL) ||
+      (mem->dot_y == NULL))
+  {
+    PSpgmrFree(mem);
+    return(NULL);
+  }
+
+  for (k = 0; k <= l_max; k++)
+  {
+    mem->R[k] = (real*)malloc((size_t)(l_max) * sizeof(real));
+    if (mem->R[k] == NULL)
+    {
+      PSpgmrFree(mem);
+      return(NULL);
+    }
+  }
+
+  return(mem);
+}
+
+
+/*************** PSpgmrSolve *****************************************/
+
+int PSpgmrSolve(PSpgmrMem mem, void *A_data, N_Vector x, N_Vector b,
+                int pretype, real delta, int max_restarts,
+                void *P_data, N_Vector s1, N_Vector s2, ATimesFn atimes,
+                PSolveFn psolve, real *res_norm, int *nli, int *nps,
+                real *res_hist)
+{
+  N_Vector *V, xcor, vtemp, zcur, znext;
+  N_Vector *dot_x, *dot_y;
+  N_VHandle handle;
+  real **Hes, **R, *givens, *yg, *dots;
+  real beta, rotation_product, r_norm, s_product, rho = 0, h_norm = 0, w;
+  boole preOnLeft, preOnRight, scale2, scale1, converged;
+  int i, j, k, l, it, l_max, krydim = 0, ier, ntries, ncol, ndots;
+
+  if (mem == NULL)
+    return(SPGMR_MEM_NULL);
+
+  /* Make local copies of mem variables. */
+  l_max = mem->spgmr_mem->l_max;
+  V = mem->spgmr_mem->V;
+  Hes = mem->spgmr_mem->Hes;
+  givens = mem->spgmr_mem->givens;
+  xcor = mem->spgmr_mem->xcor;
+  yg = mem->spgmr_mem->yg;
+  vtemp = mem->spgmr_mem->vtemp;
+  R = mem->R;
+  dots = mem->dots;
+  dot_x = mem->dot_x;
+  dot_y = mem->dot_y;
+
+  *nli = *nps = 0;     /* Initialize counters */
+  converged = FALSE;   /* Initialize converged flag */
+
+  if (max_restarts < 0)
+    max_restarts = 0;
+
+  if ((pretype != LEFT) && (pretype != RIGHT) && (pretype != BOTH))
+    pretype = NONE;
+
+  preOnLeft = ((pretype == LEFT) || (pretype == BOTH));
+  preOnRight = ((pretype == RIGHT) || (pretype == BOTH));
+  scale1 = (s1 != NULL);
+  scale2 = (s2 != NULL);
+
+  /* Set vtemp and V[0] to initial (unscaled) residual r_0 = b - A*x_0. */
+
+  if (N_VDotProd(x, x) == ZERO)
+  {
+    N_VScale(ONE, b, vtemp);
+  }
+  else
+  {
+    if (atimes(A_data, x, vtemp) != 0)
+      return(SPGMR_ATIMES_FAIL);
+    N_VLinearSum(ONE, b, -ONE, vtemp, vtemp);
+  }
+  N_VScale(ONE, vtemp, V[0]);
+
+  /* Apply left preconditioner and left scaling to V[0] = r_0. */
+
+  if (preOnLeft)
+  {
+    ier = psolve(P_data, V[0], vtemp, LEFT);
+    (*nps)++;
+    if (ier != 0)
+      return((ier < 0) ? SPGMR_PSOLVE_FAIL_UNREC : SPGMR_PSOLVE_FAIL_REC);
+  }
+  else
+  {
+    N_VScale(ONE, V[0], vtemp);
+  }
+
+  if (scale1)
+  {
+    N_VProd(s1, vtemp, V[0]);
+  }
+  else
+  {
+    N_VScale(ONE, vtemp, V[0]);
+  }
+
+  /* Set r_norm = beta to L2 norm of V[0] = s1 P1_inv r_0, and
+   * return if small.  */
+
+  *res_norm = r_norm = beta = RSqrt(N_VDotProd(V[0], V[0]));
+  if (r_norm <= delta)
+    return(SPGMR_SUCCESS);
+
+  /* Set xcor = 0. */
+
+  N_VConst(ZERO, xcor);
+
+
+  /* Begin outer iterations: up to (max_restarts + 1) attempts. */
+
+  for (ntries = 0; ntries <= max_restarts; ntries++)
+  {
+    /* Initialize the Hessenberg matrix Hes, its factor R and the Givens
+     *  rotation product.  Normalize the initial vector V[0].           */
+
+    for (i = 0; i <= l_max; i++)
+      for (j = 0; j < l_max; j++)
+        Hes[i][j] = R[i][j] = ZERO;
+
+    rotation_product = ONE;
+
+    N_VScale(ONE / r_norm, V[0], V[0]);
+
+    handle = NULL;
+
+    /* Pipelined loop: iteration it applies A-tilde to V[it], finishes
+     * column it-1 of Hes from the reduction started in the previous
+     * iteration and completes Arnoldi step it-2.  Until then V[it-1]
+     * is orthogonal but not normalized and V[it] = A-tilde V[it-1]. */
+
+    for (it = 0; it <= l_max + 1; it++)
+    {
+      zcur = (it <= l_max) ? V[it] : NULL;
+      znext = (it < l_max) ? V[it + 1] : NULL;
+
+      /* Generate V[it+1] = A-tilde V[it] while the reduction is in
+       * progress. */
+
+      if (znext != NULL)
+      {
+        ier = PSpgmrATimes(A_data, P_data, s1, s2, atimes, psolve,
+                           preOnLeft, preOnRight, zcur, znext, vtemp, nps);
+        if (ier != 0)
+        {
+          N_VDotProdPairsFinalize(handle);
+          return(ier);
+        }
+      }
+
+      /* Finish the reduction: column it-1 of Hes up to the diagonal
+       * and the norm of V[it-1]. */
+
+      if (it > 0)
+      {
+        N_VDotProdPairsFinalize(handle);
+        handle = NULL;
+
+        ncol = (it - 1 < l_max) ? it : 0;
+        for (k = 0; k < ncol; k++)
+          Hes[k][it - 1] = dots[k];
+
+        if (it > 1)
+          Hes[it - 1][it - 2] = h_norm = RSqrt(dots[ncol]);
+      }
+
+      if (it > 1)
+      {
+        (*nli)++;
+
+        l = it - 2;
+        krydim = l + 1;
+
+        /*  Update the QR factorization with column l of Hes. */
+
+        for (k = 0; k <= l + 1; k++)
+          R[k][l] = Hes[k][l];
+
+        if (QRfact(krydim, R, givens, l) != 0)
+          return(SPGMR_QRFACT_FAIL);
+
+        /*  Update residual norm estimate; break if convergence test
+         *  passes. */
+
+        rotation_product *= givens[2 * l + 1];
+        *res_norm = rho = ABS(rotation_product * r_norm);
+
+        if (res_hist != NULL)
+          res_hist[*nli - 1] = rho;
+
+        if ((rho <= delta) || (h_norm == ZERO))
+        {
+          converged = TRUE; break;
+        }
+
+        /* Normalize V[it-1], the basis is complete up to here. */
+
+        N_VScale(ONE / h_norm, V[it - 1], V[it - 1]);
+
+        if (it == l_max + 1)
+          break;
+
+        /* V[it], V[it+1] and column it-1 of Hes were computed from the
+         * unnormalized V[it-1]. */
+
+        N_VScale(ONE / h_norm, zcur, zcur);
+        if (znext != NULL)
+          N_VScale(ONE / h_norm, znext, znext);
+
+        for (k = 0; k < it - 1; k++)
+          Hes[k][it - 1] /= h_norm;
+        Hes[it - 1][it - 1] /= h_norm * h_norm;
+      }
+
+      if (it > 0)
+      {
+        /* V[it+1] is A-tilde of the unorthogonalized V[it], so
+         * subtract A-tilde of its projections on the V[j], j < it:
+         *   V[it+1] -= sum_j Hes[j][it-1] A-tilde V[j]
+         * where A-tilde V[it-1] is V[it] and, for j < it-1,
+         *   A-tilde V[j] = sum_{k <= j+1} Hes[k][j] V[k]             */
+
+        if (znext != NULL)
+        {
+          for (k = 0; k < it; k++)
+          {
+            w = ZERO;
+            for (j = MAX(0, k - 1); j < it - 1; j++)
+              w -= Hes[k][j] * Hes[j][it - 1];
+            if (w != ZERO)
+              N_VLinearSum(ONE, znext, w, V[k], znext);
+          }
+          N_VLinearSum(ONE, znext, -Hes[it - 1][it - 1], zcur, znext);
+        }
+
+        /* Orthogonalize V[it] against previous V[k]. */
+
+        for (k = 0; k < it; k++)
+          N_VLinearSum(ONE, zcur, -Hes[k][it - 1], V[k], zcur);
+      }
+
+      /* Start the reduction for column it of Hes and the norm of
+       * V[it]. */
+
+      ndots = 0;
+      if (znext != NULL)
+      {
+        for (k = 0; k <= it; k++)
+        {
+          dot_x[ndots] = znext;
+          dot_y[ndots] = V[k];
+          ndots++;
+        }
+      }
+      if (it > 0)
+      {
+        dot_x[ndots] = zcur;
+        dot_y[ndots] = zcur;
+        ndots++;
+      }
+
+      if (ndots > 0)
+        handle = N_VDotProdPairsInit(ndots, dot_x, dot_y, dots);
+    }
+
+    /* Inner loop is done.  Compute the new correction vector xcor. */
+
+    /* Construct g, then solve for y. */
+    yg[0] = r_norm;
+    for (i = 1; i <= krydim; i++)
+      yg[i] = ZERO;
+    if (QRsol(krydim, R, givens, yg) != 0)
+      return(SPGMR_QRSOL_FAIL);
+
+    /* Add correction vector V_l y to xcor. */
+    for (k = 0; k < krydim; k++)
+      N_VLinearSum(yg[k], V[k], ONE, xcor, xcor);
+
+    /* If converged, construct the final solution vector x and return. */
+    if (converged)
+    {
+      /* Apply right scaling and right precond.: vtemp = P2_inv s2_inv xcor. */
+
+      if (scale2)
+        N_VDiv(xcor, s2, xcor);
+      if (preOnRight)
+      {
+        ier = psolve(P_data, xcor, vtemp, RIGHT);
+        (*nps)++;
+        if (ier != 0)
+          return((ier < 0) ? SPGMR_PSOLVE_FAIL_UNREC : SPGMR_PSOLVE_FAIL_REC);
+      }
+      else
+      {
+        N_VScale(ONE, xcor, vtemp);
+      }
+
+      /* Add vtemp to initial x to get final solution x, and return */
+      N_VLinearSum(ONE, x, ONE, vtemp, x);
+
+      return(SPGMR_SUCCESS);
+    }
+
+    /* Not yet converged; if allowed, prepare for restart. */
+
+    if (ntries == max_restarts)
+      break;
+
+    /* Construct last column of Q in yg. */
+    s_product = ONE;
+    for (i = krydim; i > 0; i--)
+    {
+      yg[i] = s_product * givens[2 * i - 2];
+      s_product *= givens[2 * i - 1];
+    }
+    yg[0] = s_product;
+
+    /* Scale r_norm and yg. */
+    r_norm *= s_product;
+    for (i = 0; i <= krydim; i++)
+      yg[i] *= r_norm;
+    r_norm = ABS(r_norm);
+
+    /* Multiply yg by V_(krydim+1) to get last residual vector; restart. */
+    N_VScale(yg[0], V[0], V[0]);
+    for (k = 1; k <= krydim; k++)
+      N_VLinearSum(yg[k], V[k], ONE, V[0], V[0]);
+  }
+
+  /* Failed to converge, even after allowed restarts.
+   * If the residual norm was reduced below its initial value, compute
+   * and return x anyway.  Otherwise return failure flag.              */
+
+  if (rho < beta)
+  {
+    /* Apply right scaling and right precond.: vtemp = P2_inv s2_inv xcor. */
+
+    if (scale2)
+      N_VDiv(xcor, s2, xcor);
+    if (preOnRight)
+    {
+      ier = psolve(P_data, xcor, vtemp, RIGHT);
+      (*nps)++;
+      if (ier != 0)
+        return((ier < 0) ? SPGMR_PSOLVE_FAIL_UNREC : SPGMR_PSOLVE_FAIL_REC);
+    }
+    else
+    {
+      N_VScale(ONE, xcor, vtemp);
+    }
+
+    /* Add vtemp to initial x to get final solution x, and return. */
+    N_VLinearSum(ONE, x, ONE, vtemp, x);
+
+    return(SPGMR_RES_REDUCED);
+  }
+
+  return(SPGMR_CONV_FAIL);
+}
+
+/*************** PSpgmrFree ******************************************/
+
+void PSpgmrFree(PSpgmrMem mem)
+{
+  int i;
+
+  if (mem == NULL)
+    return;
+
+  if (mem->R != NULL)
+  {
+    for (i = 0; i <= mem->spgmr_mem->l_max; i++)
+      free(mem->R[i]);
+    free(mem->R);
+  }
+  free(mem->dots);
+  free(mem->dot_x);
+  free(mem->dot_y);
+
+  SpgmrFree(mem->spgmr_mem);
+
+  free(mem);
+}
+
+
+/*************** Private Helper Function: PSpgmrATimes ***************
+ * Computes z = s1 P1_inv A P2_inv s2_inv v, using vtemp as work
+ * space, as the inner loop of SpgmrSolve does.
+ **********************************************************************/
+
+static int PSpgmrATimes(void *A_data, void *P_data, N_Vector s1,
+                        N_Vector s2, ATimesFn atimes, PSolveFn psolve,
+                        boole preOnLeft, boole preOnRight, N_Vector v,
+                        N_Vector z, N_Vector vtemp, int *nps)
+{
+  int ier;
+
+  /* Apply right scaling: vtemp = s2_inv v. */
+  if (s2 != NULL)
+    N_VDiv(v, s2, vtemp);
+  else
+    N_VScale(ONE, v, vtemp);
+
+  /* Apply right preconditioner: vtemp = P2_inv s2_inv v. */
+  if (preOnRight)
+  {
+    N_VScale(ONE, vtemp, z);
+    ier = psolve(P_data, z, vtemp, RIGHT);
+    (*nps)++;
+    if (ier != 0)
+      return((ier < 0) ? SPGMR_PSOLVE_FAIL_UNREC : SPGMR_PSOLVE_FAIL_REC);
+  }
+
+  /* Apply A: z = A P2_inv s2_inv v. */
+  if (atimes(A_data, vtemp, z) != 0)
+    return(SPGMR_ATIMES_FAIL);
+
+  /* Apply left preconditioning: vtemp = P1_inv A P2_inv s2_inv v. */
+  if (preOnLeft)
+  {
+    ier = psolve(P_data, z, vtemp, LEFT);
+    (*nps)++;
+    if (ier != 0)
+      return((ier < 0) ? SPGMR_PSOLVE_FAIL_UNREC : SPGMR_PSOLVE_FAIL_REC);
+  }
+  else
+  {
+    N_VScale(ONE, z, vtemp);
+  }
+
+  /* Apply left scaling: z = s1 P1_inv A P2_inv s2_inv v. */
+  if (s1 != NULL)
+    N_VProd(s1, vtemp, z);
+  else
+    N_VScale(ONE, vtemp, z);
+
+  return(0);
+}
@@ -0,0 +1,116 @@
+/****************************************************************************
+ * File          : pspgmr.h                                                  *
+ *---------------------------------------------------------------------------*
+ * This is the header file for the pipelined variant of the SPGMR Krylov     *
+ * iterative linear solver.  It solves the same scaled, preconditioned       *
+ * system as SPGMR (see spgmr.h) with the p1-GMRES algorithm of Ghysels,     *
+ * Ashby, Meerbergen and Vanroose, "Hiding global communication latency in   *
+ * the GMRES algorithm on massively parallel machines", SIAM J. Sci. Comput. *
+ * 35 (2013).                                                                *
+ *                                                                           *
+ * Every Arnoldi step needs a single global reduction, which combines the    *
+ * projections of the newest Krylov vector onto the basis with the norm of   *
+ * the previous basis vector.  The reduction is started with                 *
+ * N_VDotProdPairsInit and completed only after the next application of      *
+ * the preconditioner and atimes, so its latency is hidden behind that work. *
+ * The basis is orthogonalized by classical Gram-Schmidt on vectors that are *
+ * normalized one step late, the corrections are applied through the         *
+ * recurrence of the Hessenberg matrix.  In exact arithmetic the iterates    *
+ * and iteration counts are those of SPGMR; one extra atimes/psolve pair is  *
+ * done in the step where the iteration converges.                           *
+ *                                                                           *
+ * The usage mirrors SPGMR:                                                  *
+ *    mem  = PSpgmrMalloc(N, lmax, machEnv);                                 *
+ *    flag = PSpgmrSolve(mem,A_data,x,b,...,P_data,s1,s2,atimes,psolve,...); *
+ *    PSpgmrFree(mem);                                                       *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef _pspgmr_h
+#define _pspgmr_h
+
+BEGIN_EXTERN_C
+
+#include "llnltyps.h"
+#include "iterativ.h"
+#include "spgmr.h"
+#include "vector.h"
+
+
+/******************************************************************
+*                                                                *
+* Types: PSpgmrMemRec, PSpgmrMem                                 *
+*----------------------------------------------------------------*
+* PSpgmrMem is a pointer to a PSpgmrMemRec.                      *
+*                                                                *
+* spgmr_mem holds the basis V, the Hessenberg matrix Hes, the    *
+* Givens rotations and the work vectors as described in          *
+* spgmr.h.  Hes is never rotated here, the recurrence that       *
+* corrects the late normalized vectors needs its columns.        *
+*                                                                *
+* R is the (l_max+1) x l_max copy of Hes that is reduced to      *
+* upper triangular form by QRfact.                               *
+*                                                                *
+* dots, dot_x and dot_y are length (l_max+2) arrays holding the  *
+* values and vector pairs of the reduction in progress.          *
+*                                                                *
+******************************************************************/
+
+typedef struct {
+  SpgmrMem spgmr_mem;
+
+  real **R;
+  real *dots;
+  N_Vector *dot_x;
+  N_Vector *dot_y;
+} PSpgmrMemRec, *PSpgmrMem;
+
+
+/******************************************************************
+*                                                                *
+* Function : PSpgmrMalloc                                        *
+*----------------------------------------------------------------*
+* PSpgmrMalloc allocates the memory used by PSpgmrSolve, the     *
+* parameters are those of SpgmrMalloc.  It returns NULL if there *
+* is a memory request failure.                                   *
+*                                                                *
+******************************************************************/
+
+PSpgmrMem PSpgmrMalloc(integer N, int l_max, void *machEnv);
+
+
+/******************************************************************
+*                                                                *
+* Function : PSpgmrSolve                                         *
+*----------------------------------------------------------------*
+* PSpgmrSolve solves the linear system Ax = b with the pipelined *
+* SPGMR method.  The parameters and return values are those of   *
+* SpgmrSolve except that there is no gstype.                     *
+*                                                                *
+* res_hist, if not NULL, receives the residual norm estimate     *
+* after each linear iteration and must have room for             *
+* (max_restarts + 1) * l_max values.                             *
+*                                                                *
+******************************************************************/
+
+int PSpgmrSolve(PSpgmrMem mem, void *A_data, N_Vector x, N_Vector b,
+                int pretype, real delta, int max_restarts,
+                void *P_data, N_Vector s1, N_Vector s2, ATimesFn atimes,
+                PSolveFn psolve, real *res_norm, int *nli, int *nps,
+                real *res_hist);
+
+
+/******************************************************************
+*                                                                *
+* Function : PSpgmrFree                                          *
+*----------------------------------------------------------------*
+* PSpgmrFree frees the memory allocated by PSpgmrMalloc. It is   *
+* illegal to use the pointer mem after a call to PSpgmrFree.     *
+*                                                                *
+******************************************************************/
+
+void PSpgmrFree(PSpgmrMem mem);
+
+END_EXTERN_C
+
+#endif
@@ -168,7 +168,8 @@ SpgmrMem SpgmrMalloc(integer N, int l_max, void *machEnv)
 int SpgmrSolve(SpgmrMem mem, void *A_data, N_Vector x, N_Vector b,
                int pretype, int gstype, real delta, int max_restarts,
                void *P_data, N_Vector s1, N_Vector s2, ATimesFn atimes,
-               PSolveFn psolve, real *res_norm, int *nli, int *nps)
+               PSolveFn psolve, real *res_norm, int *nli, int *nps,
+               real *res_hist)
 {
   N_Vector *V, xcor, vtemp;
   real **Hes, *givens, *yg;
@@ -327,6 +328,12 @@ int SpgmrSolve(SpgmrMem mem, void *A_data, N_Vector x, N_Vector b,
                         vtemp, yg) != 0)
           return(SPGMR_GS_FAIL);
       }
+      else if (gstype == CLASSICAL_GS2)
+      {
+        if (ClassicalGS2(V, Hes, l_plus_1, l_max, &(Hes[l_plus_1][l]),
+                         yg) != 0)
+          return(SPGMR_GS_FAIL);
+      }
       else
       {
         if (ModifiedGS(V, Hes, l_plus_1, l_max, &(Hes[l_plus_1][l])) != 0)
@@ -343,6 +350,9 @@ int SpgmrSolve(SpgmrMem mem, void *A_data, N_Vector x, N_Vector b,
       rotation_product *= givens[2 * l + 1];
       *res_norm = rho = ABS(rotation_product * r_norm);
 
+      if (res_hist != NULL)
+        res_hist[*nli - 1] = rho;
+
       if (rho <= delta)
       {
         converged = TRUE; break;
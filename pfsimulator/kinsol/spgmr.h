@@ -178,7 +178,7 @@ SpgmrMem SpgmrMalloc(integer N, int l_max, void *machEnv);
 *                                                                *
 * gstype is the type of Gram-Schmidt orthogonalization to be     *
 * used. Its legal values are enumerated in iterativ.h. These     *
-* values are MODIFIED_GS=0 and CLASSICAL_GS=1.                   *
+* values are MODIFIED_GS=0, CLASSICAL_GS=1 and CLASSICAL_GS2=2.  *
 *                                                                *
 * delta is the tolerance on the L2 norm of the scaled,           *
 * preconditioned residual. On return with value SPGMR_SUCCESS,   *
@@ -224,6 +224,10 @@ SpgmrMem SpgmrMalloc(integer N, int l_max, void *machEnv);
 * the execution of SpgmrSolve. The caller is responsible for     *
 * allocating the memory (*nps) to be filled in by SpgmrSolve.    *
 *                                                                *
+* res_hist, if not NULL, receives the residual norm estimate     *
+* after each linear iteration and must have room for             *
+* (max_restarts + 1) * l_max values.                             *
+*                                                                *
 * Note.. Repeated calls can be made to SpgmrSolve with varying   *
 * input arguments. If, however, the problem size N or the        *
 * maximum Krylov dimension l_max changes, then a call to         *
@@ -236,7 +240,8 @@ SpgmrMem SpgmrMalloc(integer N, int l_max, void *machEnv);
 int SpgmrSolve(SpgmrMem mem, void *A_data, N_Vector x, N_Vector b,
                int pretype, int gstype, real delta, int max_restarts,
                void *P_data, N_Vector s1, N_Vector s2, ATimesFn atimes,
-               PSolveFn psolve, real *res_norm, int *nli, int *nps);
+               PSolveFn psolve, real *res_norm, int *nli, int *nps,
+               real *res_hist);
 
 
 /* Return values for SpgmrSolve */
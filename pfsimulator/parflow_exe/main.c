@@ -361,6 +361,20 @@ int main(int argc, char *argv [])
 
     amps_ThreadLocal(input_database) = IDB_NewDB(GlobalsInFileName);
 
+    /*-----------------------------------------------------------------------
+     * Split off the I/O servers, they only write output for the compute
+     * ranks and are done once the compute ranks are
+     *-----------------------------------------------------------------------*/
+
+    if (NewIOServers())
+    {
+      IDB_FreeDB(amps_ThreadLocal(input_database));
+      FreeGlobals();
+      amps_Finalize();
+
+      return 0;
+    }
+
     /*-----------------------------------------------------------------------
      * Setup log printing
      *-----------------------------------------------------------------------*/
@@ -378,6 +392,12 @@ int main(int argc, char *argv [])
      *-----------------------------------------------------------------------*/
     Solve();
 
+    /*-----------------------------------------------------------------------
+     * Wait for output shipped to the I/O servers and shut them down
+     *-----------------------------------------------------------------------*/
+
+    FreeIOServers();
+
     if (!amps_Rank(amps_CommWorld))
     {
       amps_Printf("Problem solved \n");
@@ -0,0 +1,282 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+/*****************************************************************************
+* NewBackgroundReader, FreeBackgroundReader, BackgroundReaderActive,
+* BackgroundReaderSubmit, BackgroundReaderWait
+*
+* Per rank thread reading input files ahead of their use, see
+* Solver.CLM.MetFileReadAhead.
+*
+* A read is split in two parts.  The part needing communication, like
+* agreeing on the layout of a PFB file, is done by the caller on the main
+* thread when the read is submitted.  The thread then only reads the
+* rank's bytes with plain file I/O, so MPI does not need to support
+* threads.  The reads are done in the order they are submitted and
+* BackgroundReaderWait blocks until a given read is done.
+*
+* The thread is started by the first NewBackgroundReader call and
+* stopped by the matching last FreeBackgroundReader call.
+*
+*****************************************************************************/
+
+#include "parflow.h"
+
+#ifdef PARFLOW_HAVE_PTHREADS
+
+#include <pthread.h>
+
+typedef struct _BackgroundRead {
+  void (*read)(void *data);
+  void                   *data;
+  struct _BackgroundRead *next;
+} BackgroundRead;
+
+static struct {
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t queued_cond;   /* signaled when a read is queued */
+  pthread_cond_t done_cond;     /* signaled when a read is done */
+
+  BackgroundRead *head;         /* next read done by the thread */
+  BackgroundRead *tail;
+
+  long num_submitted;
+  long num_done;
+  int shutdown;
+} background_reader;
+
+#endif
+
+static int background_reader_users = 0;
+
+
+#ifdef PARFLOW_HAVE_PTHREADS
+
+/*--------------------------------------------------------------------------
+ * BackgroundReaderThread
+ *--------------------------------------------------------------------------*/
+
+static void *BackgroundReaderThread(void *arg)
+{
+  BackgroundRead *read;
+
+  PF_UNUSED(arg);
+
+  pthread_mutex_lock(&background_reader.mutex);
+
+  for (;;)
+  {
+    while (background_reader.head == NULL && !background_reader.shutdown)
+    {
+      pthread_cond_wait(&background_reader.queued_cond,
+                        &background_reader.mutex);
+    }
+
+    if (background_reader.head == NULL)
+    {
+      break;
+    }
+
+    read = background_reader.head;
+
+    pthread_mutex_unlock(&background_reader.mutex);
+
+    (read->read)(read->data);
+
+    pthread_mutex_lock(&background_reader.mutex);
+
+    background_reader.head = read->next;
+    if (background_reader.head == NULL)
+    {
+      background_reader.tail = NULL;
+    }
+    background_reader.num_done++;
+    tfree(read);
+
+    pthread_cond_broadcast(&background_reader.done_cond);
+  }
+
+  pthread_mutex_unlock(&background_reader.mutex);
+
+  return NULL;
+}
+
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * NewBackgroundReader
+ *
+ * Start the reader thread if it is not running yet.  Without threads
+ * reads are done when they are submitted.
+ *--------------------------------------------------------------------------*/
+
+void   NewBackgroundReader()
+{
+  if (background_reader_users++)
+  {
+    return;
+  }
+
+#ifdef PARFLOW_HAVE_PTHREADS
+  background_reader.head = NULL;
+  background_reader.tail = NULL;
+  background_reader.num_submitted = 0;
+  background_reader.num_done = 0;
+  background_reader.shutdown = FALSE;
+
+  pthread_mutex_init(&background_reader.mutex, NULL);
+  pthread_cond_init(&background_reader.queued_cond, NULL);
+  pthread_cond_init(&background_reader.done_cond, NULL);
+
+  if (pthread_create(&background_reader.thread, NULL,
+                     BackgroundReaderThread, NULL))
+  {
+    amps_Printf("Error: can't create the background reader thread\n");
+    exit(1);
+  }
+#endif
+}
+
+
+/*--------------------------------------------------------------------------
+ * FreeBackgroundReader
+ *
+ * Finish the queued reads and stop the thread when the last user is gone.
+ *--------------------------------------------------------------------------*/
+
+void   FreeBackgroundReader()
+{
+  if (background_reader_users == 0 || --background_reader_users)
+  {
+    return;
+  }
+
+#ifdef PARFLOW_HAVE_PTHREADS
+  pthread_mutex_lock(&background_reader.mutex);
+  background_reader.shutdown = TRUE;
+  pthread_cond_signal(&background_reader.queued_cond);
+  pthread_mutex_unlock(&background_reader.mutex);
+
+  pthread_join(background_reader.thread, NULL);
+
+  pthread_cond_destroy(&background_reader.done_cond);
+  pthread_cond_destroy(&background_reader.queued_cond);
+  pthread_mutex_destroy(&background_reader.mutex);
+#endif
+}
+
+
+/*--------------------------------------------------------------------------
+ * BackgroundReaderActive
+ *
+ * Return TRUE if submitted reads are done by the thread.
+ *--------------------------------------------------------------------------*/
+
+int    BackgroundReaderActive()
+{
+#ifdef PARFLOW_HAVE_PTHREADS
+  return background_reader_users > 0;
+#else
+  return FALSE;
+#endif
+}
+
+
+/*--------------------------------------------------------------------------
+ * BackgroundReaderSubmit
+ *
+ * Queue read(data) and return a ticket for BackgroundReaderWait.  The read
+ * must not communicate.  Without a running thread the read is done now.
+ *--------------------------------------------------------------------------*/
+
+long   BackgroundReaderSubmit(
+                              void (*read)(void *data),
+                              void  *data)
+{
+#ifdef PARFLOW_HAVE_PTHREADS
+  BackgroundRead *queued;
+  long ticket;
+
+  if (!BackgroundReaderActive())
+  {
+    read(data);
+    return -1;
+  }
+
+  queued = talloc(BackgroundRead, 1);
+  queued->read = read;
+  queued->data = data;
+  queued->next = NULL;
+
+  pthread_mutex_lock(&background_reader.mutex);
+  if (background_reader.tail)
+  {
+    background_reader.tail->next = queued;
+  }
+  else
+  {
+    background_reader.head = queued;
+  }
+  background_reader.tail = queued;
+  ticket = background_reader.num_submitted++;
+  pthread_cond_signal(&background_reader.queued_cond);
+  pthread_mutex_unlock(&background_reader.mutex);
+
+  return ticket;
+#else
+  read(data);
+  return -1;
+#endif
+}
+
+
+/*--------------------------------------------------------------------------
+ * BackgroundReaderWait
+ *
+ * Wait until the read of ticket is done.
+ *--------------------------------------------------------------------------*/
+
+void   BackgroundReaderWait(long ticket)
+{
+#ifdef PARFLOW_HAVE_PTHREADS
+  if (ticket < 0)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&background_reader.mutex);
+  while (background_reader.num_done <= ticket)
+  {
+    pthread_cond_wait(&background_reader.done_cond, &background_reader.mutex);
+  }
+  pthread_mutex_unlock(&background_reader.mutex);
+#else
+  PF_UNUSED(ticket);
+#endif
+}
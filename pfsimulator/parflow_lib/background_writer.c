@@ -0,0 +1,430 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+/*****************************************************************************
+* NewBackgroundWriter, FreeBackgroundWriter, FlushBackgroundWriter,
+* BackgroundWriterBuffer, BackgroundWriterSubmit
+*
+* Per rank thread writing PFB and PFSB files, see PFB.Writer Background.
+*
+* WritePFBinary and WritePFSBinary pack the rank's part of a file into a
+* staging buffer taken from BackgroundWriterBuffer and hand it to
+* BackgroundWriterSubmit.  The file offsets are agreed on collectively
+* by the calling thread, the thread then only writes the rank's bytes at
+* its offset, so no communication is done off the main thread.  The
+* layout is the one amps_FFopen produces.
+*
+* The staging buffers form a ring of PFB.Writer.QueueDepth slots that
+* are reused from file to file.  When all slots are waiting to be
+* written BackgroundWriterBuffer blocks until the thread has finished
+* the oldest one, so a slow file system slows the simulation down
+* instead of using unbounded memory.
+*
+*****************************************************************************/
+
+#include "parflow.h"
+
+#include <string.h>
+#include <sys/param.h>
+
+#ifdef PARFLOW_HAVE_PTHREADS
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+typedef struct {
+  char filename[MAXPATHLEN];
+
+  char      *buffer;
+  long capacity;
+  long size;
+
+  long start;                   /* offset of this rank's bytes */
+  long total;                   /* size of the whole file */
+
+  int num_starts;               /* starts of all ranks for the .dist file, */
+  long      *starts;            /* only on rank 0 */
+} BackgroundWrite;
+
+static struct {
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t queued_cond;   /* signaled when a write is queued */
+  pthread_cond_t done_cond;     /* signaled when a write is done */
+
+  BackgroundWrite *slots;
+  int num_slots;
+  int head;                     /* next slot written by the thread */
+  int num_queued;
+  int shutdown;
+} background_writer;
+
+static int background_writer_active = FALSE;
+
+
+/*--------------------------------------------------------------------------
+ * BackgroundWriterWrite
+ *
+ * Write the slot's bytes and on rank 0 the .dist file, run by the thread.
+ *--------------------------------------------------------------------------*/
+
+static void BackgroundWriterWrite(BackgroundWrite *slot)
+{
+  char dist_filename[MAXPATHLEN];
+  FILE *dfile;
+
+  long offset = 0;
+  ssize_t count;
+  int fd;
+  int i;
+
+  /* Every rank creates the file if needed; rank 0 cuts off anything
+   * left from an older, longer file */
+  if ((fd = open(slot->filename, O_WRONLY | O_CREAT, 0666)) < 0)
+  {
+    amps_Printf("Error: can't open output file %s\n", slot->filename);
+    exit(1);
+  }
+
+  if (slot->starts && ftruncate(fd, (off_t)slot->total))
+  {
+    amps_Printf("Error: can't truncate output file %s\n", slot->filename);
+    exit(1);
+  }
+
+  while (offset < slot->size)
+  {
+    count = pwrite(fd, slot->buffer + offset, (size_t)(slot->size - offset),
+                   (off_t)(slot->start + offset));
+    if (count < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (count <= 0)
+    {
+      amps_Printf("Error: can't write output file %s\n", slot->filename);
+      exit(1);
+    }
+    offset += count;
+  }
+
+  close(fd);
+
+  if (slot->starts && slot->num_starts)
+  {
+    if (snprintf(dist_filename, MAXPATHLEN, "%s.dist", slot->filename)
+        >= MAXPATHLEN)
+    {
+      amps_Printf("Error: distribution file name too long for %s\n",
+                  slot->filename);
+      exit(1);
+    }
+
+    if ((dfile = fopen(dist_filename, "w")) == NULL)
+    {
+      amps_Printf("Error: can't open the distribution file %s\n", dist_filename);
+      exit(1);
+    }
+
+    for (i = 0; i < slot->num_starts; i++)
+    {
+      fprintf(dfile, "%ld\n", slot->starts[i]);
+    }
+
+    fclose(dfile);
+  }
+}
+
+
+/*--------------------------------------------------------------------------
+ * BackgroundWriterThread
+ *--------------------------------------------------------------------------*/
+
+static void *BackgroundWriterThread(void *arg)
+{
+  BackgroundWrite *slot;
+
+  PF_UNUSED(arg);
+
+  pthread_mutex_lock(&background_writer.mutex);
+
+  for (;;)
+  {
+    while (background_writer.num_queued == 0 && !background_writer.shutdown)
+    {
+      pthread_cond_wait(&background_writer.queued_cond,
+                        &background_writer.mutex);
+    }
+
+    if (background_writer.num_queued == 0)
+    {
+      break;
+    }
+
+    slot = &background_writer.slots[background_writer.head];
+
+    pthread_mutex_unlock(&background_writer.mutex);
+
+    BackgroundWriterWrite(slot);
+
+    pthread_mutex_lock(&background_writer.mutex);
+
+    background_writer.head =
+      (background_writer.head + 1) % background_writer.num_slots;
+    background_writer.num_queued--;
+
+    pthread_cond_broadcast(&background_writer.done_cond);
+  }
+
+  pthread_mutex_unlock(&background_writer.mutex);
+
+  return NULL;
+}
+
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * NewBackgroundWriter
+ *
+ * Start the writer thread with queue_depth staging buffers.
+ *--------------------------------------------------------------------------*/
+
+void   NewBackgroundWriter(int queue_depth)
+{
+#ifdef PARFLOW_HAVE_PTHREADS
+  background_writer.slots = ctalloc(BackgroundWrite, queue_depth);
+  background_writer.num_slots = queue_depth;
+  background_writer.head = 0;
+  background_writer.num_queued = 0;
+  background_writer.shutdown = FALSE;
+
+  pthread_mutex_init(&background_writer.mutex, NULL);
+  pthread_cond_init(&background_writer.queued_cond, NULL);
+  pthread_cond_init(&background_writer.done_cond, NULL);
+
+  if (pthread_create(&background_writer.thread, NULL,
+                     BackgroundWriterThread, NULL))
+  {
+    amps_Printf("Error: can't create the background writer thread\n");
+    exit(1);
+  }
+
+  background_writer_active = TRUE;
+#else
+  PF_UNUSED(queue_depth);
+#endif
+}
+
+
+/*--------------------------------------------------------------------------
+ * FlushBackgroundWriter
+ *
+ * Wait until all submitted files are written.
+ *--------------------------------------------------------------------------*/
+
+void   FlushBackgroundWriter()
+{
+#ifdef PARFLOW_HAVE_PTHREADS
+  if (!background_writer_active)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&background_writer.mutex);
+  while (background_writer.num_queued > 0)
+  {
+    pthread_cond_wait(&background_writer.done_cond, &background_writer.mutex);
+  }
+  pthread_mutex_unlock(&background_writer.mutex);
+#endif
+}
+
+
+/*--------------------------------------------------------------------------
+ * FreeBackgroundWriter
+ *
+ * Write the remaining files and stop the thread.
+ *--------------------------------------------------------------------------*/
+
+void   FreeBackgroundWriter()
+{
+#ifdef PARFLOW_HAVE_PTHREADS
+  int i;
+
+  if (!background_writer_active)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&background_writer.mutex);
+  background_writer.shutdown = TRUE;
+  pthread_cond_signal(&background_writer.queued_cond);
+  pthread_mutex_unlock(&background_writer.mutex);
+
+  pthread_join(background_writer.thread, NULL);
+
+  pthread_cond_destroy(&background_writer.done_cond);
+  pthread_cond_destroy(&background_writer.queued_cond);
+  pthread_mutex_destroy(&background_writer.mutex);
+
+  for (i = 0; i < background_writer.num_slots; i++)
+  {
+    tfree(background_writer.slots[i].buffer);
+    tfree(background_writer.slots[i].starts);
+  }
+  tfree(background_writer.slots);
+
+  background_writer_active = FALSE;
+#endif
+}
+
+
+/*--------------------------------------------------------------------------
+ * BackgroundWriterBuffer
+ *
+ * Return a staging buffer of at least size bytes, waiting for the thread
+ * if all buffers are queued.  The buffer must be passed to
+ * BackgroundWriterSubmit before the next call.
+ *--------------------------------------------------------------------------*/
+
+char  *BackgroundWriterBuffer(long size)
+{
+#ifdef PARFLOW_HAVE_PTHREADS
+  BackgroundWrite *slot;
+
+  pthread_mutex_lock(&background_writer.mutex);
+  while (background_writer.num_queued == background_writer.num_slots)
+  {
+    pthread_cond_wait(&background_writer.done_cond, &background_writer.mutex);
+  }
+  slot = &background_writer.slots[(background_writer.head
+                                    + background_writer.num_queued)
+                                   % background_writer.num_slots];
+  pthread_mutex_unlock(&background_writer.mutex);
+
+  if (slot->capacity < size)
+  {
+    tfree(slot->buffer);
+    slot->buffer = talloc(char, size);
+    slot->capacity = size;
+  }
+
+  return slot->buffer;
+#else
+  PF_UNUSED(size);
+  amps_Printf("Error: the background writer requires threads\n");
+  exit(1);
+  return NULL;
+#endif
+}
+
+
+/*--------------------------------------------------------------------------
+ * BackgroundWriterSubmit
+ *
+ * Queue the size bytes in buffer, which must come from the last
+ * BackgroundWriterBuffer call, as this rank's part of filename.  Must be
+ * called by all ranks.  If write_dist is set rank 0 also writes the .dist
+ * file.
+ *--------------------------------------------------------------------------*/
+
+void   BackgroundWriterSubmit(
+                              char *filename,
+                              char *buffer,
+                              long  size,
+                              int   write_dist)
+{
+#ifdef PARFLOW_HAVE_PTHREADS
+  BackgroundWrite *slot;
+
+  int p = amps_Rank(amps_CommWorld);
+  int P = amps_Size(amps_CommWorld);
+
+  pthread_mutex_lock(&background_writer.mutex);
+  slot = &background_writer.slots[(background_writer.head
+                                    + background_writer.num_queued)
+                                   % background_writer.num_slots];
+  pthread_mutex_unlock(&background_writer.mutex);
+
+  PF_UNUSED(buffer);
+
+  /* Room for the .dist suffix is checked here, before anything is queued */
+  if (strlen(filename) + strlen(".dist") >= MAXPATHLEN)
+  {
+    amps_Printf("Error: output file name too long: %s\n", filename);
+    exit(1);
+  }
+  strcpy(slot->filename, filename);
+  slot->size = size;
+
+  /* Agree on the layout now, the thread does no communication */
+  slot->start = 0;
+  slot->total = size;
+#ifdef PARFLOW_HAVE_MPI
+  MPI_Exscan(&size, &(slot->start), 1, MPI_LONG, MPI_SUM, amps_CommWorld);
+  if (p == 0)
+  {
+    slot->start = 0;
+  }
+  MPI_Allreduce(&size, &(slot->total), 1, MPI_LONG, MPI_SUM, amps_CommWorld);
+#endif
+
+  if (p == 0)
+  {
+    if (!slot->starts)
+    {
+      slot->starts = talloc(long, P);
+    }
+    slot->num_starts = write_dist ? P : 0;
+  }
+
+#ifdef PARFLOW_HAVE_MPI
+  if (write_dist)
+  {
+    MPI_Gather(&(slot->start), 1, MPI_LONG, slot->starts, 1, MPI_LONG, 0,
+               amps_CommWorld);
+  }
+#else
+  slot->starts[0] = 0;
+#endif
+
+  pthread_mutex_lock(&background_writer.mutex);
+  background_writer.num_queued++;
+  pthread_cond_signal(&background_writer.queued_cond);
+  pthread_mutex_unlock(&background_writer.mutex);
+#else
+  PF_UNUSED(filename);
+  PF_UNUSED(buffer);
+  PF_UNUSED(size);
+  PF_UNUSED(write_dist);
+  amps_Printf("Error: the background writer requires threads\n");
+  exit(1);
+#endif
+}
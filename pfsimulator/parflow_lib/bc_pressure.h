@@ -100,9 +100,11 @@
   })                             \
   BC_TYPE(PressureFile, {        \
     char **filenames;            \
+    char *stack_filename;        \
   })                             \
   BC_TYPE(FluxFile, {            \
     char **filenames;            \
+    char *stack_filename;        \
   })                             \
   BC_TYPE(ExactSolution, {       \
     int function_type;           \
@@ -197,9 +199,11 @@
   })                             \
   BC_TYPE(PressureFile, {        \
     char *filename;              \
+    int slice;                   \
   })                             \
   BC_TYPE(FluxFile, {            \
     char *filename;              \
+    int slice;                   \
   })                             \
   BC_TYPE(ExactSolution, {       \
     int function_type;           \
@@ -329,10 +333,17 @@ typedef struct {
 #define PressureFileName(patch) \
   ((patch)->filename)
 
+/* Slice of a time-stacked file, -1 if the file holds one field */
+#define PressureFileSlice(patch) \
+  ((patch)->slice)
+
 /*--------------------------------------------------------------------------*/
 #define FluxFileName(patch) \
   ((patch)->filename)
 
+#define FluxFileSlice(patch) \
+  ((patch)->slice)
+
 /*--------------------------------------------------------------------------*/
 #define ExactSolutionFunctionType(patch) \
   ((patch)->function_type)
@@ -290,11 +290,26 @@ void         BCPressurePackage(
 
             GetTypeStruct(PressureFile, data, public_xtra, i);
 
-            PressureFileName(interval_data)
-              = ctalloc(char, strlen((data->filenames)[interval_number]) + 1);
+            /* Every interval reads its slice of a time-stacked file */
+            if (data->stack_filename)
+            {
+              PressureFileName(interval_data)
+                = ctalloc(char, strlen(data->stack_filename) + 1);
 
-            strcpy(PressureFileName(interval_data),
-                   ((data->filenames)[interval_number]));
+              strcpy(PressureFileName(interval_data), data->stack_filename);
+
+              PressureFileSlice(interval_data) = interval_number;
+            }
+            else
+            {
+              PressureFileName(interval_data)
+                = ctalloc(char, strlen((data->filenames)[interval_number]) + 1);
+
+              strcpy(PressureFileName(interval_data),
+                     ((data->filenames)[interval_number]));
+
+              PressureFileSlice(interval_data) = -1;
+            }
 
             BCPressureDataIntervalValue(bc_pressure_data, i, interval_number)
               = (void*)interval_data;
@@ -309,11 +324,26 @@ void         BCPressurePackage(
 
             GetTypeStruct(FluxFile, data, public_xtra, i);
 
-            FluxFileName(interval_data)
-              = ctalloc(char, strlen((data->filenames)[interval_number]) + 1);
+            /* Every interval reads its slice of a time-stacked file */
+            if (data->stack_filename)
+            {
+              FluxFileName(interval_data)
+                = ctalloc(char, strlen(data->stack_filename) + 1);
 
-            strcpy(FluxFileName(interval_data),
-                   ((data->filenames)[interval_number]));
+              strcpy(FluxFileName(interval_data), data->stack_filename);
+
+              FluxFileSlice(interval_data) = interval_number;
+            }
+            else
+            {
+              FluxFileName(interval_data)
+                = ctalloc(char, strlen((data->filenames)[interval_number]) + 1);
+
+              strcpy(FluxFileName(interval_data),
+                     ((data->filenames)[interval_number]));
+
+              FluxFileSlice(interval_data) = -1;
+            }
 
             BCPressureDataIntervalValue(bc_pressure_data, i, interval_number)
               = (void*)interval_data;
@@ -827,8 +857,21 @@ PFModule  *BCPressurePackageNewPublicXtra(
 
           (data->filenames) = ctalloc(char *, interval_division);
 
+          /* A time-stacked file replaces the per interval files */
+          sprintf(key, "Patch.%s.BCPressure.StackFileName", patch_name);
+          data->stack_filename = GetStringDefault(key, "");
+          if (data->stack_filename[0] == '\0')
+          {
+            data->stack_filename = NULL;
+          }
+
           ForEachInterval(interval_division, interval_number)
           {
+            if (data->stack_filename)
+            {
+              continue;
+            }
+
             sprintf(key, "Patch.%s.BCPressure.%s.FileName",
                     patch_name,
                     NA_IndexToName(GlobalsIntervalNames[global_cycle],
@@ -846,8 +889,21 @@ PFModule  *BCPressurePackageNewPublicXtra(
 
           (data->filenames) = ctalloc(char *, interval_division);
 
+          /* A time-stacked file replaces the per interval files */
+          sprintf(key, "Patch.%s.BCPressure.StackFileName", patch_name);
+          data->stack_filename = GetStringDefault(key, "");
+          if (data->stack_filename[0] == '\0')
+          {
+            data->stack_filename = NULL;
+          }
+
           ForEachInterval(interval_division, interval_number)
           {
+            if (data->stack_filename)
+            {
+              continue;
+            }
+
             sprintf(key, "Patch.%s.BCPressure.%s.FileName",
                     patch_name,
                     NA_IndexToName(GlobalsIntervalNames[global_cycle],
@@ -1078,27 +1134,18 @@ void  BCPressurePackageFreePublicXtra()
 
           FreePatch(PressureFile,
           {
-            int interval_number;
             GetTypeStruct(PressureFile, data, public_xtra, i);
 
-            ForEachInterval(interval_division, interval_number)
-            {
-              tfree(((data->filenames)[interval_number]));
-            }
-            // @RMM had to remove to not error our
+            /* The file names belong to the input database */
             tfree((data->filenames));
             tfree(data);
           });
 
           FreePatch(FluxFile,
           {
-            int interval_number;
             GetTypeStruct(FluxFile, data, public_xtra, i);
-            ForEachInterval(interval_division, interval_number)
-            {
-              tfree(((data->filenames)[interval_number]));
-            }
 
+            /* The file names belong to the input database */
             tfree((data->filenames));
             tfree(data);
           });
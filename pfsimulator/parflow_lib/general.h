@@ -222,6 +222,19 @@
 /* return 2^e, where e >= 0 is an integer */
 #define Pow2(e)   (((unsigned int)0x01) << (e))
 
+/* Reverse the bytes of 32 and 64 bit unsigned integers.  Written with
+ * shifts and masks so compilers recognize the idiom and vectorize loops
+ * over arrays (e.g. to pshufb) when the target ISA allows it. */
+#define PFByteSwap32(x)                                        \
+  ((((x) & 0xff000000U) >> 24) | (((x) & 0x00ff0000U) >> 8) | \
+   (((x) & 0x0000ff00U) << 8) | (((x) & 0x000000ffU) << 24))
+
+#define PFByteSwap64(x)                                                                  \
+  ((((x) & 0xff00000000000000ULL) >> 56) | (((x) & 0x00ff000000000000ULL) >> 40) | \
+   (((x) & 0x0000ff0000000000ULL) >> 24) | (((x) & 0x000000ff00000000ULL) >> 8) |  \
+   (((x) & 0x00000000ff000000ULL) << 8) | (((x) & 0x0000000000ff0000ULL) << 24) |  \
+   (((x) & 0x000000000000ff00ULL) << 40) | (((x) & 0x00000000000000ffULL) << 56))
+
 /*--------------------------------------------------------------------------
  * Define various flags
  *--------------------------------------------------------------------------*/
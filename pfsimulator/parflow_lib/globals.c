@@ -79,6 +79,13 @@ void   NewGlobals(char *run_name)
   globals_ptr->repeat_counts = 0;
 
   globals_ptr->use_clustering = 0;
+
+  globals_ptr->pfb_writer = PFB_WRITER_AMPS;
+  globals_ptr->pfb_index = FALSE;
+  globals_ptr->pfb_compression = PFB_ENCODING_NONE;
+  globals_ptr->pfb_compression_level = 1;
+
+  globals_ptr->num_io_servers = 0;
 }
 
 
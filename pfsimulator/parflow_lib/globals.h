@@ -88,6 +88,19 @@ typedef struct _Globals {
 
   int use_clustering;
 
+  /* Strategy used by WritePFBinary/WritePFSBinary, see PFB.Writer */
+  int pfb_writer;
+
+  /* Append a subgrid index to PFB files, see PFB.Index */
+  int pfb_index;
+
+  /* Encoding and zlib level of PFB files, see PFB.Compression */
+  int pfb_compression;
+  int pfb_compression_level;
+
+  /* Number of ranks split off as I/O servers, see Process.IOServers */
+  int num_io_servers;
+
 #ifdef HAVE_SAMRAI
   SAMRAI::tbox::Pointer < Parflow > parflow_simulation;
 #endif
@@ -165,6 +178,53 @@ extern __constant__  Globals *dev_globals_ptr;
 
 #define GlobalsUseClustering      (globals->use_clustering)
 
+#define GlobalsPFBWriter          (globals->pfb_writer)
+
+#define GlobalsPFBIndex           (globals->pfb_index)
+
+#define GlobalsPFBCompression     (globals->pfb_compression)
+#define GlobalsPFBCompressionLevel (globals->pfb_compression_level)
+
+#define GlobalsNumIOServers       (globals->num_io_servers)
+
+/*--------------------------------------------------------------------------
+ * Values for GlobalsPFBWriter
+ *--------------------------------------------------------------------------*/
+#define PFB_WRITER_AMPS  0        /* amps_FFopen, one stream per rank */
+#define PFB_WRITER_MPIIO 1        /* collective MPI-IO write */
+#define PFB_WRITER_BACKGROUND 2   /* written by a per rank thread */
+#define PFB_WRITER_SUBFILE 3      /* one subfile per group of ranks */
+#define PFB_WRITER_IOSERVER 4     /* shipped to the I/O servers */
+
+/*--------------------------------------------------------------------------
+ * PFB subgrid index, see PackPFBinaryIndex
+ *--------------------------------------------------------------------------*/
+#define PFB_INDEX_MAGIC        "PFBI"
+#define PFB_INDEX_VERSION      1
+#define PFB_INDEX_ENTRY_SIZE   (9 * 4 + 8)   /* subgrid header, data offset */
+#define PFB_INDEX_TRAILER_SIZE (8 + 4 + 4)   /* index offset, version, magic */
+
+/*--------------------------------------------------------------------------
+ * Encoded PFB files, see PackPFBinaryEncodedHeader.  The encoding is a
+ * set of flags.
+ *--------------------------------------------------------------------------*/
+#define PFB_ENCODING_NONE      0
+#define PFB_ENCODING_DEFLATE   1     /* byte shuffled, zlib deflated */
+#define PFB_ENCODING_QUANTIZE  2     /* quantized to an error bound */
+#define PFB_ENCODING_FLOAT     4     /* single precision values */
+#define PFB_ENCODING_SUBFILE   8     /* blocks are stored in subfiles */
+
+/* Name of a subfile from the main file name and the subfile number */
+#define PFB_SUBFILE_NAME       "%s.sub%05d"
+
+#define PFB_QUANTIZE_MAX_BITS  32    /* wider blocks are stored unquantized */
+
+/* Size of the values in unquantized blocks */
+#define PFBEncodedValueSize(encoding) \
+  (((encoding) & PFB_ENCODING_FLOAT) ? amps_SizeofFloat : amps_SizeofDouble)
+
+#define PFB_ENCODED_ENTRY_SIZE (9 * 4 + 8 + 8) /* subgrid header, offset, size */
+
 #define pqr_to_process(p, q, r, P, Q, R)  ((((r) * (Q)) + (q)) * (P) + (p))
 
 #endif
@@ -0,0 +1,364 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+/*****************************************************************************
+* NewIOServers, FreeIOServers, IOServerWrite
+*
+* Dedicated I/O server ranks, see Process.IOServers.
+*
+* The last Process.IOServers ranks are split off by amps_IOServerSplit
+* and do not take part in the simulation.  Compute rank r is served by
+* server r * S / C, with C compute ranks and S servers, so every server
+* has a contiguous block of compute ranks.
+*
+* WritePFBinary and WritePFSBinary pack the rank's part of a file into a
+* buffer, exactly as for the collective MPI-IO writer, and pass it to
+* IOServerWrite.  It ships the buffer to the rank's server with
+* non-blocking sends and returns, the buffer is freed once the sends
+* complete.  A server receives the parts of a file from all its compute
+* ranks and the servers write them in rank order with one collective
+* MPI-IO write, so the files are identical to those of the other
+* writers.
+*
+*****************************************************************************/
+
+#include "parflow.h"
+
+#include <string.h>
+#include <sys/param.h>
+
+#ifdef AMPS_IO_SERVERS
+
+#define IO_SERVER_HEADER_TAG 1
+#define IO_SERVER_DATA_TAG   2
+
+/* Largest single message, keeps counts within int for MPI */
+#define IO_SERVER_MAX_CHUNK  (1L << 30)
+
+#define IOServerNumChunks(size) \
+  (((size) + IO_SERVER_MAX_CHUNK - 1) / IO_SERVER_MAX_CHUNK)
+
+/* First compute rank served by server s */
+#define IOServerFirstRank(s, num_compute, num_servers) \
+  ((int)(((long)(s) * (num_compute) + (num_servers) - 1) / (num_servers)))
+
+typedef struct {
+  int shutdown;
+  int write_dist;
+  long size;
+  char filename[MAXPATHLEN];
+} IOServerHeader;
+
+typedef struct _IOServerSend {
+  IOServerHeader header;
+  char                 *buffer;
+  int num_requests;
+  MPI_Request          *requests;
+  struct _IOServerSend *next;
+} IOServerSend;
+
+/* Rank in amps_CommIO of the server of this compute rank */
+static int io_server_rank = -1;
+
+/* Sends that have not completed yet */
+static IOServerSend *io_server_sends = NULL;
+
+
+/*--------------------------------------------------------------------------
+ * IOServerCompleteSends
+ *
+ * Free the sends that have completed, if wait is set wait for all of
+ * them.
+ *--------------------------------------------------------------------------*/
+
+static void IOServerCompleteSends(int wait)
+{
+  IOServerSend **prev = &io_server_sends;
+  IOServerSend  *send;
+  int done;
+
+  while ((send = *prev) != NULL)
+  {
+    if (wait)
+    {
+      MPI_Waitall(send->num_requests, send->requests, MPI_STATUSES_IGNORE);
+      done = TRUE;
+    }
+    else
+    {
+      MPI_Testall(send->num_requests, send->requests, &done,
+                  MPI_STATUSES_IGNORE);
+    }
+
+    if (done)
+    {
+      *prev = send->next;
+
+      tfree(send->buffer);
+      tfree(send->requests);
+      tfree(send);
+    }
+    else
+    {
+      prev = &(send->next);
+    }
+  }
+}
+
+
+/*--------------------------------------------------------------------------
+ * IOServerRun
+ *
+ * Receive and write files until the compute ranks shut the servers down.
+ *--------------------------------------------------------------------------*/
+
+static void IOServerRun()
+{
+  IOServerHeader *headers;
+  MPI_Request    *requests;
+  long           *sizes;
+  char           *buffer;
+
+  int world_size;
+  int num_servers = amps_Size(amps_CommWorld);
+  int server = amps_Rank(amps_CommWorld);
+  int num_compute;
+  int first, num_clients;
+  int num_requests;
+  int c;
+
+  long size, chunk, offset;
+
+  MPI_Comm_size(amps_CommIO, &world_size);
+  num_compute = world_size - num_servers;
+
+  first = IOServerFirstRank(server, num_compute, num_servers);
+  num_clients = IOServerFirstRank(server + 1, num_compute, num_servers) - first;
+
+  headers = talloc(IOServerHeader, num_clients);
+  sizes = talloc(long, num_clients);
+
+  for (;;)
+  {
+    requests = talloc(MPI_Request, num_clients);
+
+    for (c = 0; c < num_clients; c++)
+    {
+      MPI_Irecv(&headers[c], (int)sizeof(IOServerHeader), MPI_BYTE,
+                first + c, IO_SERVER_HEADER_TAG, amps_CommIO, &requests[c]);
+    }
+    MPI_Waitall(num_clients, requests, MPI_STATUSES_IGNORE);
+
+    tfree(requests);
+
+    /* Every compute rank writes the same sequence of files */
+    if (headers[0].shutdown)
+    {
+      break;
+    }
+
+    size = 0;
+    num_requests = 0;
+    for (c = 0; c < num_clients; c++)
+    {
+      sizes[c] = headers[c].size;
+      size += sizes[c];
+      num_requests += (int)IOServerNumChunks(sizes[c]);
+    }
+
+    buffer = talloc(char, size);
+    requests = talloc(MPI_Request, num_requests);
+
+    num_requests = 0;
+    offset = 0;
+    for (c = 0; c < num_clients; c++)
+    {
+      for (chunk = 0; chunk < sizes[c]; chunk += IO_SERVER_MAX_CHUNK)
+      {
+        MPI_Irecv(buffer + offset + chunk,
+                  (int)pfmin(IO_SERVER_MAX_CHUNK, sizes[c] - chunk), MPI_BYTE,
+                  first + c, IO_SERVER_DATA_TAG, amps_CommIO,
+                  &requests[num_requests++]);
+      }
+      offset += sizes[c];
+    }
+    MPI_Waitall(num_requests, requests, MPI_STATUSES_IGNORE);
+
+    WritePFBinaryCollective(amps_CommWorld, headers[0].filename, buffer,
+                            num_clients, sizes, headers[0].write_dist);
+
+    tfree(buffer);
+    tfree(requests);
+  }
+
+  tfree(headers);
+  tfree(sizes);
+}
+
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * NewIOServers
+ *
+ * Split off the I/O servers if Process.IOServers is set.  Returns TRUE on
+ * the I/O servers once the compute ranks have called FreeIOServers and
+ * all output is written, FALSE right away on the compute ranks.
+ *--------------------------------------------------------------------------*/
+
+int   NewIOServers()
+{
+  char key[IDB_MAX_KEY_LEN];
+  int num_io_servers;
+
+  sprintf(key, "Process.IOServers");
+  num_io_servers = GetIntDefault(key, 0);
+
+  /* Every server needs at least one compute rank */
+  if (num_io_servers < 0 ||
+      (num_io_servers > 0 && 2 * num_io_servers > amps_Size(amps_CommWorld)))
+  {
+    InputError("Error: Invalid value <%s> for key <%s>\n",
+               GetString(key), key);
+  }
+
+  GlobalsNumIOServers = num_io_servers;
+
+  if (num_io_servers == 0)
+  {
+    return FALSE;
+  }
+
+#ifdef AMPS_IO_SERVERS
+  {
+    int num_compute;
+
+    if (amps_IOServerSplit(num_io_servers))
+    {
+      IOServerRun();
+      return TRUE;
+    }
+
+    num_compute = amps_Size(amps_CommWorld);
+    io_server_rank = num_compute
+                     + (int)((long)amps_Rank(amps_CommWorld) * num_io_servers
+                             / num_compute);
+  }
+#else
+  InputError("Error: key <%s> requires the mpi1 AMPS layer%s\n", key, "");
+#endif
+
+  return FALSE;
+}
+
+
+/*--------------------------------------------------------------------------
+ * FreeIOServers
+ *
+ * Called by the compute ranks when they are done, waits for the pending
+ * output and shuts down the I/O servers.
+ *--------------------------------------------------------------------------*/
+
+void  FreeIOServers()
+{
+#ifdef AMPS_IO_SERVERS
+  IOServerHeader header;
+
+  if (io_server_rank < 0)
+  {
+    return;
+  }
+
+  IOServerCompleteSends(TRUE);
+
+  memset(&header, 0, sizeof(header));
+  header.shutdown = TRUE;
+
+  MPI_Send(&header, (int)sizeof(IOServerHeader), MPI_BYTE, io_server_rank,
+           IO_SERVER_HEADER_TAG, amps_CommIO);
+
+  io_server_rank = -1;
+#endif
+}
+
+
+/*--------------------------------------------------------------------------
+ * IOServerWrite
+ *
+ * Ship this rank's part of filename, size bytes in buffer, to its I/O
+ * server.  The buffer must be allocated with talloc and is freed once
+ * it has been sent.  write_dist is passed on to WritePFBinaryCollective.
+ *--------------------------------------------------------------------------*/
+
+void  IOServerWrite(
+                    char *filename,
+                    char *buffer,
+                    long  size,
+                    int   write_dist)
+{
+#ifdef AMPS_IO_SERVERS
+  IOServerSend *send;
+  long chunk;
+  int n;
+
+  /* Release the buffers of earlier output the server has received */
+  IOServerCompleteSends(FALSE);
+
+  send = ctalloc(IOServerSend, 1);
+
+  send->header.shutdown = FALSE;
+  send->header.write_dist = write_dist;
+  send->header.size = size;
+  strncpy(send->header.filename, filename, MAXPATHLEN - 1);
+
+  send->buffer = buffer;
+  send->requests = talloc(MPI_Request, 1 + IOServerNumChunks(size));
+
+  MPI_Isend(&(send->header), (int)sizeof(IOServerHeader), MPI_BYTE,
+            io_server_rank, IO_SERVER_HEADER_TAG, amps_CommIO,
+            &(send->requests[0]));
+
+  n = 1;
+  for (chunk = 0; chunk < size; chunk += IO_SERVER_MAX_CHUNK)
+  {
+    MPI_Isend(buffer + chunk, (int)pfmin(IO_SERVER_MAX_CHUNK, size - chunk),
+              MPI_BYTE, io_server_rank, IO_SERVER_DATA_TAG, amps_CommIO,
+              &(send->requests[n++]));
+  }
+  send->num_requests = n;
+
+  send->next = io_server_sends;
+  io_server_sends = send;
+#else
+  PF_UNUSED(size);
+  PF_UNUSED(write_dist);
+  amps_Printf("Error: can't write %s, I/O servers require the mpi1 AMPS layer\n",
+              filename);
+  tfree(buffer);
+  exit(1);
+#endif
+}
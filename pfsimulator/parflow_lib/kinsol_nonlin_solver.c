@@ -37,6 +37,9 @@ typedef struct {
   int max_iter;
   int krylov_dimension;
   int max_restarts;
+  int gs_type;
+  int pipelined;
+  int history;
   int print_flag;
   int eta_choice;
   int globalization;
@@ -416,6 +419,9 @@ PFModule  *KinsolNonlinSolverInitInstanceXtra(
              matvec,                   /* ATimes routine */
              current_state             /* User data for PC stuff */
              );
+    KINSpgmrSetGSType((void*)kin_mem, public_xtra->gs_type);
+    KINSpgmrSetPipelined((void*)kin_mem, public_xtra->pipelined);
+    KINSpgmrSetHistory((void*)kin_mem, public_xtra->history);
 
     /* Initialize optional arguments for KINSol */
     iopt = instance_xtra->int_optional_input;
@@ -537,6 +543,40 @@ PFModule  *KinsolNonlinSolverNewPublicXtra()
   sprintf(key, "Solver.Linear.MaxRestarts");
   (public_xtra->max_restarts) = GetIntDefault(key, 0);
 
+  /* Order matches enum gs_type */
+  switch_na = NA_NewNameArray("ModifiedGS ClassicalGS ClassicalGS2");
+  sprintf(key, "Solver.Linear.Orthogonalization");
+  switch_name = GetStringDefault(key, "ModifiedGS");
+  (public_xtra->gs_type) = NA_NameToIndex(switch_na, switch_name);
+  if ((public_xtra->gs_type) < 0)
+  {
+    InputError("Error: Invalid value <%s> for key <%s>\n", switch_name,
+               key);
+  }
+  NA_FreeNameArray(switch_na);
+
+  switch_na = NA_NewNameArray("GMRES PipelinedGMRES");
+  sprintf(key, "Solver.Linear.KrylovMethod");
+  switch_name = GetStringDefault(key, "GMRES");
+  (public_xtra->pipelined) = NA_NameToIndex(switch_na, switch_name);
+  if ((public_xtra->pipelined) < 0)
+  {
+    InputError("Error: Invalid value <%s> for key <%s>\n", switch_name,
+               key);
+  }
+  NA_FreeNameArray(switch_na);
+
+  switch_na = NA_NewNameArray("False True");
+  sprintf(key, "Solver.Linear.PrintHistory");
+  switch_name = GetStringDefault(key, "False");
+  (public_xtra->history) = NA_NameToIndex(switch_na, switch_name);
+  if ((public_xtra->history) < 0)
+  {
+    InputError("Error: Invalid value <%s> for key <%s>\n", switch_name,
+               key);
+  }
+  NA_FreeNameArray(switch_na);
+
   verbosity_switch_na = NA_NewNameArray("NoVerbosity LowVerbosity "
                                         "NormalVerbosity HighVerbosity");
   sprintf(key, "Solver.Nonlinear.PrintFlag");
@@ -151,9 +151,9 @@ void MetadataAddParflowDomainInfo(cJSON* pf, PFModule* solver, Grid* localGrid)
 
 #ifdef PARFLOW_HAVE_MPI
   /* Optimization would be to make this a single reduction operation */
-  MPI_Reduce(idivs, gidivs, ni, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-  MPI_Reduce(jdivs, gjdivs, nj, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-  MPI_Reduce(kdivs, gkdivs, nk, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(idivs, gidivs, ni, MPI_INT, MPI_SUM, 0, amps_CommWorld);
+  MPI_Reduce(jdivs, gjdivs, nj, MPI_INT, MPI_SUM, 0, amps_CommWorld);
+  MPI_Reduce(kdivs, gkdivs, nk, MPI_INT, MPI_SUM, 0, amps_CommWorld);
 #else
   /* This is broken for parallel layers other than MPI.  AMPS does not
    * have a Reduce operation; only ReduceAll */
@@ -555,6 +555,37 @@ int MetadataAddDynamicField(
   return 1;
 }
 
+// Record the absolute error bound of a field written with lossy
+// (quantized) PFB output; fields without one are exact.
+int MetadataAddFieldErrorBound(
+                               cJSON*      parent,
+                               const char* field_name,
+                               double      error_bound)
+{
+  if (!parent || !field_name)
+  {
+    return 0;
+  }
+  cJSON* field_item = cJSON_GetObjectItem(parent, field_name);
+  if (!field_item)
+  {
+    fprintf(stderr, "Unable to update metadata for \"%s\"\n", field_name);
+    return 0;
+  }
+
+  cJSON* bound = cJSON_GetObjectItem(field_item, "error-bound");
+  if (bound)
+  {
+    bound->valuedouble = error_bound;
+    bound->valueint = (int)error_bound;
+  }
+  else
+  {
+    cJSON_AddItemToObject(field_item, "error-bound", cJSON_CreateNumber(error_bound));
+  }
+  return 1;
+}
+
 // Unlike other MetadataAdd.*Field methods, this one knows
 // ahead of time which time steps are available (or at least
 // have been specified as available).
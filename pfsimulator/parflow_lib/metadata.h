@@ -73,6 +73,10 @@ int MetadataAddDynamicField(
                             const char*  field_domain,
                             int          num_field_components,
                             const char** field_component_postfixes);
+int MetadataAddFieldErrorBound(
+                               MetadataItem parent,
+                               const char*  field_name,
+                               double       error_bound);
 int MetadataAddForcingField(
                             cJSON*       parent,
                             const char*  field_name,
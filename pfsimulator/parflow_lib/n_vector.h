@@ -31,6 +31,8 @@
 
 #include "parflow.h"
 
+/* Handle of a dot product reduction started by N_VDotProdPairsInit */
+typedef amps_Handle N_VHandle;
 
 
 #define N_VFree(x)                    FreeVector(x)
@@ -45,6 +47,9 @@
 #define N_VAddConst(x, b, z)          PFVAddConst(x, b, z)
 
 #define N_VDotProd(x, y)              PFVDotProd(x, y)
+#define N_VDotProdMulti(n, x, y, d)   PFVDotProdMulti(n, x, y, d)
+#define N_VDotProdPairsInit(n, x, y, d) PFVDotProdPairsInit(n, x, y, d)
+#define N_VDotProdPairsFinalize(h)    PFVDotProdPairsFinalize(h)
 #define N_VMaxNorm(x)                 PFVMaxNorm(x)
 #define N_VWrmsNorm(x, w)             PFVWrmsNorm(x, w)
 #define N_VWL2Norm(x, w)              PFVWL2Norm(x, w)
@@ -41,6 +41,7 @@ void WritePFNC(char * file_prefix, char* file_postfix, double t, Vector  *v, int
 void CreateNCFile(char *file_name, int *netCDFIDs);
 void NCDefDimensions(Vector *v, int dimensionality, int *netCDFIDs);
 void CloseNC(int ncID);
+int NCFieldType(char *key);
 int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs);
 void PutDataInNC(int varID, Vector *v, double t, varNCData *myVarNCData, int dimensionality, int *netCDFIDs);
 void find_variable_length(int nid, int varid, unsigned long dim_lengths[MAX_NC_VARS]);
@@ -20,6 +20,20 @@ Background *ReadBackground(void);
 void FreeBackground(Background *background);
 void SetBackgroundBounds(Background *background, Grid *grid);
 
+/* background_reader.c */
+void NewBackgroundReader(void);
+void FreeBackgroundReader(void);
+int BackgroundReaderActive(void);
+long BackgroundReaderSubmit(void (*read)(void *data), void *data);
+void BackgroundReaderWait(long ticket);
+
+/* background_writer.c */
+void NewBackgroundWriter(int queue_depth);
+void FlushBackgroundWriter(void);
+void FreeBackgroundWriter(void);
+char *BackgroundWriterBuffer(long size);
+void BackgroundWriterSubmit(char *filename, char *buffer, long size, int write_dist);
+
 /* bc_lb.c */
 void LBInitializeBC(Lattice *lattice, Problem *problem, ProblemData *problem_data);
 
@@ -319,6 +333,11 @@ char *NA_IndexToName(NameArray name_array, int index);
 int NA_Sizeof(NameArray name_array);
 void InputError(const char *format, const char *s1, const char *s2);
 
+/* io_server.c */
+int NewIOServers(void);
+void FreeIOServers(void);
+void IOServerWrite(char *filename, char *buffer, long size, int write_dist);
+
 typedef int (*NonlinSolverInvoke) (Vector *pressure, Vector *density, Vector *old_density, Vector *saturation, Vector *old_saturation, double t, double dt, ProblemData *problem_data, Vector *old_pressure, Vector *evap_trans, Vector *ovrl_bc_flx, Vector *x_velocity, Vector *y_velocity, Vector *z_velocity);
 typedef PFModule *(*NonlinSolverInitInstanceXtraInvoke) (Problem *problem, Grid *grid, ProblemData *problem_data, double *temp_data);
 
@@ -1046,8 +1065,23 @@ void RedBlackGSPointFreePublicXtra(void);
 int RedBlackGSPointSizeOfTempData(void);
 
 /* read_parflow_binary.c */
+char *PFBUnpackInt(char *buf, int *ptr, int len);
+char *PFBUnpackDouble(char *buf, double *ptr, int len);
+char *PFBUnpackFloat(char *buf, double *ptr, int len);
+char *PFBUnpackLong(char *buf, long *value);
+void PFBUnshuffle(char *dst, char *src, long n, int width);
+char *PFBDequantize(char *buf, double *data, long n, double error_bound);
+char *UnpackPFBinaryEncodedBlock(char *buf, long size, double *data, long n, int encoding, double error_bound);
 void ReadPFBinary_Subvector(amps_File file, Subvector *subvector, Subgrid *subgrid);
 void ReadPFBinary(char *filename, Vector *v);
+typedef struct _PFBSubgridTable PFBSubgridTable;
+PFBSubgridTable *OpenPFBinarySlices(char *filename);
+void ReadPFBinarySlice(PFBSubgridTable *table, char *filename, Vector *v, int slice);
+void ClosePFBinarySlices(PFBSubgridTable *table);
+int ReadPFBinaryNumSlices(char *filename);
+typedef struct _PFBRead PFBRead;
+PFBRead *StartReadPFBinary(char *filename, Vector *v, int file_z, int vector_z, int num_z);
+void FinishReadPFBinary(PFBRead *read);
 
 /* reg_from_stenc.c */
 void ComputeRegFromStencil(Region **dep_reg_ptr, Region **ind_reg_ptr, SubregionArray *cr_array, Region *send_reg, Region *recv_reg, Stencil *stencil);
@@ -1184,6 +1218,14 @@ void SetupRichards(PFModule *this_module);
 typedef void (*SubsrfSimInvoke) (ProblemData *problem_data, Vector *perm_x, Vector *perm_y, Vector *perm_z, int num_geounits, GeomSolid **geounits, GrGeomSolid **gr_geounits);
 typedef PFModule *(*SubsrfSimInitInstanceXtraInvoke) (Grid *grid, double *temp_data);
 
+/* subfile_writer.c */
+void NewSubfileWriter(int num_ranks);
+void FreeSubfileWriter(void);
+int SubfileWriterSubfile(void);
+int SubfileWriterNumSubfiles(void);
+long SubfileWriterStart(long size);
+void SubfileWriterWrite(char *filename, char *buffer, long size);
+
 /* subsrf_sim.c */
 void SubsrfSim(ProblemData *problem_data, Vector *perm_x, Vector *perm_y, Vector *perm_z, int num_geounits, GeomSolid **geounits, GrGeomSolid **gr_geounits);
 PFModule *SubsrfSimInitInstanceXtra(Grid *grid, double *temp_data);
@@ -1276,6 +1318,9 @@ void PFVAbs(Vector *x, Vector *z);
 void PFVInv(Vector *x, Vector *z);
 void PFVAddConst(Vector *x, double b, Vector *z);
 double PFVDotProd(Vector *x, Vector *y);
+void PFVDotProdMulti(int nvec, Vector *x, Vector **y, double *dots);
+amps_Handle PFVDotProdPairsInit(int nvec, Vector **x, Vector **y, double *dots);
+void PFVDotProdPairsFinalize(amps_Handle handle);
 double PFVMaxNorm(Vector *x);
 double PFVWrmsNorm(Vector *x, Vector *w);
 double PFVWL2Norm(Vector *x, Vector *w);
@@ -1326,11 +1371,33 @@ int WellPackageSizeOfTempData(void);
 void LBWells(Lattice *lattice, Problem *problem, ProblemData *problem_data);
 
 /* write_parflow_binary.c */
+char *PFBPackInt(char *buf, int *ptr, int len);
+char *PFBPackDouble(char *buf, double *ptr, int len);
+char *PFBPackFloat(char *buf, double *ptr, int len);
+char *PFBPackLong(char *buf, long value);
+char *PackPFBinaryHeader(char *buf, int nx, int ny, int nz, int num_subgrids);
+char *PackPFBinarySubgridHeader(char *buf, Subgrid *subgrid);
+long SizeofPFBinaryIndex(int num_subgrids);
+char *PackPFBinaryIndex(char *buf, Grid *grid);
+long SizeofPFBinaryEncodedHeader(int num_subgrids, int encoding);
+char *PackPFBinaryEncodedHeader(char *buf, Grid *grid, int encoding, double error_bound, long *block_sizes, int num_subfiles, int *block_subfiles, long *block_offsets);
+void PFBShuffle(char *dst, char *src, long n, int width);
+char *PFBQuantize(char *buf, double *data, long n, double error_bound);
+long SizeofPFBinaryEncodedSubvector(Subgrid *subgrid, int encoding);
+char *PackPFBinaryEncodedSubvector(char *buf, Subvector *subvector, Subgrid *subgrid, int encoding, int level, double error_bound);
+void WritePFBinaryCollective(amps_Comm comm, char *filename, char *buffer, int num_parts, long *part_sizes, int write_dist);
+char *NewPFBinaryBuffer(long size);
+void WritePFBinaryBuffer(char *filename, char *buffer, long size, int write_dist);
 long SizeofPFBinarySubvector(Subvector *subvector, Subgrid *subgrid);
 void WritePFBinary_Subvector(amps_File file, Subvector *subvector, Subgrid *subgrid);
+char *PackPFBinary_Subvector(char *buf, Subvector *subvector, Subgrid *subgrid);
 void WritePFBinary(char *file_prefix, char *file_suffix, Vector *v);
+void WritePFBinaryQuantized(char *file_prefix, char *file_suffix, Vector *v, double error_bound);
+void WritePFBinarySingle(char *file_prefix, char *file_suffix, Vector *v, int single_precision);
+void WritePFBinaryOutput(char *file_prefix, char *file_suffix, Vector *v, int single_precision, double error_bound);
 long SizeofPFSBinarySubvector(Subvector *subvector, Subgrid *subgrid, double drop_tolerance);
 void WritePFSBinary_Subvector(amps_File file, Subvector *subvector, Subgrid *subgrid, double drop_tolerance);
+char *PackPFSBinary_Subvector(char *buf, Subvector *subvector, Subgrid *subgrid, double drop_tolerance);
 void WritePFSBinary(char *file_prefix, char *file_suffix, Vector *v, double drop_tolerance);
 
 /* write_parflow_silo.c */
@@ -127,22 +127,24 @@ void SADVECT(double *s, double *sn,
                      lai_data, sai_data, z0m_data, displa_data,                                                                                                                \
                      eflx_lh_tot_data, eflx_lwrad_out_data, eflx_sh_tot_data, eflx_soil_grnd_data,                                                                             \
                      qflx_evap_tot_data, qflx_evap_grnd_data, qflx_evap_soi_data, qflx_evap_veg_data, qflx_tran_veg_data,                                                      \
-                     qflx_infl_data, swe_out_data, t_grnd_data, t_soil_data,                                                                                                   \
+                     qflx_infl_data, qflx_top_soil_data, swe_out_data, t_grnd_data, t_soil_data,                                                                               \
                      clm_dump_interval, clm_1d_out, clm_forc_veg, clm_file_dir, clm_file_dir_length, clm_bin_out_dir, write_CLM_binary,                                        \
                      clm_beta_function, clm_veg_function, clm_veg_wilting, clm_veg_fieldc, clm_res_sat,                                                                        \
                      clm_irr_type, clm_irr_cycle, clm_irr_rate, clm_irr_start, clm_irr_stop,                                                                                   \
-                     clm_irr_threshold, qirr, qirr_inst, iflag, clm_irr_thresholdtype, soi_z, clm_next, clm_write_logs, clm_last_rst, clm_daily_rst, clm_nlevsoi, clm_nlevlak) \
+                     clm_irr_threshold, qirr, qirr_inst, iflag, clm_irr_thresholdtype, soi_z, clm_next, clm_write_logs, clm_last_rst, clm_daily_rst, clm_nlevsoi, clm_nlevlak, \
+                     clm_rst_format, clm_rst, clm_rst_nz, clm_rst_read, clm_rst_write) \
   CLM_LSM(pressure_data, saturation_data, evap_trans_data, mask, porosity_data,                                                                                                \
           dz_mult_data, &istep, &dt, &t, &start_time, &dx, &dy, &dz, &ix, &iy, &nx, &ny, &nz, &nx_f, &ny_f, &nz_f, &nz_rz, &ip, &p, &q, &r, &gnx, &gny, &rank,                 \
           sw_data, lw_data, prcp_data, tas_data, u_data, v_data, patm_data, qatm_data,                                                                                         \
           lai_data, sai_data, z0m_data, displa_data,                                                                                                                           \
           eflx_lh_tot_data, eflx_lwrad_out_data, eflx_sh_tot_data, eflx_soil_grnd_data,                                                                                        \
           qflx_evap_tot_data, qflx_evap_grnd_data, qflx_evap_soi_data, qflx_evap_veg_data, qflx_tran_veg_data,                                                                 \
-          qflx_infl_data, swe_out_data, t_grnd_data, t_soil_data,                                                                                                              \
+          qflx_infl_data, qflx_top_soil_data, swe_out_data, t_grnd_data, t_soil_data,                                                                                          \
           &clm_dump_interval, &clm_1d_out, &clm_forc_veg, clm_file_dir, &clm_file_dir_length, &clm_bin_out_dir,                                                                \
           &write_CLM_binary, &clm_beta_function, &clm_veg_function, &clm_veg_wilting, &clm_veg_fieldc,                                                                         \
           &clm_res_sat, &clm_irr_type, &clm_irr_cycle, &clm_irr_rate, &clm_irr_start, &clm_irr_stop,                                                                           \
-          &clm_irr_threshold, qirr, qirr_inst, iflag, &clm_irr_thresholdtype, &soi_z, &clm_next, &clm_write_logs, &clm_last_rst, &clm_daily_rst, &clm_nlevsoi, &clm_nlevlak);
+          &clm_irr_threshold, qirr, qirr_inst, iflag, &clm_irr_thresholdtype, &soi_z, &clm_next, &clm_write_logs, &clm_last_rst, &clm_daily_rst, &clm_nlevsoi, &clm_nlevlak, \
+          &clm_rst_format, clm_rst, &clm_rst_nz, &clm_rst_read, &clm_rst_write);
 
 void CLM_LSM(double *pressure_data, double *saturation_data, double *evap_trans_data, double *mask, double *porosity_data,
              double *dz_mult_data, int *istep, double *dt, double *t, double *start_time,
@@ -152,12 +154,13 @@ void CLM_LSM(double *pressure_data, double *saturation_data, double *evap_trans_
              double *lai_data, double *sai_data, double *z0m_data, double *displa_data,
              double *eflx_lh_tot_data, double *eflx_lwrad_out_data, double *eflx_sh_tot_data, double *eflx_soil_grnd_data, double *qflx_eval_tot_data,
              double *qflx_evap_grnd_data, double *qflx_evap_soi_data, double *qflx_evap_veg_data, double *qflx_tran_veg_data,
-             double *qflx_infl_data, double *swe_out_data, double *t_grnd_data, double *t_soil_data, int *clm_dump_interval, int *clm_1d_out,
+             double *qflx_infl_data, double *qflx_top_soil_data, double *swe_out_data, double *t_grnd_data, double *t_soil_data, int *clm_dump_interval, int *clm_1d_out,
              int *clm_forc_veg, char *clm_file_dir, int *clm_file_dir_length, int *clm_bin_out_dir, int *write_CLM_binary, int *clm_beta_function,
              int *clm_veg_function, double *clm_veg_wilting, double *clm_veg_fieldc, double *clm_res_sat,
              int *clm_irr_type, int *clm_irr_cycle, double *clm_irr_rate, double *clm_irr_start, double *clm_irr_stop,
              double *clm_irr_threshold, double *qirr, double *qirr_inst, double *iflag, int *clm_irr_thresholdtype, int *soi_z,
-             int *clm_next, int *clm_write_logs, int *clm_last_rst, int *clm_daily_rst, int *clm_nlevsoi, int *clm_nlevlak);
+             int *clm_next, int *clm_write_logs, int *clm_last_rst, int *clm_daily_rst, int *clm_nlevsoi, int *clm_nlevlak,
+             int *clm_rst_format, double *clm_rst, int *clm_rst_nz, int *clm_rst_read, int *clm_rst_write);
 
 /* @RMM CRUNCHFLOW.F90*/
 //#define CRUNCHFLOW crunchflow_
@@ -152,7 +152,7 @@ void HypreAssembleGrid(
     }
 
     /* Set the HYPRE grid */
-    HYPRE_StructGridCreate(MPI_COMM_WORLD, 3, hypre_grid);
+    HYPRE_StructGridCreate(amps_CommWorld, 3, hypre_grid);
 
     /* Set local grid extents as global grid values */
     ForSubgridI(sg, GridSubgrids(pf_grid))
@@ -205,7 +205,7 @@ void HypreInitialize(Matrix* pf_Bmat,
   int symmetric = MatrixSymmetric(pf_Bmat);
   if (!(*hypre_mat))
   {
-    HYPRE_StructMatrixCreate(MPI_COMM_WORLD, *hypre_grid,
+    HYPRE_StructMatrixCreate(amps_CommWorld, *hypre_grid,
                              *hypre_stencil,
                              hypre_mat);
     HYPRE_StructMatrixSetNumGhost(*hypre_mat, full_ghosts);
@@ -216,7 +216,7 @@ void HypreInitialize(Matrix* pf_Bmat,
   /* Set up new right-hand-side vector */
   if (!(*hypre_b))
   {
-    HYPRE_StructVectorCreate(MPI_COMM_WORLD,
+    HYPRE_StructVectorCreate(amps_CommWorld,
                              *hypre_grid,
                              hypre_b);
     HYPRE_StructVectorSetNumGhost(*hypre_b, no_ghosts);
@@ -226,7 +226,7 @@ void HypreInitialize(Matrix* pf_Bmat,
   /* Set up new solution vector */
   if (!(*hypre_x))
   {
-    HYPRE_StructVectorCreate(MPI_COMM_WORLD,
+    HYPRE_StructVectorCreate(amps_CommWorld,
                              *hypre_grid,
                              hypre_x);
     HYPRE_StructVectorSetNumGhost(*hypre_x, full_ghosts);
@@ -522,4 +522,175 @@ void HypreAssembleMatrixAsElements(
   HYPRE_StructMatrixAssemble(*hypre_mat);
 }
 
+void HypreAssembleMatrixAsBoxes(
+                                Matrix *     pf_Bmat,
+                                Matrix *     pf_Cmat,
+                                HYPRE_StructMatrix* hypre_mat,
+                                ProblemData *problem_data
+                                )
+{
+  Grid *mat_grid = MatrixGrid(pf_Bmat);
+  double *cp, *wp = NULL, *ep, *sop = NULL, *np, *lp = NULL, *up = NULL;
+  double *cp_c = NULL, *wp_c = NULL, *ep_c = NULL, *sop_c = NULL, *np_c = NULL, *top_dat = NULL;
+  double *values;
+  int sg;
+  int ix, iy, iz;
+  int nx, ny, nz;
+  int nx_m, ny_m, nz_m, sy_v = 0;
+  int i, j, k;
+  int im;
+
+  int stencil_indices[7] = { 0, 1, 2, 3, 4, 5, 6 };
+  int stencil_indices_symm[4] = { 0, 1, 2, 3 };
+  int ilo[3];
+  int ihi[3];
+
+  int stencil_size = MatrixDataStencilSize(pf_Bmat);
+  int symmetric = MatrixSymmetric(pf_Bmat);
+
+  Vector* top = ProblemDataIndexOfDomainTop(problem_data);
+
+  ForSubgridI(sg, GridSubgrids(mat_grid))
+  {
+    Subgrid* subgrid = GridSubgrid(mat_grid, sg);
+
+    Submatrix* pfB_sub = MatrixSubmatrix(pf_Bmat, sg);
+    Submatrix* pfC_sub = NULL;
+    Subvector* top_sub = NULL;
+
+    cp = SubmatrixStencilData(pfB_sub, 0);
+    ep = SubmatrixStencilData(pfB_sub, 2);
+    np = SubmatrixStencilData(pfB_sub, 4);
+    up = SubmatrixStencilData(pfB_sub, 6);
+    if (!symmetric)
+    {
+      wp = SubmatrixStencilData(pfB_sub, 1);
+      sop = SubmatrixStencilData(pfB_sub, 3);
+      lp = SubmatrixStencilData(pfB_sub, 5);
+    }
+
+    if (pf_Cmat != NULL) /* Overland flow, update the top surface */
+    {
+      pfC_sub = MatrixSubmatrix(pf_Cmat, sg);
+      top_sub = VectorSubvector(top, sg);
+
+      cp_c = SubmatrixStencilData(pfC_sub, 0);
+      wp_c = SubmatrixStencilData(pfC_sub, 1);
+      ep_c = SubmatrixStencilData(pfC_sub, 2);
+      sop_c = SubmatrixStencilData(pfC_sub, 3);
+      np_c = SubmatrixStencilData(pfC_sub, 4);
+      top_dat = SubvectorData(top_sub);
+
+      sy_v = SubvectorNX(top_sub);
+    }
+
+    ix = SubgridIX(subgrid);
+    iy = SubgridIY(subgrid);
+    iz = SubgridIZ(subgrid);
+
+    nx = SubgridNX(subgrid);
+    ny = SubgridNY(subgrid);
+    nz = SubgridNZ(subgrid);
+
+    nx_m = SubmatrixNX(pfB_sub);
+    ny_m = SubmatrixNY(pfB_sub);
+    nz_m = SubmatrixNZ(pfB_sub);
+
+    /* Coefficients of the subgrid in the HYPRE box ordering, the stencil
+     * entries of a cell are contiguous and the cells are in (i, j, k)
+     * order */
+    values = talloc(double, nx * ny * nz * stencil_size);
+
+    im = SubmatrixEltIndex(pfB_sub, ix, iy, iz);
+
+    if (symmetric)
+    {
+      BoxLoopI1(i, j, k, ix, iy, iz, nx, ny, nz,
+                im, nx_m, ny_m, nz_m, 1, 1, 1,
+      {
+        double *coeffs = values
+                         + (((k - iz) * ny + (j - iy)) * nx + (i - ix)) * stencil_size;
+
+        coeffs[0] = cp[im];
+        coeffs[1] = ep[im];
+        coeffs[2] = np[im];
+        coeffs[3] = up[im];
+
+        if (pf_Cmat != NULL)
+        {
+          int itop = SubvectorEltIndex(top_sub, i, j, 0);
+          int ktop = (int)top_dat[itop];
+
+          if (ktop == k)
+          {
+            /* update diagonal coeff */
+            coeffs[0] = cp_c[SubmatrixEltIndex(pfC_sub, i, j, iz)];    //cp[im] is zero
+          }
+        }
+      });
+    }
+    else
+    {
+      BoxLoopI1(i, j, k, ix, iy, iz, nx, ny, nz,
+                im, nx_m, ny_m, nz_m, 1, 1, 1,
+      {
+        double *coeffs = values
+                         + (((k - iz) * ny + (j - iy)) * nx + (i - ix)) * stencil_size;
+
+        coeffs[0] = cp[im];
+        coeffs[1] = wp[im];
+        coeffs[2] = ep[im];
+        coeffs[3] = sop[im];
+        coeffs[4] = np[im];
+        coeffs[5] = lp[im];
+        coeffs[6] = up[im];
+
+        if (pf_Cmat != NULL)
+        {
+          int itop = SubvectorEltIndex(top_sub, i, j, 0);
+          int ktop = (int)top_dat[itop];
+          int io = SubmatrixEltIndex(pfC_sub, i, j, iz);
+
+          /* Same surface contributions as HypreAssembleMatrixAsElements,
+           * the lower and upper coeffs stay as they are */
+          if (ktop == k)
+          {
+            /* update diagonal coeff */
+            coeffs[0] = cp_c[io];               //cp[im] is zero
+            /* update west coeff */
+            if ((int)top_dat[itop - 1] == ktop)
+              coeffs[1] = wp_c[io];             //wp[im] is zero
+            /* update east coeff */
+            if ((int)top_dat[itop + 1] == ktop)
+              coeffs[2] = ep_c[io];             //ep[im] is zero
+            /* update south coeff */
+            if ((int)top_dat[itop - sy_v] == ktop)
+              coeffs[3] = sop_c[io];            //sop[im] is zero
+            /* update north coeff */
+            if ((int)top_dat[itop + sy_v] == ktop)
+              coeffs[4] = np_c[io];             //np[im] is zero
+          }
+        }
+      });
+    }
+
+    ilo[0] = ix;
+    ilo[1] = iy;
+    ilo[2] = iz;
+    ihi[0] = ix + nx - 1;
+    ihi[1] = iy + ny - 1;
+    ihi[2] = iz + nz - 1;
+
+    HYPRE_StructMatrixSetBoxValues(*hypre_mat,
+                                   ilo, ihi,
+                                   stencil_size,
+                                   symmetric ? stencil_indices_symm : stencil_indices,
+                                   values);
+
+    tfree(values);
+  }   /* End subgrid loop */
+
+  HYPRE_StructMatrixAssemble(*hypre_mat);
+}
+
 #endif // HAVE_HYPRE
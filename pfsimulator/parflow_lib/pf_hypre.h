@@ -108,6 +108,27 @@ void HypreAssembleMatrixAsElements(
 				   ProblemData *problem_data
 				   );
 
+/**
+ * Assemble the Hypre matrix from B and C ParFlow matrices using a
+ * box filling.
+ *
+ * Copies coefficients from the B and C matrices into the supplied
+ * Hypre matrix.  The coefficients of each subgrid are packed into a
+ * buffer and inserted into the Hypre matrix with one call.  The matrix
+ * is the same as the one from HypreAssembleMatrixAsElements.
+ *
+ * @param pf_Bmat The B matrix
+ * @param pf_Cmat The C matrix
+ * @param hyre_mat The filled in Hypre matrix
+ * @param problem_data ParFlow problem data
+ */
+void HypreAssembleMatrixAsBoxes(
+				Matrix *     pf_Bmat,
+				Matrix *     pf_Cmat,
+				HYPRE_StructMatrix* hypre_mat,
+				ProblemData *problem_data
+				);
+
 #endif
 
 #endif
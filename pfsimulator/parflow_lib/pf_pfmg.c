@@ -43,8 +43,11 @@ typedef struct {
   int smoother;
   int raptype;
 
+  int matrix_assembly;                /* 0 = Element, 1 = Box */
+
   int time_index_pfmg;
   int time_index_copy_hypre;
+  int time_index_assemble_hypre;
 } PublicXtra;
 
 typedef struct {
@@ -194,16 +197,28 @@ PFModule  *PFMGInitInstanceXtra(
 
     /* Copy the matrix entries */
     BeginTiming(public_xtra->time_index_copy_hypre);
+    BeginTiming(public_xtra->time_index_assemble_hypre);
 
-    HypreAssembleMatrixAsElements(pf_Bmat,
-				  pf_Cmat,
-				  &(instance_xtra -> hypre_mat),
-				  problem_data);
-    
+    if (public_xtra->matrix_assembly)
+    {
+      HypreAssembleMatrixAsBoxes(pf_Bmat,
+                                 pf_Cmat,
+                                 &(instance_xtra -> hypre_mat),
+                                 problem_data);
+    }
+    else
+    {
+      HypreAssembleMatrixAsElements(pf_Bmat,
+                                    pf_Cmat,
+                                    &(instance_xtra -> hypre_mat),
+                                    problem_data);
+    }
+
+    EndTiming(public_xtra->time_index_assemble_hypre);
     EndTiming(public_xtra->time_index_copy_hypre);
 
     /* Set up the PFMG preconditioner */
-    HYPRE_StructPFMGCreate(MPI_COMM_WORLD,
+    HYPRE_StructPFMGCreate(amps_CommWorld,
                            &(instance_xtra->hypre_pfmg_data));
 
     HYPRE_StructPFMGSetTol(instance_xtra->hypre_pfmg_data, 1.0e-30);
@@ -283,6 +298,9 @@ PFModule  *PFMGNewPublicXtra(char *name)
   char          *raptype_name;
   NameArray raptype_switch_na;
   int raptype;
+  char          *matrix_assembly_name;
+  NameArray matrix_assembly_switch_na;
+  int matrix_assembly;
 
   public_xtra = ctalloc(PublicXtra, 1);
 
@@ -334,8 +352,26 @@ PFModule  *PFMGNewPublicXtra(char *name)
                smoother_name, key);
   }
 
+  matrix_assembly_switch_na = NA_NewNameArray("Element Box");
+  sprintf(key, "%s.MatrixAssembly", name);
+  matrix_assembly_name = GetStringDefault(key, "Box");
+  matrix_assembly = NA_NameToIndex(matrix_assembly_switch_na,
+                                   matrix_assembly_name);
+  if (matrix_assembly >= 0)
+  {
+    public_xtra->matrix_assembly = matrix_assembly;
+  }
+  else
+  {
+    InputError("Error: Invalid value <%s> for key <%s>.\n",
+               matrix_assembly_name, key);
+  }
+  NA_FreeNameArray(matrix_assembly_switch_na);
+
   public_xtra->time_index_pfmg = RegisterTiming("PFMG");
   public_xtra->time_index_copy_hypre = RegisterTiming("HYPRE_Copies");
+  public_xtra->time_index_assemble_hypre =
+    RegisterTiming("HYPRE_Matrix_Assembly");
 
   PFModulePublicXtra(this_module) = public_xtra;
 
@@ -41,8 +41,11 @@ typedef struct {
   int num_pre_relax;
   int num_post_relax;
 
+  int matrix_assembly;                /* 0 = Element, 1 = Box */
+
   int time_index_smg;
   int time_index_copy_hypre;
+  int time_index_assemble_hypre;
 } PublicXtra;
 
 typedef struct {
@@ -190,16 +193,28 @@ PFModule  *SMGInitInstanceXtra(
 
     /* Copy the matrix entries */
     BeginTiming(public_xtra->time_index_copy_hypre);
-    
-    HypreAssembleMatrixAsElements(pf_Bmat,
-				  pf_Cmat,
-				  &(instance_xtra -> hypre_mat),
-				  problem_data);
+    BeginTiming(public_xtra->time_index_assemble_hypre);
+
+    if (public_xtra->matrix_assembly)
+    {
+      HypreAssembleMatrixAsBoxes(pf_Bmat,
+                                 pf_Cmat,
+                                 &(instance_xtra -> hypre_mat),
+                                 problem_data);
+    }
+    else
+    {
+      HypreAssembleMatrixAsElements(pf_Bmat,
+                                    pf_Cmat,
+                                    &(instance_xtra -> hypre_mat),
+                                    problem_data);
+    }
 
+    EndTiming(public_xtra->time_index_assemble_hypre);
     EndTiming(public_xtra->time_index_copy_hypre);
 
     /* Set up the SMG preconditioner */
-    HYPRE_StructSMGCreate(MPI_COMM_WORLD,
+    HYPRE_StructSMGCreate(amps_CommWorld,
                           &(instance_xtra->hypre_smg_data));
 
     /* Set SMG to recompute rather than save data */
@@ -267,6 +282,9 @@ PFModule  *SMGNewPublicXtra(char *name)
   PublicXtra    *public_xtra;
 
   char key[IDB_MAX_KEY_LEN];
+  char          *matrix_assembly_name;
+  NameArray matrix_assembly_switch_na;
+  int matrix_assembly;
 
   public_xtra = ctalloc(PublicXtra, 1);
 
@@ -279,8 +297,26 @@ PFModule  *SMGNewPublicXtra(char *name)
   sprintf(key, "%s.NumPostRelax", name);
   public_xtra->num_post_relax = GetIntDefault(key, 0);
 
+  matrix_assembly_switch_na = NA_NewNameArray("Element Box");
+  sprintf(key, "%s.MatrixAssembly", name);
+  matrix_assembly_name = GetStringDefault(key, "Box");
+  matrix_assembly = NA_NameToIndex(matrix_assembly_switch_na,
+                                   matrix_assembly_name);
+  if (matrix_assembly >= 0)
+  {
+    public_xtra->matrix_assembly = matrix_assembly;
+  }
+  else
+  {
+    InputError("Error: Invalid value <%s> for key <%s>.\n",
+               matrix_assembly_name, key);
+  }
+  NA_FreeNameArray(matrix_assembly_switch_na);
+
   public_xtra->time_index_smg = RegisterTiming("SMG");
   public_xtra->time_index_copy_hypre = RegisterTiming("HYPRE_Copies");
+  public_xtra->time_index_assemble_hypre =
+    RegisterTiming("HYPRE_Matrix_Assembly");
 
   PFModulePublicXtra(this_module) = public_xtra;
 
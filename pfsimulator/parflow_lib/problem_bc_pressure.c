@@ -30,6 +30,7 @@
 *****************************************************************************/
 
 #include "parflow.h"
+#include "parflow_netcdf.h"
 
 #include <string.h>
 
@@ -40,6 +41,15 @@
 typedef struct {
   int num_phases;
   //int     iflag;   //@RMM
+
+  /* Values of the file defined patches and the interval they were read
+   * for, shared by all instances of the module, and the open time-stacked
+   * PFB files of the patches */
+  Grid         *file_grid;
+  Vector      **file_values;
+  int          *file_intervals;
+  PFBSubgridTable **file_tables;
+  int num_file_patches;
 } PublicXtra;
 
 typedef struct {
@@ -51,6 +61,116 @@ typedef struct {
   Grid         *grid;
 } InstanceXtra;
 
+/*--------------------------------------------------------------------------
+ * BCPressureFreeFileValues:
+ *   Free the values kept for the file defined patches.
+ *--------------------------------------------------------------------------*/
+
+static void BCPressureFreeFileValues(
+                                     PublicXtra *public_xtra)
+{
+  int ipatch;
+
+  for (ipatch = 0; ipatch < public_xtra->num_file_patches; ipatch++)
+  {
+    if (public_xtra->file_values[ipatch])
+    {
+      FreeVector(public_xtra->file_values[ipatch]);
+    }
+    if (public_xtra->file_tables[ipatch])
+    {
+      ClosePFBinarySlices(public_xtra->file_tables[ipatch]);
+    }
+  }
+
+  tfree(public_xtra->file_values);
+  tfree(public_xtra->file_intervals);
+  tfree(public_xtra->file_tables);
+
+  public_xtra->file_grid = NULL;
+  public_xtra->file_values = NULL;
+  public_xtra->file_intervals = NULL;
+  public_xtra->file_tables = NULL;
+  public_xtra->num_file_patches = 0;
+}
+
+/*--------------------------------------------------------------------------
+ * BCPressureFileValues:
+ *   Return the values of the file defined patch ipatch for the interval.
+ *   The values are kept in the public_xtra, so the instances used by the
+ *   function evaluation, the Jacobian and the discretization share them,
+ *   and the file is only read again when the interval of the patch
+ *   changes.  For a time-stacked file (slice >= 0) the slice of the
+ *   interval is read, from a PFB file stacked in z or from the time steps
+ *   of the NetCDF variable nc_var.  A time-stacked PFB file is opened
+ *   on first use and kept open, later intervals only read their slice.
+ *--------------------------------------------------------------------------*/
+
+static Vector *BCPressureFileValues(
+                                    PublicXtra *public_xtra,
+                                    Grid *      grid,
+                                    int         num_patches,
+                                    int         ipatch,
+                                    int         interval_number,
+                                    char *      filename,
+                                    int         slice,
+                                    char *      nc_var)
+{
+  int num_chars = strlen(filename);
+
+  if (public_xtra->file_values && (public_xtra->file_grid != grid))
+  {
+    BCPressureFreeFileValues(public_xtra);
+  }
+
+  if (public_xtra->file_values == NULL)
+  {
+    public_xtra->file_grid = grid;
+    public_xtra->file_values = ctalloc(Vector *, num_patches);
+    public_xtra->file_intervals = talloc(int, num_patches);
+    public_xtra->file_tables = ctalloc(PFBSubgridTable *, num_patches);
+    public_xtra->num_file_patches = num_patches;
+  }
+
+  if (public_xtra->file_values[ipatch] == NULL)
+  {
+    public_xtra->file_values[ipatch] =
+      NewVectorType(grid, 1, 0, vector_cell_centered);
+  }
+  else if (public_xtra->file_intervals[ipatch] == interval_number)
+  {
+    return public_xtra->file_values[ipatch];
+  }
+
+  BeginTiming(BCFileTimingIndex);
+
+  if (slice < 0)
+  {
+    ReadPFBinary(filename, public_xtra->file_values[ipatch]);
+  }
+  else if ((num_chars > 3) && !strcmp(".nc", &filename[num_chars - 3]))
+  {
+    ReadPFNC(filename, public_xtra->file_values[ipatch], nc_var, slice, 3);
+  }
+  else
+  {
+    if (public_xtra->file_tables[ipatch] == NULL)
+    {
+      public_xtra->file_tables[ipatch] = OpenPFBinarySlices(filename);
+    }
+
+    ReadPFBinarySlice(public_xtra->file_tables[ipatch], filename,
+                      public_xtra->file_values[ipatch], slice);
+  }
+
+  IncTimingCount(BCFileTimingIndex);
+  EndTiming(BCFileTimingIndex);
+
+  public_xtra->file_intervals[ipatch] = interval_number;
+
+  return public_xtra->file_values[ipatch];
+}
+
 /*--------------------------------------------------------------------------
  * BCPressure:
  *   This routine returns a BCStruct structure which describes where
@@ -671,12 +791,11 @@ BCStruct    *BCPressure(
 
         case PressureFile:
         {
-          /* Read input pressures from file (temporary).
+          /* Read input pressures from file.
            * This case assumes hydraulic head input conditions and
            * a constant density.  */
-          Vector          *tmp_vector;
+          Vector          *file_vector;
           Subvector       *subvector;
-          char            *filename;
           double          *tmpp;
           int itmp;
           double density, dtmp;
@@ -689,6 +808,12 @@ BCStruct    *BCPressure(
           GetBCPressureTypeStruct(PressureFile, interval_data, bc_pressure_data,
                                   ipatch, interval_number);
 
+          file_vector = BCPressureFileValues(public_xtra, grid, num_patches,
+                                             ipatch, interval_number,
+                                             PressureFileName(interval_data),
+                                             PressureFileSlice(interval_data),
+                                             "pressure");
+
           ForSubgridI(is, subgrids)
           {
             subgrid = SubgridArraySubgrid(subgrids, is);
@@ -709,12 +834,7 @@ BCStruct    *BCPressure(
             memset(patch_values, 0, patch_values_size * sizeof(double));
             values[ipatch][is] = patch_values;
 
-            tmp_vector = NewVectorType(grid, 1, 0, vector_cell_centered);
-
-            filename = PressureFileName(interval_data);
-            ReadPFBinary(filename, tmp_vector);
-
-            subvector = VectorSubvector(tmp_vector, is);
+            subvector = VectorSubvector(file_vector, is);
 
             tmpp = SubvectorData(subvector);
             ForEachPatchCell(i, j, k, ival, bc_struct, ipatch, is,
@@ -725,24 +845,26 @@ BCStruct    *BCPressure(
               patch_values[ival] = tmpp[itmp];     /*- density*gravity*z;*/
               /*last part taken out, very likely to be a bug)*/
             });
-
-            FreeVector(tmp_vector);
           }             /* End subgrid loop */
           break;
         } /* End PressureFile */
 
         case FluxFile:
         {
-          /* Read input fluxes from file (temporary) */
-          Vector          *tmp_vector;
+          /* Read input fluxes from file */
+          Vector          *file_vector;
           Subvector       *subvector;
-          char            *filename;
           double          *tmpp;
           int itmp;
 
           GetBCPressureTypeStruct(FluxFile, interval_data, bc_pressure_data,
                                   ipatch, interval_number);
 
+          file_vector = BCPressureFileValues(public_xtra, grid, num_patches,
+                                             ipatch, interval_number,
+                                             FluxFileName(interval_data),
+                                             FluxFileSlice(interval_data),
+                                             "flux");
 
           ForSubgridI(is, subgrids)
           {
@@ -757,12 +879,7 @@ BCStruct    *BCPressure(
             memset(patch_values, 0, patch_values_size * sizeof(double));
             values[ipatch][is] = patch_values;
 
-            tmp_vector = NewVectorType(grid, 1, 0, vector_cell_centered);
-
-            filename = FluxFileName(interval_data);
-            ReadPFBinary(filename, tmp_vector);
-
-            subvector = VectorSubvector(tmp_vector, is);
+            subvector = VectorSubvector(file_vector, is);
 
             tmpp = SubvectorData(subvector);
             ForEachPatchCell(i, j, k, ival, bc_struct, ipatch, is,
@@ -771,8 +888,6 @@ BCStruct    *BCPressure(
 
               patch_values[ival] = tmpp[itmp];
             });
-
-            FreeVector(tmp_vector);
           }         /* End subgrid loop */
           break;
         } /* End FluxFile */
@@ -990,16 +1105,19 @@ BCStruct    *BCPressure(
         case OverlandFlowPFB:
         {
           /* Read input fluxes from file (overland) */
-          Vector          *tmp_vector;
+          Vector          *file_vector;
           Subvector       *subvector;
-          //double          *data;
-          char            *filename;
           double          *tmpp;
           int itmp;
 
           GetBCPressureTypeStruct(OverlandFlowPFB, interval_data, bc_pressure_data,
                                   ipatch, interval_number);
 
+          file_vector = BCPressureFileValues(public_xtra, grid, num_patches,
+                                             ipatch, interval_number,
+                                             OverlandFlowPFBFileName(interval_data),
+                                             -1, NULL);
+
           ForSubgridI(is, subgrids)
           {
             /* compute patch_values_size (this isn't really needed yet) */
@@ -1013,15 +1131,7 @@ BCStruct    *BCPressure(
             memset(patch_values, 0, patch_values_size * sizeof(double));
             values[ipatch][is] = patch_values;
 
-            tmp_vector = NewVectorType(grid, 1, 0, vector_cell_centered);
-            //data = ctalloc(double, SizeOfVector(tmp_vector));
-            //SetTempVectorData(tmp_vector, data);
-
-            printf("reading overland file \n");
-            filename = OverlandFlowPFBFileName(interval_data);
-            ReadPFBinary(filename, tmp_vector);
-
-            subvector = VectorSubvector(tmp_vector, is);
+            subvector = VectorSubvector(file_vector, is);
 
             tmpp = SubvectorData(subvector);
             ForEachPatchCell(i, j, k, ival, bc_struct, ipatch, is,
@@ -1030,9 +1140,6 @@ BCStruct    *BCPressure(
 
               patch_values[ival] = tmpp[itmp];
             });
-
-            //tfree(VectorData(tmp_vector));
-            FreeVector(tmp_vector);
           }              /* End subgrid loop */
           break;
         } /* End OverlandFlowPFB */
@@ -1184,6 +1291,7 @@ PFModule *BCPressureInitInstanceXtra(Problem *problem)
 void BCPressureFreeInstanceXtra()
 {
   PFModule      *this_module = ThisPFModule;
+  PublicXtra    *public_xtra = (PublicXtra*)PFModulePublicXtra(this_module);
   InstanceXtra  *instance_xtra = (InstanceXtra*)PFModuleInstanceXtra(this_module);
 
   if (instance_xtra)
@@ -1217,6 +1325,10 @@ void BCPressureFreeInstanceXtra()
 
       tfree(instance_xtra->elevations);
     }
+
+    /* Free the kept file values while their grid still exists */
+    BCPressureFreeFileValues(public_xtra);
+
     PFModuleFreeInstance(instance_xtra->phase_density);
     tfree(instance_xtra);
   }
@@ -32,9 +32,278 @@
 *****************************************************************************/
 #include "parflow.h"
 
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
+#ifdef PARFLOW_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/*--------------------------------------------------------------------------
+ * PFBUnpackInt, PFBUnpackDouble, PFBUnpackFloat
+ *
+ * Inverse of PFBPackInt/PFBPackDouble/PFBPackFloat, convert XDR (big
+ * endian) values in a byte buffer to native values.  PFBUnpackFloat
+ * widens the floats to doubles.  Return the next unread byte of the
+ * buffer.
+ *--------------------------------------------------------------------------*/
+
+char      *PFBUnpackInt(
+                        char *buf,
+                        int * ptr,
+                        int   len)
+{
+#ifdef CASC_HAVE_BIGENDIAN
+  memcpy(ptr, buf, (size_t)len * amps_SizeofInt);
+#else
+  int i;
+
+  for (i = 0; i < len; i++)
+  {
+    uint32_t x;
+
+    memcpy(&x, &buf[(size_t)i * amps_SizeofInt], sizeof(x));
+    x = PFByteSwap32(x);
+    memcpy(&ptr[i], &x, sizeof(x));
+  }
+#endif
+
+  return buf + (size_t)len * amps_SizeofInt;
+}
+
+char      *PFBUnpackDouble(
+                           char *  buf,
+                           double *ptr,
+                           int     len)
+{
+#ifdef CASC_HAVE_BIGENDIAN
+  memcpy(ptr, buf, (size_t)len * amps_SizeofDouble);
+#else
+  int i;
+
+  for (i = 0; i < len; i++)
+  {
+    uint64_t x;
+
+    memcpy(&x, &buf[(size_t)i * amps_SizeofDouble], sizeof(x));
+    x = PFByteSwap64(x);
+    memcpy(&ptr[i], &x, sizeof(x));
+  }
+#endif
+
+  return buf + (size_t)len * amps_SizeofDouble;
+}
+
+char      *PFBUnpackFloat(
+                          char *  buf,
+                          double *ptr,
+                          int     len)
+{
+  int i;
+
+  for (i = 0; i < len; i++)
+  {
+    float f;
+    uint32_t x;
+
+    memcpy(&x, &buf[(size_t)i * amps_SizeofFloat], sizeof(x));
+#ifndef CASC_HAVE_BIGENDIAN
+    x = PFByteSwap32(x);
+#endif
+    memcpy(&f, &x, sizeof(f));
+    ptr[i] = (double)f;
+  }
+
+  return buf + (size_t)len * amps_SizeofFloat;
+}
+
+char      *PFBUnpackLong(
+                         char *buf,
+                         long *value)
+{
+  uint64_t x;
+
+  memcpy(&x, buf, sizeof(x));
+#ifndef CASC_HAVE_BIGENDIAN
+  x = PFByteSwap64(x);
+#endif
+  *value = (long)x;
+
+  return buf + sizeof(x);
+}
+
+
+/*--------------------------------------------------------------------------
+ * PFBUnshuffle
+ *
+ * Inverse of PFBShuffle.
+ *--------------------------------------------------------------------------*/
+
+void       PFBUnshuffle(
+                        char *dst,
+                        char *src,
+                        long  n,
+                        int   width)
+{
+  long i;
+  int b;
+
+  for (b = 0; b < width; b++)
+  {
+    for (i = 0; i < n; i++)
+    {
+      dst[i * width + b] = src[b * n + i];
+    }
+  }
+}
+
+
+/*--------------------------------------------------------------------------
+ * PFBDequantize
+ *
+ * Inverse of PFBQuantize, return the end of the block.
+ *--------------------------------------------------------------------------*/
+
+char      *PFBDequantize(
+                         char *  buf,
+                         double *data,
+                         long    n,
+                         double  error_bound)
+{
+  double step = 2.0 * error_bound;
+  double min;
+
+  unsigned char  *ptr;
+  uint64_t acc;
+  uint64_t mask;
+  int bits;
+  int num_acc;
+  long i;
+
+  buf = PFBUnpackDouble(buf, &min, 1);
+  buf = PFBUnpackInt(buf, &bits, 1);
+
+  if (bits == 64)
+  {
+    for (i = 0; i < n; i++)
+    {
+      buf = PFBUnpackDouble(buf, &data[i], 1);
+    }
+    return buf;
+  }
+
+  mask = (((uint64_t)1) << bits) - 1;
+
+  ptr = (unsigned char*)buf;
+  acc = 0;
+  num_acc = 0;
+  for (i = 0; i < n; i++)
+  {
+    while (num_acc < bits)
+    {
+      acc = (acc << 8) | *ptr++;
+      num_acc += 8;
+    }
+    num_acc -= bits;
+
+    data[i] = min + (double)((acc >> num_acc) & mask) * step;
+  }
+
+  return (char*)ptr;
+}
+
+
+/*--------------------------------------------------------------------------
+ * UnpackPFBinaryEncodedBlock
+ *
+ * Decode the size bytes of a block of an encoded PFB file (see
+ * PackPFBinaryEncodedSubvector) into the n values of data.  Return the
+ * end of the block.
+ *--------------------------------------------------------------------------*/
+
+char      *UnpackPFBinaryEncodedBlock(
+                                      char *  buf,
+                                      long    size,
+                                      double *data,
+                                      long    n,
+                                      int     encoding,
+                                      double  error_bound)
+{
+  int width = PFBEncodedValueSize(encoding);
+  long raw_size = n * width;
+
+  if (encoding & PFB_ENCODING_QUANTIZE)
+  {
+    raw_size = n * amps_SizeofDouble + amps_SizeofDouble + amps_SizeofInt;
+  }
+
+  if (!(encoding & PFB_ENCODING_DEFLATE))
+  {
+    if (encoding & PFB_ENCODING_QUANTIZE)
+    {
+      PFBDequantize(buf, data, n, error_bound);
+    }
+    else if (encoding & PFB_ENCODING_FLOAT)
+    {
+      PFBUnpackFloat(buf, data, (int)n);
+    }
+    else
+    {
+      PFBUnpackDouble(buf, data, (int)n);
+    }
+    return buf + size;
+  }
+
+#ifdef PARFLOW_HAVE_ZLIB
+  {
+    char   *shuffled = talloc(char, raw_size);
+    char   *values = talloc(char, raw_size);
+    uLongf len = (uLongf)raw_size;
+
+    /* Quantized blocks are smaller than the bound, but never larger */
+    if ((uncompress((Bytef*)shuffled, &len, (Bytef*)buf, (uLong)size) != Z_OK)
+        || ((long)len > raw_size)
+        || (!(encoding & PFB_ENCODING_QUANTIZE) && ((long)len != raw_size)))
+    {
+      amps_Printf("Error: can't decompress PFB data\n");
+      exit(1);
+    }
+
+    if (encoding & PFB_ENCODING_QUANTIZE)
+    {
+      PFBDequantize(shuffled, data, n, error_bound);
+    }
+    else
+    {
+      PFBUnshuffle(values, shuffled, n, width);
+      if (encoding & PFB_ENCODING_FLOAT)
+      {
+        PFBUnpackFloat(values, data, (int)n);
+      }
+      else
+      {
+        PFBUnpackDouble(values, data, (int)n);
+      }
+    }
+
+    tfree(values);
+    tfree(shuffled);
+  }
+#else
+  PF_UNUSED(data);
+  PF_UNUSED(raw_size);
+  PF_UNUSED(width);
+  PF_UNUSED(error_bound);
+  amps_Printf("Error: reading compressed PFB files requires zlib\n");
+  exit(1);
+#endif
+
+  return buf + size;
+}
+
 void ReadPFBinary_Subvector(
                             amps_File  file,
                             Subvector *subvector,
@@ -44,13 +313,13 @@ void ReadPFBinary_Subvector(
   int nx, ny, nz;
   int rx, ry, rz;
 
-  int nx_v = SubvectorNX(subvector);
-  int ny_v = SubvectorNY(subvector);
-  int nz_v = SubvectorNZ(subvector);
-
-  int i, j, k, ai;
+  int j, k;
   double         *data;
 
+  long size;
+  char           *buffer;
+  char           *ptr;
+
   (void)subgrid;
 
   amps_ReadInt(file, &ix, 1);
@@ -65,28 +334,718 @@ void ReadPFBinary_Subvector(
   amps_ReadInt(file, &ry, 1);
   amps_ReadInt(file, &rz, 1);
 
-  data = SubvectorElt(subvector, ix, iy, iz);
+  /* Read the whole subgrid into a staging buffer with a single call
+   * and convert it a x-row at a time */
+  size = (long)nx * ny * nz * amps_SizeofDouble;
+  buffer = talloc(char, size);
+
+  if ((long)amps_ReadChar(file, buffer, size) != size)
+  {
+    amps_Printf("Error: can't read subgrid data\n");
+    exit(1);
+  }
+
+  ptr = buffer;
+  for (k = iz; k < iz + nz; k++)
+  {
+    for (j = iy; j < iy + ny; j++)
+    {
+      data = SubvectorElt(subvector, ix, j, k);
+      ptr = PFBUnpackDouble(ptr, data, nx);
+    }
+  }
+
+  tfree(buffer);
+}
+
+
+/*--------------------------------------------------------------------------
+ * PFBSubgridTable
+ *
+ * Extents and location of the subgrids stored in a PFB file.  A table
+ * from OpenPFBinarySlices also keeps the file open for the reads.
+ *--------------------------------------------------------------------------*/
+
+struct _PFBSubgridTable {
+  int num_subgrids;
+  int encoding;             /* PFB_ENCODING_NONE for plain files      */
+  double error_bound;       /* bound of PFB_ENCODING_QUANTIZE files   */
+
+  int   *extents;           /* ix, iy, iz, nx, ny, nz of each subgrid */
+  long  *offsets;           /* byte offset of the first data value    */
+  long  *sizes;             /* size of the encoded blocks, or NULL    */
+  int   *subfiles;          /* subfile of each block, or NULL         */
+
+  int clip_lz, clip_uz;     /* z layers of the vector that are filled */
+
+  FILE *file;               /* open file of the reads, or NULL        */
+#ifdef PARFLOW_HAVE_MPI
+  MPI_File fh;              /* open file of collective reads          */
+#endif
+};
+
+/* One contiguous run of values to copy from the file into a subvector */
+typedef struct {
+  long offset;
+  int len;
+  double *data;
+} PFBRun;
+
 
-  ai = 0;
-  BoxLoopI1(i, j, k,
-            ix, iy, iz, nx, ny, nz,
-            ai, nx_v, ny_v, nz_v, 1, 1, 1,
+/*--------------------------------------------------------------------------
+ * ReadPFBinaryIndex
+ *
+ * Fill the table from the subgrid index at the end of the file if one is
+ * present (see PackPFBinaryIndex).  Returns FALSE, leaving the table
+ * untouched, for files without an index or with an unknown index version.
+ *--------------------------------------------------------------------------*/
+
+static int ReadPFBinaryIndex(
+                             FILE *           file,
+                             int              num_subgrids,
+                             PFBSubgridTable *table)
+{
+  char trailer[PFB_INDEX_TRAILER_SIZE];
+  char           *index;
+  char           *ptr;
+  long file_size, index_offset, index_size;
+  int version, s, d;
+
+  if (fseek(file, 0, SEEK_END) || ((file_size = ftell(file)) < PFB_INDEX_TRAILER_SIZE))
+    return FALSE;
+
+  if (fseek(file, file_size - PFB_INDEX_TRAILER_SIZE, SEEK_SET) ||
+      (fread(trailer, 1, sizeof(trailer), file) != sizeof(trailer)))
+    return FALSE;
+
+  if (memcmp(trailer + 8 + 4, PFB_INDEX_MAGIC, 4))
+    return FALSE;
+
+  ptr = PFBUnpackLong(trailer, &index_offset);
+  PFBUnpackInt(ptr, &version, 1);
+
+  index_size = SizeofPFBinaryIndex(num_subgrids);
+  if ((version != PFB_INDEX_VERSION) || (index_offset + index_size != file_size))
+    return FALSE;
+
+  index = talloc(char, index_size);
+
+  if (fseek(file, index_offset, SEEK_SET) ||
+      (fread(index, 1, index_size, file) != (size_t)index_size))
+  {
+    tfree(index);
+    return FALSE;
+  }
+
+  ptr = index;
+  for (s = 0; s < num_subgrids; s++)
   {
-    amps_ReadDouble(file, &data[ai], 1);
-  });
+    int extents[9];
+
+    ptr = PFBUnpackInt(ptr, extents, 9);
+    ptr = PFBUnpackLong(ptr, &table->offsets[s]);
+
+    for (d = 0; d < 6; d++)
+    {
+      table->extents[6 * s + d] = extents[d];
+    }
+  }
+
+  tfree(index);
+
+  return TRUE;
 }
 
 
+/*--------------------------------------------------------------------------
+ * ReadPFBinaryEncodedIndex
+ *
+ * Fill the table from the block index of an encoded PFB file (see
+ * PackPFBinaryEncodedHeader), the file is positioned after the regular
+ * header.
+ *--------------------------------------------------------------------------*/
+
+static void ReadPFBinaryEncodedIndex(
+                                     FILE *           file,
+                                     char *           filename,
+                                     PFBSubgridTable *table)
+{
+  char encoding[4];
+  char           *index;
+  char           *ptr;
+  long index_size = (long)table->num_subgrids * PFB_ENCODED_ENTRY_SIZE;
+  int s, d;
+
+  if (fread(encoding, 1, sizeof(encoding), file) != sizeof(encoding))
+  {
+    amps_Printf("Error: can't read block index of file %s\n", filename);
+    exit(1);
+  }
+
+  PFBUnpackInt(encoding, &table->encoding, 1);
+
+  if (table->encoding & PFB_ENCODING_QUANTIZE)
+  {
+    char error_bound[8];
+
+    if (fread(error_bound, 1, sizeof(error_bound), file) != sizeof(error_bound))
+    {
+      amps_Printf("Error: can't read block index of file %s\n", filename);
+      exit(1);
+    }
+    PFBUnpackDouble(error_bound, &table->error_bound, 1);
+  }
+
+  /* The subfile numbers precede the entries */
+  if (table->encoding & PFB_ENCODING_SUBFILE)
+  {
+    index_size += (long)(1 + table->num_subgrids) * amps_SizeofInt;
+  }
+
+  index = talloc(char, index_size);
+
+  if (fread(index, 1, index_size, file) != (size_t)index_size)
+  {
+    amps_Printf("Error: can't read block index of file %s\n", filename);
+    exit(1);
+  }
+
+  ptr = index;
+  if (table->encoding & PFB_ENCODING_SUBFILE)
+  {
+    int num_subfiles;
+
+    table->subfiles = talloc(int, table->num_subgrids);
+
+    ptr = PFBUnpackInt(ptr, &num_subfiles, 1);
+    ptr = PFBUnpackInt(ptr, table->subfiles, table->num_subgrids);
+  }
+
+  for (s = 0; s < table->num_subgrids; s++)
+  {
+    int extents[9];
+
+    ptr = PFBUnpackInt(ptr, extents, 9);
+    ptr = PFBUnpackLong(ptr, &table->offsets[s]);
+    ptr = PFBUnpackLong(ptr, &table->sizes[s]);
+
+    for (d = 0; d < 6; d++)
+    {
+      table->extents[6 * s + d] = extents[d];
+    }
+  }
+
+  tfree(index);
+}
+
+
+/*--------------------------------------------------------------------------
+ * ReadPFBinarySubgridTable
+ *
+ * Process 0 reads the subgrid index of the file or, for files without
+ * one, the subgrid headers, seeking over the data.  The resulting table
+ * is broadcast.  The layout of the file does not need to match the
+ * process topology of the reader.
+ *--------------------------------------------------------------------------*/
+
+static PFBSubgridTable *ReadPFBinarySubgridTable(
+                                                 char *filename)
+{
+  PFBSubgridTable *table = ctalloc(PFBSubgridTable, 1);
+  amps_Invoice invoice;
+
+  int num_subgrids = 0;
+
+#ifdef PARFLOW_HAVE_MPI
+  table->fh = MPI_FILE_NULL;
+#endif
+
+  if (!amps_Rank(amps_CommWorld))
+  {
+    FILE *file;
+    char header[6 * 8 + 4 * 4];
+    char sg_header[9 * 4];
+    int s, d;
+    long offset;
+
+    if ((file = fopen(filename, "rb")) == NULL)
+    {
+      amps_Printf("Error: can't open input file %s\n", filename);
+      exit(1);
+    }
+
+    if (fread(header, 1, sizeof(header), file) != sizeof(header))
+    {
+      amps_Printf("Error: can't read header of file %s\n", filename);
+      exit(1);
+    }
+    PFBUnpackInt(header + 6 * amps_SizeofDouble + 3 * amps_SizeofInt,
+                 &num_subgrids, 1);
+
+    /* Encoded files store the negated number of subgrids */
+    if (num_subgrids < 0)
+    {
+      num_subgrids = -num_subgrids;
+      table->sizes = talloc(long, num_subgrids);
+    }
+
+    table->num_subgrids = num_subgrids;
+    table->extents = talloc(int, 6 * num_subgrids);
+    table->offsets = talloc(long, num_subgrids);
+
+    if (table->sizes)
+    {
+      ReadPFBinaryEncodedIndex(file, filename, table);
+    }
+
+    /* Without a usable index walk the subgrid headers */
+    offset = sizeof(header);
+    for (s = (table->sizes || ReadPFBinaryIndex(file, num_subgrids, table))
+             ? num_subgrids : 0;
+         s < num_subgrids; s++)
+    {
+      int extents[9];
+
+      if (fseek(file, offset, SEEK_SET) ||
+          (fread(sg_header, 1, sizeof(sg_header), file) != sizeof(sg_header)))
+      {
+        amps_Printf("Error: can't read subgrid %d of file %s\n", s, filename);
+        exit(1);
+      }
+      PFBUnpackInt(sg_header, extents, 9);
+
+      for (d = 0; d < 6; d++)
+      {
+        table->extents[6 * s + d] = extents[d];
+      }
+
+      offset += sizeof(sg_header);
+      table->offsets[s] = offset;
+      offset += (long)extents[3] * extents[4] * extents[5] * amps_SizeofDouble;
+    }
+
+    fclose(file);
+  }
+
+  invoice = amps_NewInvoice("%i%i%d", &num_subgrids, &table->encoding,
+                            &table->error_bound);
+  amps_BCast(amps_CommWorld, 0, invoice);
+  amps_FreeInvoice(invoice);
+
+  if (amps_Rank(amps_CommWorld))
+  {
+    table->extents = talloc(int, 6 * num_subgrids);
+    table->offsets = talloc(long, num_subgrids);
+    if (table->encoding != PFB_ENCODING_NONE)
+    {
+      table->sizes = talloc(long, num_subgrids);
+    }
+    if (table->encoding & PFB_ENCODING_SUBFILE)
+    {
+      table->subfiles = talloc(int, num_subgrids);
+    }
+  }
+
+  table->num_subgrids = num_subgrids;
+  table->clip_lz = INT_MIN;
+  table->clip_uz = INT_MAX;
+
+  if (num_subgrids > 0)
+  {
+    invoice = amps_NewInvoice("%*i%*l",
+                              6 * num_subgrids, table->extents,
+                              num_subgrids, table->offsets);
+    amps_BCast(amps_CommWorld, 0, invoice);
+    amps_FreeInvoice(invoice);
+
+    if (table->sizes)
+    {
+      invoice = amps_NewInvoice("%*l", num_subgrids, table->sizes);
+      amps_BCast(amps_CommWorld, 0, invoice);
+      amps_FreeInvoice(invoice);
+    }
+
+    if (table->subfiles)
+    {
+      invoice = amps_NewInvoice("%*i", num_subgrids, table->subfiles);
+      amps_BCast(amps_CommWorld, 0, invoice);
+      amps_FreeInvoice(invoice);
+    }
+  }
+
+  return table;
+}
+
+static void FreePFBinarySubgridTable(
+                                     PFBSubgridTable *table)
+{
+  if (table->file)
+  {
+    fclose(table->file);
+  }
+#ifdef PARFLOW_HAVE_MPI
+  if (table->fh != MPI_FILE_NULL)
+  {
+    MPI_File_close(&table->fh);
+  }
+#endif
+
+  tfree(table->extents);
+  tfree(table->offsets);
+  tfree(table->sizes);
+  tfree(table->subfiles);
+  tfree(table);
+}
+
+static int ComparePFBRuns(const void *a, const void *b)
+{
+  long oa = ((const PFBRun*)a)->offset;
+  long ob = ((const PFBRun*)b)->offset;
+
+  return (oa > ob) - (oa < ob);
+}
+
+
+/*--------------------------------------------------------------------------
+ * ReadPFBinaryRedistribute
+ *
+ * Read the parts of the file subgrids that overlap the subgrids owned by
+ * this process.  The x-rows of every overlap are collected, sorted by file
+ * offset and, if collective is set, read with one collective MPI-IO call
+ * using an indexed file view (otherwise, or without MPI, with plain seeks
+ * and reads).
+ *--------------------------------------------------------------------------*/
+
+static void ReadPFBinaryRedistribute(
+                                     char *           filename,
+                                     Vector *         v,
+                                     PFBSubgridTable *table,
+                                     int              collective)
+{
+  Grid           *grid = VectorGrid(v);
+  SubgridArray   *subgrids = GridSubgrids(grid);
+  Subgrid        *subgrid;
+  Subvector      *subvector;
+
+  PFBRun         *runs = NULL;
+  int num_runs = 0;
+  int max_runs = 0;
+
+  int g, s, j, k, r;
+  long size = 0;
+  char           *buffer;
+  char           *ptr;
+
+  /* Collect the x-rows to read */
+  ForSubgridI(g, subgrids)
+  {
+    subgrid = SubgridArraySubgrid(subgrids, g);
+    subvector = VectorSubvector(v, g);
+
+    for (s = 0; s < table->num_subgrids; s++)
+    {
+      int *ext = &table->extents[6 * s];
+
+      int lx = pfmax(SubgridIX(subgrid), ext[0]);
+      int ly = pfmax(SubgridIY(subgrid), ext[1]);
+      int lz = pfmax(pfmax(SubgridIZ(subgrid), ext[2]), table->clip_lz);
+      int ux = pfmin(SubgridIX(subgrid) + SubgridNX(subgrid), ext[0] + ext[3]);
+      int uy = pfmin(SubgridIY(subgrid) + SubgridNY(subgrid), ext[1] + ext[4]);
+      int uz = pfmin(pfmin(SubgridIZ(subgrid) + SubgridNZ(subgrid), ext[2] + ext[5]),
+                     table->clip_uz);
+
+      if ((lx >= ux) || (ly >= uy) || (lz >= uz))
+        continue;
+
+      for (k = lz; k < uz; k++)
+      {
+        for (j = ly; j < uy; j++)
+        {
+          if (num_runs == max_runs)
+          {
+            PFBRun *tmp;
+            max_runs = pfmax(2 * max_runs, 1024);
+            tmp = talloc(PFBRun, max_runs);
+            if (num_runs)
+            {
+              memcpy(tmp, runs, num_runs * sizeof(PFBRun));
+            }
+            tfree(runs);
+            runs = tmp;
+          }
+
+          runs[num_runs].offset = table->offsets[s] +
+                                  ((((long)(k - ext[2]) * ext[4] + (j - ext[1]))
+                                    * ext[3]) + (lx - ext[0])) * amps_SizeofDouble;
+          runs[num_runs].len = ux - lx;
+          runs[num_runs].data = SubvectorElt(subvector, lx, j, k);
+          size += (long)(ux - lx) * amps_SizeofDouble;
+          num_runs++;
+        }
+      }
+    }
+  }
+
+  /* File views require monotonically increasing displacements */
+  if (num_runs > 1)
+  {
+    qsort(runs, num_runs, sizeof(PFBRun), ComparePFBRuns);
+  }
+
+  buffer = talloc(char, size);
+
+#ifdef PARFLOW_HAVE_MPI
+  if (collective)
+  {
+    MPI_File fh;
+    MPI_Info info;
+    MPI_Status status;
+    MPI_Datatype filetype;
+    MPI_Aint     *displs = NULL;
+    int          *lens = NULL;
+    int num_blocks = 0;
+
+    /* Largest single read, keeps counts within int for MPI */
+    long max_chunk = 1L << 30;
+    long num_chunks, max_num_chunks, chunk, offset;
+
+    /* Merge runs that are adjacent in the file */
+    if (num_runs)
+    {
+      displs = talloc(MPI_Aint, num_runs);
+      lens = talloc(int, num_runs);
+    }
+
+    for (r = 0; r < num_runs; r++)
+    {
+      int bytes = runs[r].len * amps_SizeofDouble;
+      if (num_blocks &&
+          (displs[num_blocks - 1] + lens[num_blocks - 1] == runs[r].offset) &&
+          (lens[num_blocks - 1] <= INT_MAX - bytes))
+      {
+        lens[num_blocks - 1] += bytes;
+      }
+      else
+      {
+        displs[num_blocks] = runs[r].offset;
+        lens[num_blocks] = bytes;
+        num_blocks++;
+      }
+    }
+
+    MPI_Info_create(&info);
+    MPI_Info_set(info, "romio_cb_read", "enable");
+
+    if (table->fh != MPI_FILE_NULL)
+    {
+      fh = table->fh;
+    }
+    else if (MPI_File_open(amps_CommWorld, filename, MPI_MODE_RDONLY, info, &fh)
+             != MPI_SUCCESS)
+    {
+      amps_Printf("Error: can't open input file %s\n", filename);
+      exit(1);
+    }
+
+    MPI_Type_create_hindexed(num_blocks, lens, displs, MPI_BYTE, &filetype);
+    MPI_Type_commit(&filetype);
+
+    MPI_File_set_view(fh, 0, MPI_BYTE, filetype, "native", info);
+
+    /* Collective reads must be matched on every rank */
+    num_chunks = (size + max_chunk - 1) / max_chunk;
+    MPI_Allreduce(&num_chunks, &max_num_chunks, 1, MPI_LONG, MPI_MAX, amps_CommWorld);
+
+    for (chunk = 0, offset = 0; chunk < max_num_chunks; chunk++)
+    {
+      int count = (int)pfmin(max_chunk, size - offset);
+      MPI_File_read_all(fh, buffer + offset, count, MPI_BYTE, &status);
+      offset += count;
+    }
+
+    if (fh != table->fh)
+    {
+      MPI_File_close(&fh);
+    }
+    MPI_Type_free(&filetype);
+    MPI_Info_free(&info);
+
+    tfree(displs);
+    tfree(lens);
+  }
+  else
+#else
+  PF_UNUSED(collective);
+#endif
+  {
+    FILE *file = table->file;
+
+    if (!file && ((file = fopen(filename, "rb")) == NULL))
+    {
+      amps_Printf("Error: can't open input file %s\n", filename);
+      exit(1);
+    }
+
+    ptr = buffer;
+    for (r = 0; r < num_runs; r++)
+    {
+      size_t bytes = (size_t)runs[r].len * amps_SizeofDouble;
+      if (fseek(file, runs[r].offset, SEEK_SET) ||
+          (fread(ptr, 1, bytes, file) != bytes))
+      {
+        amps_Printf("Error: can't read data from file %s\n", filename);
+        exit(1);
+      }
+      ptr += bytes;
+    }
+
+    if (file != table->file)
+    {
+      fclose(file);
+    }
+  }
+
+  ptr = buffer;
+  for (r = 0; r < num_runs; r++)
+  {
+    ptr = PFBUnpackDouble(ptr, runs[r].data, runs[r].len);
+  }
+
+  tfree(buffer);
+  tfree(runs);
+}
+
+
+/*--------------------------------------------------------------------------
+ * ReadPFBinaryEncoded
+ *
+ * Read an encoded PFB file.  The blocks can only be decoded as a whole,
+ * so every process reads and decodes the blocks of the file subgrids
+ * that overlap its own subgrids and copies the overlapping x-rows.  The
+ * blocks of subfiled files are read from the subfiles.
+ *--------------------------------------------------------------------------*/
+
+static void ReadPFBinaryEncoded(
+                                char *           filename,
+                                Vector *         v,
+                                PFBSubgridTable *table)
+{
+  Grid           *grid = VectorGrid(v);
+  SubgridArray   *subgrids = GridSubgrids(grid);
+  Subgrid        *subgrid;
+  Subvector      *subvector;
+
+  FILE           *file = NULL;
+  int file_subfile = -1;
+  char           *block;
+  double         *values;
+
+  int lx, ly, lz, ux, uy, uz;
+  int g, s, j, k;
+
+  for (s = 0; s < table->num_subgrids; s++)
+  {
+    int *ext = &table->extents[6 * s];
+    long n = (long)ext[3] * ext[4] * ext[5];
+
+    values = NULL;
+
+    ForSubgridI(g, subgrids)
+    {
+      subgrid = SubgridArraySubgrid(subgrids, g);
+      subvector = VectorSubvector(v, g);
+
+      lx = pfmax(SubgridIX(subgrid), ext[0]);
+      ly = pfmax(SubgridIY(subgrid), ext[1]);
+      lz = pfmax(pfmax(SubgridIZ(subgrid), ext[2]), table->clip_lz);
+      ux = pfmin(SubgridIX(subgrid) + SubgridNX(subgrid), ext[0] + ext[3]);
+      uy = pfmin(SubgridIY(subgrid) + SubgridNY(subgrid), ext[1] + ext[4]);
+      uz = pfmin(pfmin(SubgridIZ(subgrid) + SubgridNZ(subgrid), ext[2] + ext[5]),
+                 table->clip_uz);
+
+      if ((lx >= ux) || (ly >= uy) || (lz >= uz))
+        continue;
+
+      /* Decode the block on first use */
+      if (!values)
+      {
+        if (table->subfiles && file && (table->subfiles[s] != file_subfile))
+        {
+          fclose(file);
+          file = NULL;
+        }
+
+        if (!file)
+        {
+          char subfile_name[MAXPATHLEN];
+          char *name = filename;
+
+          if (table->subfiles)
+          {
+            file_subfile = table->subfiles[s];
+            sprintf(subfile_name, PFB_SUBFILE_NAME, filename, file_subfile);
+            name = subfile_name;
+          }
+          else
+          {
+            file = table->file;
+          }
+
+          if (!file && ((file = fopen(name, "rb")) == NULL))
+          {
+            amps_Printf("Error: can't open input file %s\n", name);
+            exit(1);
+          }
+        }
+
+        block = talloc(char, table->sizes[s]);
+        if (fseek(file, table->offsets[s], SEEK_SET) ||
+            (fread(block, 1, table->sizes[s], file) != (size_t)table->sizes[s]))
+        {
+          amps_Printf("Error: can't read data from file %s\n", filename);
+          exit(1);
+        }
+
+        values = talloc(double, n);
+        UnpackPFBinaryEncodedBlock(block, table->sizes[s], values, n,
+                                   table->encoding, table->error_bound);
+        tfree(block);
+      }
+
+      for (k = lz; k < uz; k++)
+      {
+        for (j = ly; j < uy; j++)
+        {
+          memcpy(SubvectorElt(subvector, lx, j, k),
+                 &values[(((long)(k - ext[2]) * ext[4] + (j - ext[1])) * ext[3])
+                         + (lx - ext[0])],
+                 (size_t)(ux - lx) * sizeof(double));
+        }
+      }
+    }
+
+    tfree(values);
+  }
+
+  if (file && (file != table->file))
+  {
+    fclose(file);
+  }
+}
+
 void ReadPFBinary(
                   char *  filename,
                   Vector *v)
 {
+  int num_chars;
+
+#ifdef AMPS_SPLIT_FILE
   Grid           *grid = VectorGrid(v);
   SubgridArray   *subgrids = GridSubgrids(grid);
   Subgrid        *subgrid;
   Subvector      *subvector;
 
-  int num_chars, g;
+  int g;
   int p, P;
 
   amps_File file;
@@ -94,12 +1053,10 @@ void ReadPFBinary(
   double X, Y, Z;
   int NX, NY, NZ;
   double DX, DY, DZ;
+#endif
 
   BeginTiming(PFBTimingIndex);
 
-  p = amps_Rank(amps_CommWorld);
-  P = amps_Size(amps_CommWorld);
-
   if (((num_chars = strlen(filename)) < 4) ||
       (strcmp(".pfb", &filename[num_chars - 4])))
   {
@@ -107,12 +1064,16 @@ void ReadPFBinary(
     exit(1);
   }
 
+#ifdef AMPS_SPLIT_FILE
+  /* Each process reads the file it wrote, the layout must match */
   if ((file = amps_FFopen(amps_CommWorld, filename, "rb", 0)) == NULL)
   {
     amps_Printf("Error: can't open input file %s\n", filename);
     exit(1);
   }
 
+  p = amps_Rank(amps_CommWorld);
+
   if (p == 0)
   {
     amps_ReadDouble(file, &X, 1);
@@ -138,6 +1099,284 @@ void ReadPFBinary(
   }
 
   amps_FFclose(file);
+#else
+  /* Any subgrid layout may be read, no .dist file is needed */
+  {
+    PFBSubgridTable *table = ReadPFBinarySubgridTable(filename);
+
+    if (table->encoding != PFB_ENCODING_NONE)
+    {
+      ReadPFBinaryEncoded(filename, v, table);
+    }
+    else
+    {
+      ReadPFBinaryRedistribute(filename, v, table, TRUE);
+    }
+
+    FreePFBinarySubgridTable(table);
+  }
+#endif
+
+  EndTiming(PFBTimingIndex);
+}
+
+
+/*--------------------------------------------------------------------------
+ * PFBinaryTableNZ
+ *
+ * Number of z layers of the file described by table.
+ *--------------------------------------------------------------------------*/
+
+static int PFBinaryTableNZ(
+                           PFBSubgridTable *table)
+{
+  int file_nz = 0;
+  int s;
+
+  for (s = 0; s < table->num_subgrids; s++)
+  {
+    file_nz = pfmax(file_nz, table->extents[6 * s + 2] + table->extents[6 * s + 5]);
+  }
+
+  return file_nz;
+}
+
+
+/*--------------------------------------------------------------------------
+ * OpenPFBinarySlices, ReadPFBinarySlice, ClosePFBinarySlices
+ *
+ * Read the slices of a time-stacked PFB file.  The file holds the fields
+ * of consecutive times stacked in z, slice n is made of the z layers
+ * n * NZ to (n + 1) * NZ - 1 where NZ is the number of layers of the
+ * domain.  OpenPFBinarySlices reads the layout of the file and keeps the
+ * file open, so reading a slice only seeks to its data.  All three must
+ * be called by all ranks.
+ *--------------------------------------------------------------------------*/
+
+PFBSubgridTable *OpenPFBinarySlices(
+                                    char *filename)
+{
+#ifdef AMPS_SPLIT_FILE
+  amps_Printf("Error: time-stacked file %s can't be read with split AMPS files\n",
+              filename);
+  exit(1);
+  return NULL;
+#else
+  PFBSubgridTable *table;
+
+  BeginTiming(PFBTimingIndex);
+
+  table = ReadPFBinarySubgridTable(filename);
+
+#ifdef PARFLOW_HAVE_MPI
+  if (table->encoding == PFB_ENCODING_NONE)
+  {
+    if (MPI_File_open(amps_CommWorld, filename, MPI_MODE_RDONLY,
+                      MPI_INFO_NULL, &table->fh) != MPI_SUCCESS)
+    {
+      amps_Printf("Error: can't open input file %s\n", filename);
+      exit(1);
+    }
+  }
+  else
+#endif
+  if (!table->subfiles && ((table->file = fopen(filename, "rb")) == NULL))
+  {
+    amps_Printf("Error: can't open input file %s\n", filename);
+    exit(1);
+  }
+
+  EndTiming(PFBTimingIndex);
+
+  return table;
+#endif
+}
+
+void ReadPFBinarySlice(
+                       PFBSubgridTable *table,
+                       char *           filename,
+                       Vector *         v,
+                       int              slice)
+{
+  int nz = BackgroundNZ(GlobalsBackground);
+  int s;
+
+  BeginTiming(PFBTimingIndex);
+
+  if ((slice < 0) || ((slice + 1) * nz > PFBinaryTableNZ(table)))
+  {
+    amps_Printf("Error: file %s has no time slice %d\n", filename, slice);
+    exit(1);
+  }
+
+  /* Move the slice to the z layers of the domain for the read */
+  for (s = 0; s < table->num_subgrids; s++)
+  {
+    table->extents[6 * s + 2] -= slice * nz;
+  }
+
+  if (table->encoding != PFB_ENCODING_NONE)
+  {
+    ReadPFBinaryEncoded(filename, v, table);
+  }
+  else
+  {
+    ReadPFBinaryRedistribute(filename, v, table, TRUE);
+  }
+
+  for (s = 0; s < table->num_subgrids; s++)
+  {
+    table->extents[6 * s + 2] += slice * nz;
+  }
+
+  EndTiming(PFBTimingIndex);
+}
+
+void ClosePFBinarySlices(
+                         PFBSubgridTable *table)
+{
+  FreePFBinarySubgridTable(table);
+}
+
+
+/*--------------------------------------------------------------------------
+ * ReadPFBinaryNumSlices
+ *
+ * Number of time slices of a time-stacked PFB file, see ReadPFBinarySlice.
+ * Must be called by all ranks.
+ *--------------------------------------------------------------------------*/
+
+int ReadPFBinaryNumSlices(
+                          char *filename)
+{
+  PFBSubgridTable *table;
+  int num_slices;
+
+  table = ReadPFBinarySubgridTable(filename);
+  num_slices = PFBinaryTableNZ(table) / BackgroundNZ(GlobalsBackground);
+  FreePFBinarySubgridTable(table);
+
+  return num_slices;
+}
+
+/*--------------------------------------------------------------------------
+ * StartReadPFBinary, FinishReadPFBinary
+ *
+ * Read the num_z z layers of a PFB file starting at file_z into the z
+ * layers of v starting at vector_z.  The layout of the file is read by
+ * StartReadPFBinary, which must be called by all ranks; the data is read
+ * by the background reader if it is running and v must not be used
+ * before FinishReadPFBinary returns.  StartReadPFBinary returns NULL if
+ * the file does not exist.
+ *--------------------------------------------------------------------------*/
+
+struct _PFBRead {
+  char filename[MAXPATHLEN];
+  Vector          *v;
+  PFBSubgridTable *table;
+  int collective;
+  long ticket;
+};
+
+static void ReadPFBinaryLayers(void *data)
+{
+  PFBRead *read = (PFBRead*)data;
+
+  if (read->table->encoding != PFB_ENCODING_NONE)
+  {
+    ReadPFBinaryEncoded(read->filename, read->v, read->table);
+  }
+  else
+  {
+    ReadPFBinaryRedistribute(read->filename, read->v, read->table,
+                             read->collective);
+  }
+}
+
+PFBRead *StartReadPFBinary(
+                           char *  filename,
+                           Vector *v,
+                           int     file_z,
+                           int     vector_z,
+                           int     num_z)
+{
+#ifdef AMPS_SPLIT_FILE
+  PF_UNUSED(v);
+  PF_UNUSED(file_z);
+  PF_UNUSED(vector_z);
+  PF_UNUSED(num_z);
+  amps_Printf("Error: file %s can't be read ahead with split AMPS files\n",
+              filename);
+  exit(1);
+  return NULL;
+#else
+  PFBRead *read;
+  amps_Invoice invoice;
+
+  int exists = 0;
+  int s;
+
+  BeginTiming(PFBTimingIndex);
+
+  /* Decide on one rank so all ranks take the same path */
+  if (!amps_Rank(amps_CommWorld))
+  {
+    FILE *file = fopen(filename, "rb");
+
+    if (file)
+    {
+      exists = 1;
+      fclose(file);
+    }
+  }
+
+  invoice = amps_NewInvoice("%i", &exists);
+  amps_BCast(amps_CommWorld, 0, invoice);
+  amps_FreeInvoice(invoice);
+
+  if (!exists)
+  {
+    EndTiming(PFBTimingIndex);
+    return NULL;
+  }
+
+  read = talloc(PFBRead, 1);
+  strncpy(read->filename, filename, MAXPATHLEN - 1);
+  read->filename[MAXPATHLEN - 1] = '\0';
+  read->v = v;
+  read->table = ReadPFBinarySubgridTable(filename);
+  read->collective = !BackgroundReaderActive();
+
+  /* Move the layers to the z layers of the vector */
+  for (s = 0; s < read->table->num_subgrids; s++)
+  {
+    read->table->extents[6 * s + 2] += vector_z - file_z;
+  }
+  read->table->clip_lz = vector_z;
+  read->table->clip_uz = vector_z + num_z;
+
+  read->ticket = BackgroundReaderSubmit(ReadPFBinaryLayers, read);
+
+  EndTiming(PFBTimingIndex);
+
+  return read;
+#endif
+}
+
+void FinishReadPFBinary(
+                        PFBRead *read)
+{
+  if (read == NULL)
+  {
+    return;
+  }
+
+  BeginTiming(PFBTimingIndex);
+
+  BackgroundReaderWait(read->ticket);
+
+  FreePFBinarySubgridTable(read->table);
+  tfree(read);
 
   EndTiming(PFBTimingIndex);
 }
@@ -103,6 +103,187 @@ NewSolver()
     NA_FreeNameArray(switch_na);
   }
 
+  {
+    NameArray switch_na;
+    int queue_depth;
+    int subfile_ranks;
+
+    /* Order matches the PFB_WRITER_* values */
+    switch_na = NA_NewNameArray("AMPS MPIIO Background Subfile");
+    sprintf(key, "PFB.Writer");
+    switch_name = GetStringDefault(key, "AMPS");
+    GlobalsPFBWriter = NA_NameToIndex(switch_na, switch_name);
+    if (GlobalsPFBWriter < 0)
+    {
+      InputError("Error: Invalid value <%s> for key <%s>\n", switch_name,
+                 key);
+    }
+    NA_FreeNameArray(switch_na);
+
+#if !defined(PARFLOW_HAVE_MPI) || defined(AMPS_SPLIT_FILE)
+    if (GlobalsPFBWriter == PFB_WRITER_MPIIO)
+    {
+      if (!amps_Rank(amps_CommWorld))
+        amps_Printf("Warning: PFB.Writer MPIIO requires MPI and single file AMPS I/O; using AMPS writer\n");
+      GlobalsPFBWriter = PFB_WRITER_AMPS;
+    }
+#endif
+
+#if !defined(PARFLOW_HAVE_MPI) || defined(AMPS_SPLIT_FILE)
+    if (GlobalsPFBWriter == PFB_WRITER_SUBFILE)
+    {
+      if (!amps_Rank(amps_CommWorld))
+        amps_Printf("Warning: PFB.Writer Subfile requires MPI and single file AMPS I/O; using AMPS writer\n");
+      GlobalsPFBWriter = PFB_WRITER_AMPS;
+    }
+#endif
+
+#if !defined(PARFLOW_HAVE_PTHREADS) || defined(AMPS_SPLIT_FILE)
+    if (GlobalsPFBWriter == PFB_WRITER_BACKGROUND)
+    {
+      if (!amps_Rank(amps_CommWorld))
+        amps_Printf("Warning: PFB.Writer Background requires threads and single file AMPS I/O; using AMPS writer\n");
+      GlobalsPFBWriter = PFB_WRITER_AMPS;
+    }
+#endif
+
+    sprintf(key, "PFB.Writer.QueueDepth");
+    queue_depth = GetIntDefault(key, 2);
+    if (queue_depth < 1)
+    {
+      InputError("Error: Invalid value <%s> for key <%s>\n",
+                 GetString(key), key);
+    }
+
+    sprintf(key, "PFB.Writer.SubfileRanks");
+    subfile_ranks = GetIntDefault(key, 0);
+    if (subfile_ranks < 0)
+    {
+      InputError("Error: Invalid value <%s> for key <%s>\n",
+                 GetString(key), key);
+    }
+
+    /* With I/O servers PFB output is always shipped to them */
+    if (GlobalsNumIOServers > 0)
+    {
+      GlobalsPFBWriter = PFB_WRITER_IOSERVER;
+    }
+
+    if (GlobalsPFBWriter == PFB_WRITER_BACKGROUND)
+    {
+      NewBackgroundWriter(queue_depth);
+    }
+
+    if (GlobalsPFBWriter == PFB_WRITER_SUBFILE)
+    {
+      NewSubfileWriter(subfile_ranks);
+    }
+
+    switch_na = NA_NewNameArray("False True");
+    sprintf(key, "PFB.Index");
+    switch_name = GetStringDefault(key, "False");
+    GlobalsPFBIndex = NA_NameToIndex(switch_na, switch_name);
+    if (GlobalsPFBIndex < 0)
+    {
+      InputError("Error: Invalid value <%s> for key <%s>\n", switch_name,
+                 key);
+    }
+    NA_FreeNameArray(switch_na);
+
+#ifdef AMPS_SPLIT_FILE
+    if (GlobalsPFBIndex)
+    {
+      if (!amps_Rank(amps_CommWorld))
+        amps_Printf("Warning: PFB.Index is not supported with split file AMPS I/O; no index is written\n");
+      GlobalsPFBIndex = FALSE;
+    }
+#endif
+
+    /* Order matches the PFB_ENCODING_* values */
+    switch_na = NA_NewNameArray("None Deflate");
+    sprintf(key, "PFB.Compression");
+    switch_name = GetStringDefault(key, "None");
+    GlobalsPFBCompression = NA_NameToIndex(switch_na, switch_name);
+    if (GlobalsPFBCompression < 0)
+    {
+      InputError("Error: Invalid value <%s> for key <%s>\n", switch_name,
+                 key);
+    }
+    NA_FreeNameArray(switch_na);
+
+    sprintf(key, "PFB.Compression.Level");
+    GlobalsPFBCompressionLevel = GetIntDefault(key, 1);
+    if ((GlobalsPFBCompressionLevel < 1) || (GlobalsPFBCompressionLevel > 9))
+    {
+      InputError("Error: Invalid value <%s> for key <%s>\n",
+                 GetString(key), key);
+    }
+
+#if !defined(PARFLOW_HAVE_ZLIB) || defined(AMPS_SPLIT_FILE)
+    if (GlobalsPFBCompression != PFB_ENCODING_NONE)
+    {
+      if (!amps_Rank(amps_CommWorld))
+        amps_Printf("Warning: PFB.Compression requires zlib and single file AMPS I/O; PFB files are not compressed\n");
+      GlobalsPFBCompression = PFB_ENCODING_NONE;
+    }
+#endif
+  }
+
+  {
+    NameArray switch_na;
+    int exchange_method;
+    int exchange_timing;
+    int shared_memory;
+
+    /* Order matches the AMPS_EXCHANGE_* values */
+    switch_na = NA_NewNameArray("PointToPoint Neighbor Packed Shared");
+    sprintf(key, "Process.HaloExchange");
+    switch_name = GetStringDefault(key, "PointToPoint");
+    exchange_method = NA_NameToIndex(switch_na, switch_name);
+    if (exchange_method < 0)
+    {
+      InputError("Error: Invalid value <%s> for key <%s>\n", switch_name,
+                 key);
+    }
+    NA_FreeNameArray(switch_na);
+
+    switch_na = NA_NewNameArray("False True");
+    sprintf(key, "Process.HaloExchange.Timing");
+    switch_name = GetStringDefault(key, "False");
+    exchange_timing = NA_NameToIndex(switch_na, switch_name);
+    if (exchange_timing < 0)
+    {
+      InputError("Error: Invalid value <%s> for key <%s>\n", switch_name,
+                 key);
+    }
+    NA_FreeNameArray(switch_na);
+
+    sprintf(key, "Process.HaloExchange.SharedMemory");
+    shared_memory = GetIntDefault(key, 256);
+    if (shared_memory < 0)
+    {
+      InputError("Error: Invalid value <%s> for key <%s>\n",
+                 GetString(key), key);
+    }
+
+#ifdef AMPS_EXCHANGE_NEIGHBOR
+    amps_exchange_method = exchange_method;
+    amps_exchange_timing = exchange_timing;
+
+    /* Vector data allocated from here on is placed in the node arena */
+    if (exchange_method == AMPS_EXCHANGE_SHARED)
+    {
+      amps_SharedMemoryInit((long)shared_memory * 1024 * 1024);
+    }
+#else
+    if (exchange_method != 0 || exchange_timing)
+    {
+      if (!amps_Rank(amps_CommWorld))
+        amps_Printf("Warning: Process.HaloExchange options are not supported by this AMPS layer; using PointToPoint without timing\n");
+    }
+#endif
+  }
+
   /*-----------------------------------------------------------------------
    * Initialize SAMRAI hierarchy
    *-----------------------------------------------------------------------*/
@@ -169,6 +350,16 @@ FreeSolver()
     amps_ThreadLocal(Solver_module) = NULL;
   }
 
+  if (GlobalsPFBWriter == PFB_WRITER_BACKGROUND)
+  {
+    FreeBackgroundWriter();
+  }
+
+  if (GlobalsPFBWriter == PFB_WRITER_SUBFILE)
+  {
+    FreeSubfileWriter();
+  }
+
   FreeUserGrid(GlobalsUserGrid);
 
   FreeBackground(GlobalsBackground);
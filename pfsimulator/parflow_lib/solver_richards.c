@@ -52,6 +52,11 @@
 
 #define PF_CLM_MAX_ROOT_NZ 20
 
+/* Snow layers of CLM (nlevsno in clm_varpar.F90) and layers of the PFB
+ * restart vector for nz soil layers, see drv_restart_pfb.F90 */
+#define PF_CLM_NLEVSNO 5
+#define PF_CLM_RST_NZ(nz) (20 + 6 * (PF_CLM_NLEVSNO + (nz)))
+
 /*--------------------------------------------------------------------------
  * Structures
  *--------------------------------------------------------------------------*/
@@ -81,6 +86,11 @@ typedef struct {
   int print_top;                /* print top? */
   int print_velocities;         /* print velocities? */
   int print_satur;              /* print saturations? */
+  double print_press_error_bound;      /* error bound of lossy pressure output */
+  double print_velocities_error_bound; /* error bound of lossy velocity output */
+  double print_satur_error_bound;      /* error bound of lossy saturation output */
+  int print_velocities_single;  /* print velocities in single precision? */
+  int print_satur_single;       /* print saturations in single precision? */
   int print_mask;               /* print mask? */
   int print_concen;             /* print concentrations? */
   int print_wells;              /* print well data? */
@@ -89,6 +99,10 @@ typedef struct {
   int print_evaptrans_sum;      /* print evaptrans_sum? */
   int print_overland_sum;       /* print overland_sum? */
   int print_overland_bc_flux;   /* print overland outflow boundary condition flux? */
+  int print_evaptrans_single;   /* print evaptrans in single precision? */
+  int print_evaptrans_sum_single;      /* print evaptrans_sum in single precision? */
+  int print_overland_sum_single;       /* print overland_sum in single precision? */
+  int print_overland_bc_flux_single;   /* print overland bc flux in single precision? */
   int write_silo_subsurf_data;  /* write permeability/porosity? */
   int write_silo_press;         /* write pressures? */
   int write_silo_velocities;    /* write velocities? */
@@ -124,6 +138,7 @@ typedef struct {
   int evap_trans_file_transient;        /* read evap_trans as a transient file before advance richards timestep */
   char *evap_trans_filename;    /* File name for evap trans */
   int evap_trans_file_looping;  /* Loop over the flux files if we run out */
+  char *evap_trans_stack_filename;      /* Time-stacked file replacing the transient evap trans files */
 
 
 #ifdef HAVE_CLM                 /* VARIABLES FOR CLM ONLY */
@@ -141,6 +156,7 @@ typedef struct {
   int clm_metforce;             /* CLM met forcing  -- 1=uniform (default), 2=distributed, 3=distributed w/ multiple timesteps */
   int clm_metnt;                /* CLM met forcing  -- if 3D, length of time axis in each file */
   int clm_metsub;               /* Flag for met vars in subdirs of clm_metpath or all in clm_metpath */
+  int clm_metreadahead;         /* CLM met forcing  -- if 2D/3D, time steps read ahead in the background (0=read whole files) */
   char *clm_metfile;            /* File name for 1D forcing *or* base name for 2D forcing */
   char *clm_metpath;            /* Path to CLM met forcing file(s) */
   double *sw1d, *lw1d, *prcp1d, /* 1D forcing variables */
@@ -164,12 +180,14 @@ typedef struct {
   int clm_write_logs;           /* NBE: Write the processor logs for CLM or not */
   int clm_last_rst;             /* NBE: Only write/overwrite one rst file or write a lot of them */
   int clm_daily_rst;            /* NBE: Write daily RST files or hourly */
+  int clm_rst_format;           /* CLM restart files: 0 = binary per rank, 1 = single PFB */
 #endif
 
   int print_lsm_sink;           /* print LSM sink term? */
   int write_silo_CLM;           /* write CLM output as silo? */
   int write_silopmpio_CLM;      /* write CLM output as silo as PMPIO? */
   int print_CLM;                /* print CLM output as PFB? */
+  int print_CLM_single;         /* print CLM output in single precision? */
   int write_CLM_binary;         /* write binary output (**default**)? */
 
   int single_clm_file;          /* NBE: Write all CLM outputs into a single multi-layer PFB */
@@ -250,6 +268,7 @@ typedef struct {
   Vector *qflx_evap_veg;        /* evap+trans from leaves [mm/s] */
   Vector *qflx_tran_veg;        /* trans from veg [mm/s] */
   Vector *qflx_infl;            /* infiltration [mm/s] */
+  Vector *qflx_top_soil;        /* net water input into soil at top [mm/s] */
   Vector *swe_out;              /* snow water equivalent [mm] */
   Vector *t_grnd;               /* CLM soil surface temperature [K] */
   Vector *tsoil;                /* CLM soil temp, all 10 layers [K] */
@@ -276,8 +295,26 @@ typedef struct {
   Vector *displa_forc;          /* Displacement height [m]                  BH */
   Vector *veg_map_forc;         /* Vegetation map [classes 1-18]    BH */
 
+  /* Read ahead of the 2D/3D met forcing, see MetForcingReadAhead */
+  PFBRead **met_reads;          /* outstanding reads of each ring slice and variable */
+  int met_first;                /* first time step held in the ring */
+  int met_next;                 /* next time step to read */
+
+  /* Read ahead of the transient evap trans, see StartEvapTransRead */
+  Vector *evap_trans_next;      /* evap trans of the last step read */
+  PFBRead *evap_trans_read;     /* outstanding read into evap_trans_next */
+  int evap_trans_read_step;     /* time step of the last read started */
+  int evap_trans_step;          /* time step held in evap_trans_next */
+  int evap_trans_slice;         /* slice of the stacked file of the last read */
+  int evap_trans_num_slices;    /* time steps in the stacked file */
+  char evap_trans_read_file[2048];      /* file of the last read */
+
   Grid *snglclm;                /* NBE: New grid for single file CLM ouptut */
   Vector *clm_out_grid;         /* NBE - Holds multi-layer, single file output of CLM */
+
+  Grid *clm_rst_grid;           /* grid for the PFB CLM restart state */
+  Vector *clm_rst;              /* CLM restart state, one layer per value */
+  int clm_rst_read;             /* clm_rst holds a restart file read at setup */
 #endif
 
   double *time_log;
@@ -332,6 +369,309 @@ static const CLMForcingField clmForcingFields[] = {
 };
 int numForcingFields = sizeof(clmForcingFields) / sizeof(clmForcingFields[0]);
 
+#ifdef HAVE_CLM
+
+/* Variables of the 2D/3D met forcing files, the last four are only read
+ * with vegetation forcing */
+static const char* met_forcing_names[] = {
+  "DSWR", "DLWR", "APCP", "Temp", "UGRD", "VGRD", "Press", "SPFH",
+  "LAI", "SAI", "Z0M", "DISPLA"
+};
+#define MET_FORCING_NUM_VARS 12
+#define MET_FORCING_NAME_SIZE 2048
+
+/*--------------------------------------------------------------------------
+ * MetForcingFileName
+ *
+ * Name of the 2D/3D met forcing file of variable var holding time step
+ * istep, and the z layer of the time step in it.  filename holds size
+ * characters.
+ *--------------------------------------------------------------------------*/
+
+static int
+MetForcingFileName(PublicXtra *public_xtra, char *filename, int size,
+                   const char *var, int istep)
+{
+  char path[MET_FORCING_NAME_SIZE];
+  int fstart, fstop;
+  int length;
+
+  if (public_xtra->clm_metsub)
+  {
+    length = snprintf(path, sizeof(path), "%s/%s/%s.%s",
+                      public_xtra->clm_metpath, var,
+                      public_xtra->clm_metfile, var);
+  }
+  else
+  {
+    length = snprintf(path, sizeof(path), "%s/%s.%s",
+                      public_xtra->clm_metpath, public_xtra->clm_metfile, var);
+  }
+
+  if (public_xtra->clm_metforce == 2)
+  {
+    fstart = istep;
+    if (length < (int)sizeof(path))
+    {
+      length = snprintf(filename, size, "%s.%06d.pfb", path, istep);
+    }
+  }
+  else
+  {
+    fstart = istep - ((istep - 1) % public_xtra->clm_metnt);
+    fstop = fstart - 1 + public_xtra->clm_metnt;
+    if (length < (int)sizeof(path))
+    {
+      length = snprintf(filename, size, "%s.%06d_to_%06d.pfb", path,
+                        fstart, fstop);
+    }
+  }
+
+  if (length >= (int)sizeof(path) || length >= size)
+  {
+    amps_Printf("Error: met forcing file name too long for %s\n",
+                public_xtra->clm_metfile);
+    exit(1);
+  }
+
+  return istep - fstart;
+}
+
+/*--------------------------------------------------------------------------
+ * FinishMetForcingReads
+ *
+ * Wait for all outstanding met forcing reads and empty the ring.
+ *--------------------------------------------------------------------------*/
+
+static void
+FinishMetForcingReads(PublicXtra *public_xtra, InstanceXtra *instance_xtra)
+{
+  int num_reads = (public_xtra->clm_metreadahead + 1) * MET_FORCING_NUM_VARS;
+  int i;
+
+  for (i = 0; i < num_reads; i++)
+  {
+    FinishReadPFBinary(instance_xtra->met_reads[i]);
+    instance_xtra->met_reads[i] = NULL;
+  }
+
+  instance_xtra->met_first = 0;
+  instance_xtra->met_next = 0;
+}
+
+/*--------------------------------------------------------------------------
+ * MetForcingReadAhead
+ *
+ * With Solver.CLM.MetFileReadAhead the forcing vectors hold a ring of
+ * ReadAhead + 1 time steps in z instead of the MetFileNT steps of a whole
+ * 3D file.  Queue the reads of the steps up to istep + ReadAhead that are
+ * not in the ring yet, wait for the reads of istep and return the ring
+ * slice holding it.  Must be called by all ranks with consecutive steps;
+ * any other step restarts the ring.
+ *--------------------------------------------------------------------------*/
+
+static int
+MetForcingReadAhead(PublicXtra *public_xtra, InstanceXtra *instance_xtra,
+                    int istep)
+{
+  char filename[MET_FORCING_NAME_SIZE];
+  Vector *vectors[MET_FORCING_NUM_VARS];
+  int num_slices = public_xtra->clm_metreadahead + 1;
+  int num_vars = 8;
+  int slice, file_z, var;
+
+  vectors[0] = instance_xtra->sw_forc;
+  vectors[1] = instance_xtra->lw_forc;
+  vectors[2] = instance_xtra->prcp_forc;
+  vectors[3] = instance_xtra->tas_forc;
+  vectors[4] = instance_xtra->u_forc;
+  vectors[5] = instance_xtra->v_forc;
+  vectors[6] = instance_xtra->patm_forc;
+  vectors[7] = instance_xtra->qatm_forc;
+  vectors[8] = instance_xtra->lai_forc;
+  vectors[9] = instance_xtra->sai_forc;
+  vectors[10] = instance_xtra->z0m_forc;
+  vectors[11] = instance_xtra->displa_forc;
+
+  if (public_xtra->clm_metforce == 3 && public_xtra->clm_forc_veg == 1)
+  {
+    num_vars = MET_FORCING_NUM_VARS;
+  }
+
+  if (istep < instance_xtra->met_first || istep > instance_xtra->met_next)
+  {
+    FinishMetForcingReads(public_xtra, instance_xtra);
+  }
+
+  if (instance_xtra->met_next == 0)
+  {
+    instance_xtra->met_next = istep;
+  }
+  instance_xtra->met_first = istep;
+
+  /* The slices of the steps before istep have been used */
+  while (instance_xtra->met_next < istep + num_slices)
+  {
+    slice = (instance_xtra->met_next - 1) % num_slices;
+
+    for (var = 0; var < num_vars; var++)
+    {
+      file_z = MetForcingFileName(public_xtra, filename, sizeof(filename),
+                                  met_forcing_names[var],
+                                  instance_xtra->met_next);
+      instance_xtra->met_reads[slice * MET_FORCING_NUM_VARS + var] =
+        StartReadPFBinary(filename, vectors[var], file_z, slice, 1);
+    }
+
+    instance_xtra->met_next++;
+  }
+
+  slice = (istep - 1) % num_slices;
+
+  for (var = 0; var < num_vars; var++)
+  {
+    PFBRead **read = &instance_xtra->met_reads[slice * MET_FORCING_NUM_VARS + var];
+
+    if (*read == NULL)
+    {
+      MetForcingFileName(public_xtra, filename, sizeof(filename),
+                         met_forcing_names[var], istep);
+      amps_Printf("Error: can't open input file %s\n", filename);
+      exit(1);
+    }
+
+    FinishReadPFBinary(*read);
+    *read = NULL;
+  }
+
+  return slice;
+}
+
+/*--------------------------------------------------------------------------
+ * StartEvapTransRead
+ *
+ * Start reading the transient evap trans of time step istep into
+ * evap_trans_next, in the background if the reader is running.  The step
+ * is read from its own file, looping over the files with
+ * EvapTrans.FileLooping, or from slice istep - 1 of the file given by
+ * EvapTrans.StackFileName.  A missing file is only reported when the step
+ * is needed.  Must be called by all ranks.
+ *--------------------------------------------------------------------------*/
+
+static void
+StartEvapTransRead(PublicXtra *public_xtra, InstanceXtra *instance_xtra,
+                   int istep, int *Stepcount, int *Loopcount)
+{
+  char *filename = instance_xtra->evap_trans_read_file;
+  int nz = BackgroundNZ(GlobalsBackground);
+
+  FinishReadPFBinary(instance_xtra->evap_trans_read);
+  instance_xtra->evap_trans_read = NULL;
+  instance_xtra->evap_trans_read_step = istep;
+  instance_xtra->evap_trans_step = 0;
+
+  if (strlen(public_xtra->evap_trans_stack_filename) > 0)
+  {
+    int slice = istep - 1;
+
+    if (public_xtra->evap_trans_file_looping)
+    {
+      slice %= instance_xtra->evap_trans_num_slices;
+    }
+
+    strcpy(filename, public_xtra->evap_trans_stack_filename);
+    instance_xtra->evap_trans_slice = slice;
+
+    if (slice < instance_xtra->evap_trans_num_slices)
+    {
+      instance_xtra->evap_trans_read =
+        StartReadPFBinary(filename, instance_xtra->evap_trans_next,
+                          slice * nz, 0, nz);
+    }
+    return;
+  }
+
+  sprintf(filename, "%s.%05d.pfb",
+          public_xtra->evap_trans_filename, (istep - 1));
+
+  /* Added flag to give the option to loop back over the flux files
+   * This means a file doesn't have to exist for each time step - NBE */
+  if (public_xtra->evap_trans_file_looping)
+  {
+    if (access(filename, 0) != -1)
+    {
+      // file exists
+      *Stepcount += 1;
+    }
+    else
+    {
+      if (*Loopcount > *Stepcount)
+      {
+        *Loopcount = 0;
+      }
+      sprintf(filename, "%s.%05d.pfb",
+              public_xtra->evap_trans_filename, *Loopcount);
+      *Loopcount += 1;
+    }
+  }                             // NBE
+
+  instance_xtra->evap_trans_slice = -1;
+  instance_xtra->evap_trans_read =
+    StartReadPFBinary(filename, instance_xtra->evap_trans_next, 0, 0, nz);
+}
+
+/*--------------------------------------------------------------------------
+ * FinishEvapTransRead
+ *
+ * Set evap_trans to the transient evap trans of time step istep.  The
+ * step is usually read ahead by StartEvapTransRead; it is read now if it
+ * is not.  Must be called by all ranks.
+ *--------------------------------------------------------------------------*/
+
+static void
+FinishEvapTransRead(PublicXtra *public_xtra, InstanceXtra *instance_xtra,
+                    int istep, Vector *evap_trans, int *Stepcount,
+                    int *Loopcount)
+{
+  VectorUpdateCommHandle *handle;
+
+  if (instance_xtra->evap_trans_step != istep)
+  {
+    if (instance_xtra->evap_trans_read_step != istep)
+    {
+      StartEvapTransRead(public_xtra, instance_xtra, istep,
+                         Stepcount, Loopcount);
+    }
+
+    if (instance_xtra->evap_trans_read == NULL)
+    {
+      if (instance_xtra->evap_trans_slice < 0)
+      {
+        amps_Printf("Error: can't open input file %s\n",
+                    instance_xtra->evap_trans_read_file);
+      }
+      else
+      {
+        amps_Printf("Error: file %s has no time slice %d\n",
+                    instance_xtra->evap_trans_read_file,
+                    instance_xtra->evap_trans_slice);
+      }
+      exit(1);
+    }
+
+    FinishReadPFBinary(instance_xtra->evap_trans_read);
+    instance_xtra->evap_trans_read = NULL;
+    instance_xtra->evap_trans_step = istep;
+  }
+
+  Copy(instance_xtra->evap_trans_next, evap_trans);
+
+  handle = InitVectorUpdate(evap_trans, VectorUpdateAll);
+  FinalizeVectorUpdate(handle);
+}
+
+#endif
+
 void
 SetupRichards(PFModule * this_module)
 {
@@ -877,6 +1217,10 @@ SetupRichards(PFModule * this_module)
       NewVectorType(grid2d, 1, 1, vector_cell_centered_2D);
     InitVectorAll(instance_xtra->qflx_infl, 0.0);
 
+    instance_xtra->qflx_top_soil =
+      NewVectorType(grid2d, 1, 1, vector_cell_centered_2D);
+    InitVectorAll(instance_xtra->qflx_top_soil, 0.0);
+
     instance_xtra->swe_out =
       NewVectorType(grid2d, 1, 1, vector_cell_centered_2D);
     InitVectorAll(instance_xtra->swe_out, 0.0);
@@ -944,6 +1288,52 @@ SetupRichards(PFModule * this_module)
     InitVectorAll(instance_xtra->veg_map_forc, 100.0);
     /* BH: end add */
 
+    if (public_xtra->clm_metreadahead)
+    {
+      instance_xtra->met_reads =
+        ctalloc(PFBRead *, (public_xtra->clm_metreadahead + 1) * MET_FORCING_NUM_VARS);
+      instance_xtra->met_first = 0;
+      instance_xtra->met_next = 0;
+      NewBackgroundReader();
+    }
+
+    /* The PFB CLM restart file is read for any process topology before
+     * CLM is initialized, CLM uses it if drv_clmin.dat asks for a restart */
+    if (public_xtra->clm_rst_format)
+    {
+      char filename[2048];
+
+      instance_xtra->clm_rst =
+        NewVectorType(instance_xtra->clm_rst_grid, 1, 1, vector_met);
+      InitVectorAll(instance_xtra->clm_rst, 0.0);
+
+      sprintf(filename, "%s.clm_rst.%05d.pfb", GlobalsOutFileName,
+              public_xtra->clm_istep_start - 1);
+      instance_xtra->clm_rst_read = (access(filename, F_OK) == 0);
+      if (instance_xtra->clm_rst_read)
+      {
+        ReadPFBinary(filename, instance_xtra->clm_rst);
+      }
+    }
+
+    /* Transient evap trans files are read one step ahead */
+    if (public_xtra->evap_trans_file_transient
+        && !public_xtra->nc_evap_trans_file_transient)
+    {
+      instance_xtra->evap_trans_next =
+        NewVectorType(grid, 1, 1, vector_cell_centered);
+      InitVectorAll(instance_xtra->evap_trans_next, 0.0);
+      instance_xtra->evap_trans_read = NULL;
+      instance_xtra->evap_trans_read_step = 0;
+      instance_xtra->evap_trans_step = 0;
+      if (strlen(public_xtra->evap_trans_stack_filename) > 0)
+      {
+        instance_xtra->evap_trans_num_slices =
+          ReadPFBinaryNumSlices(public_xtra->evap_trans_stack_filename);
+      }
+      NewBackgroundReader();
+    }
+
     /*IMF If 1D met forcing, read forcing vars to arrays */
     if (public_xtra->clm_metforce == 1)
     {
@@ -1208,7 +1598,9 @@ SetupRichards(PFModule * this_module)
     if (print_press)
     {
       sprintf(file_postfix, "press.%05d", instance_xtra->file_number);
-      WritePFBinary(file_prefix, file_postfix, instance_xtra->pressure);
+      WritePFBinaryQuantized(file_prefix, file_postfix,
+                             instance_xtra->pressure,
+                             public_xtra->print_press_error_bound);
       any_file_dumped = 1;
 
       static const char* press_filenames[] = {
@@ -1218,6 +1610,11 @@ SetupRichards(PFModule * this_module)
                               js_outputs, file_prefix, t, 0, "pressure", "m", "cell", "subsurface",
                               sizeof(press_filenames) / sizeof(press_filenames[0]),
                               press_filenames);
+      if (public_xtra->print_press_error_bound > 0.0)
+      {
+        MetadataAddFieldErrorBound(js_outputs, "pressure",
+                                   public_xtra->print_press_error_bound);
+      }
     }
 
     if (public_xtra->write_silo_press)
@@ -1255,8 +1652,10 @@ SetupRichards(PFModule * this_module)
     if (print_satur)
     {
       sprintf(file_postfix, "satur.%05d", instance_xtra->file_number);
-      WritePFBinary(file_prefix, file_postfix,
-                    instance_xtra->saturation);
+      WritePFBinaryOutput(file_prefix, file_postfix,
+                          instance_xtra->saturation,
+                          public_xtra->print_satur_single,
+                          public_xtra->print_satur_error_bound);
       any_file_dumped = 1;
 
       static const char* satur_filenames[] = {
@@ -1266,6 +1665,11 @@ SetupRichards(PFModule * this_module)
                               js_outputs, file_prefix, t, 0, "saturation", NULL, "cell", "subsurface",
                               sizeof(satur_filenames) / sizeof(satur_filenames[0]),
                               satur_filenames);
+      if (public_xtra->print_satur_error_bound > 0.0)
+      {
+        MetadataAddFieldErrorBound(js_outputs, "saturation",
+                                   public_xtra->print_satur_error_bound);
+      }
     }
 
     if (public_xtra->write_silo_satur)
@@ -1421,16 +1825,22 @@ SetupRichards(PFModule * this_module)
     if (print_velocities)
     {
       sprintf(file_postfix, "velx.%05d", instance_xtra->file_number);
-      WritePFBinary(file_prefix, file_postfix,
-                    instance_xtra->x_velocity);
+      WritePFBinaryOutput(file_prefix, file_postfix,
+                          instance_xtra->x_velocity,
+                          public_xtra->print_velocities_single,
+                          public_xtra->print_velocities_error_bound);
 
       sprintf(file_postfix, "vely.%05d", instance_xtra->file_number);
-      WritePFBinary(file_prefix, file_postfix,
-                    instance_xtra->y_velocity);
+      WritePFBinaryOutput(file_prefix, file_postfix,
+                          instance_xtra->y_velocity,
+                          public_xtra->print_velocities_single,
+                          public_xtra->print_velocities_error_bound);
 
       sprintf(file_postfix, "velz.%05d", instance_xtra->file_number);
-      WritePFBinary(file_prefix, file_postfix,
-                    instance_xtra->z_velocity);
+      WritePFBinaryOutput(file_prefix, file_postfix,
+                          instance_xtra->z_velocity,
+                          public_xtra->print_velocities_single,
+                          public_xtra->print_velocities_error_bound);
 
       any_file_dumped = 1;
 
@@ -1441,6 +1851,11 @@ SetupRichards(PFModule * this_module)
                               js_outputs, file_prefix, t, 0, "velocity", "m/s", "cell", "subsurface",
                               sizeof(mask_filenames) / sizeof(mask_filenames[0]),
                               mask_filenames);
+      if (public_xtra->print_velocities_error_bound > 0.0)
+      {
+        MetadataAddFieldErrorBound(js_outputs, "velocity",
+                                   public_xtra->print_velocities_error_bound);
+      }
     }
 
     /*-----------------------------------------------------------------
@@ -1569,11 +1984,13 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
   Subvector *eflx_lh_tot_sub, *eflx_lwrad_out_sub, *eflx_sh_tot_sub,
     *eflx_soil_grnd_sub, *qflx_evap_tot_sub, *qflx_evap_grnd_sub,
     *qflx_evap_soi_sub, *qflx_evap_veg_sub, *qflx_tran_veg_sub,
-    *qflx_infl_sub, *swe_out_sub, *t_grnd_sub, *tsoil_sub, *irr_flag_sub,
-    *qflx_qirr_sub, *qflx_qirr_inst_sub;
+    *qflx_infl_sub, *qflx_top_soil_sub, *swe_out_sub, *t_grnd_sub, *tsoil_sub,
+    *irr_flag_sub, *qflx_qirr_sub, *qflx_qirr_inst_sub;
   double *eflx_lh, *eflx_lwrad, *eflx_sh, *eflx_grnd, *qflx_tot, *qflx_grnd,
-    *qflx_soi, *qflx_eveg, *qflx_tveg, *qflx_in, *swe, *t_g, *t_soi, *iflag,
-    *qirr, *qirr_inst;
+    *qflx_soi, *qflx_eveg, *qflx_tveg, *qflx_in, *qflx_top, *swe, *t_g, *t_soi,
+    *iflag, *qirr, *qirr_inst;
+  double *clm_rst_data;
+  int clm_rst_nz, clm_rst_write;
   int clm_file_dir_length;
 #endif
 
@@ -1800,8 +2217,14 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
           qatm = 0.0;
         }
 
+        /* Ring of time steps read ahead in the background */
+        if (public_xtra->clm_metreadahead)
+        {
+          fstep = MetForcingReadAhead(public_xtra, instance_xtra, istep);
+        }
+
         /* IMF: If 2D met forcing...read input files @ each timestep... */
-        if (public_xtra->clm_metforce == 2)
+        else if (public_xtra->clm_metforce == 2)
         {
           // Subdirectories for each variable?
           if (public_xtra->clm_metsub)
@@ -1877,7 +2300,7 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
         }                       //end if (clm_metforce==2)
 
         /* IMF: If 3D met forcing... */
-        if (public_xtra->clm_metforce == 3)
+        else if (public_xtra->clm_metforce == 3)
         {
           // Calculate z-index in forcing vars corresponding to istep
           fstep = ((istep - 1) % public_xtra->clm_metnt);               // index w/in met vars corresponding to istep
@@ -2115,7 +2538,7 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
       }
 
 
-
+      clm_rst_write = 0;
       ForSubgridI(is, GridSubgrids(grid))
       {
         double dx, dy, dz;
@@ -2151,6 +2574,8 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
         qflx_tran_veg_sub =
           VectorSubvector(instance_xtra->qflx_tran_veg, is);
         qflx_infl_sub = VectorSubvector(instance_xtra->qflx_infl, is);
+        qflx_top_soil_sub =
+          VectorSubvector(instance_xtra->qflx_top_soil, is);
         swe_out_sub = VectorSubvector(instance_xtra->swe_out, is);
         t_grnd_sub = VectorSubvector(instance_xtra->t_grnd, is);
         tsoil_sub = VectorSubvector(instance_xtra->tsoil, is);
@@ -2213,6 +2638,7 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
         qflx_eveg = SubvectorData(qflx_evap_veg_sub);
         qflx_tveg = SubvectorData(qflx_tran_veg_sub);
         qflx_in = SubvectorData(qflx_infl_sub);
+        qflx_top = SubvectorData(qflx_top_soil_sub);
         swe = SubvectorData(swe_out_sub);
         t_g = SubvectorData(t_grnd_sub);
         t_soi = SubvectorData(tsoil_sub);
@@ -2220,6 +2646,17 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
         qirr = SubvectorData(qflx_qirr_sub);
         qirr_inst = SubvectorData(qflx_qirr_inst_sub);
 
+        /* PFB restart state, packed and unpacked by CLM */
+        clm_rst_data = NULL;
+        clm_rst_nz = 0;
+        if (instance_xtra->clm_rst)
+        {
+          clm_rst_data =
+            SubvectorData(VectorSubvector(instance_xtra->clm_rst, is));
+          clm_rst_nz = PF_CLM_RST_NZ(public_xtra->clm_nz);
+        }
+        clm_rst_write = 0;
+
         /* IMF: Subvector Data -- CLM met forcings */
         // 1D Case...
         if (public_xtra->clm_metforce == 1)
@@ -2264,7 +2701,7 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
           }
         }
         // 2D Case...
-        if (public_xtra->clm_metforce == 2)
+        if (public_xtra->clm_metforce == 2 && !public_xtra->clm_metreadahead)
         {
           // Just need to grab SubvectorData's
           sw_data = SubvectorData(sw_forc_sub);
@@ -2276,8 +2713,8 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
           patm_data = SubvectorData(patm_forc_sub);
           qatm_data = SubvectorData(qatm_forc_sub);
         }
-        // 3D Case...
-        if (public_xtra->clm_metforce == 3)
+        // 3D Case, or read ahead ring of 2D/3D time steps...
+        if (public_xtra->clm_metforce == 3 || public_xtra->clm_metreadahead)
         {
           // Determine bounds of correct time slice
           x = SubvectorIX(sw_forc_sub);
@@ -2336,8 +2773,8 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
                          qatm_data, lai_data, sai_data, z0m_data,
                          displa_data, eflx_lh, eflx_lwrad, eflx_sh,
                          eflx_grnd, qflx_tot, qflx_grnd, qflx_soi,
-                         qflx_eveg, qflx_tveg, qflx_in, swe, t_g,
-                         t_soi, public_xtra->clm_dump_interval,
+                         qflx_eveg, qflx_tveg, qflx_in, qflx_top, swe,
+                         t_g, t_soi, public_xtra->clm_dump_interval,
                          public_xtra->clm_1d_out,
                          public_xtra->clm_forc_veg,
                          public_xtra->clm_file_dir,
@@ -2360,7 +2797,10 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
                          clm_next, clm_write_logs, clm_last_rst,
                          clm_daily_rst,
                          public_xtra->clm_nz,
-                         public_xtra->clm_nz);
+                         public_xtra->clm_nz,
+                         public_xtra->clm_rst_format, clm_rst_data,
+                         clm_rst_nz, instance_xtra->clm_rst_read,
+                         clm_rst_write);
 
             break;
           }
@@ -2372,6 +2812,14 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
         }                       /* switch on LSM */
       }
 
+      /* CLM packed its restart state, write it as one file for all
+       * processes, named like the binary restart files */
+      if (clm_rst_write)
+      {
+        sprintf(file_postfix, "clm_rst.%05d", clm_last_rst ? 0 : istep);
+        WritePFBinary(file_prefix, file_postfix, instance_xtra->clm_rst);
+      }
+
 
       handle = InitVectorUpdate(evap_trans, VectorUpdateAll);
       FinalizeVectorUpdate(handle);
@@ -2396,41 +2844,8 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
       }
       else if (public_xtra->evap_trans_file_transient)
       {
-        sprintf(filename, "%s.%05d.pfb",
-                public_xtra->evap_trans_filename, (istep - 1));
-        printf("%d %s %s \n", istep, filename,
-               public_xtra->evap_trans_filename);
-
-        /* Added flag to give the option to loop back over the flux files
-         * This means a file doesn't have to exist for each time step - NBE */
-        if (public_xtra->evap_trans_file_looping)
-        {
-          if (access(filename, 0) != -1)
-          {
-            // file exists
-            Stepcount += 1;
-          }
-          else
-          {
-            if (Loopcount > Stepcount)
-            {
-              Loopcount = 0;
-            }
-            sprintf(filename, "%s.%05d.pfb",
-                    public_xtra->evap_trans_filename, Loopcount);
-            //printf("Using flux file %s \n",filename);
-            Loopcount += 1;
-          }
-        }                       // NBE
-        printf("%d %s %s \n", istep, filename,
-               public_xtra->evap_trans_filename);
-
-        ReadPFBinary(filename, evap_trans);
-
-        //printf("Checking time step logging, steps = %i\n",Stepcount);
-
-        handle = InitVectorUpdate(evap_trans, VectorUpdateAll);
-        FinalizeVectorUpdate(handle);
+        FinishEvapTransRead(public_xtra, instance_xtra, istep, evap_trans,
+                            &Stepcount, &Loopcount);
       }
 
 
@@ -2440,6 +2855,14 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
       {
         istep = istep + 1;
         clm_next = 1;
+
+        /* Read the evap trans of the next step while this one is solved */
+        if (public_xtra->evap_trans_file_transient
+            && !public_xtra->nc_evap_trans_file_transient)
+        {
+          StartEvapTransRead(public_xtra, instance_xtra, istep,
+                             &Stepcount, &Loopcount);
+        }
       }                         // NBE
 
       //istep  = istep + 1;
@@ -2904,12 +3327,24 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
 
       if (public_xtra->print_press)
       {
+        /* The last pressure is the restart state and stays lossless */
+        int last_step = (t >= stop_time)
+                        || (instance_xtra->iteration_number >= max_iterations);
+
         sprintf(file_postfix, "press.%05d",
                 instance_xtra->file_number);
-        WritePFBinary(file_prefix, file_postfix,
-                      instance_xtra->pressure);
+        WritePFBinaryQuantized(file_prefix, file_postfix,
+                               instance_xtra->pressure,
+                               last_step ? 0.0 : public_xtra->print_press_error_bound);
         any_file_dumped = 1;
 
+        /* Quantized pressure can not be used to restart, keep the latest
+         * pressure exactly in one file that is overwritten at each dump */
+        if (!last_step && public_xtra->print_press_error_bound > 0.0)
+        {
+          WritePFBinary(file_prefix, "press.restart", instance_xtra->pressure);
+        }
+
         // Update with new timesteps
         MetadataAddDynamicField(
                                 js_outputs, file_prefix, t, instance_xtra->file_number,
@@ -2949,16 +3384,22 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
       if (public_xtra->print_velocities)        //jjb
       {
         sprintf(file_postfix, "velx.%05d", instance_xtra->file_number);
-        WritePFBinary(file_prefix, file_postfix,
-                      instance_xtra->x_velocity);
+        WritePFBinaryOutput(file_prefix, file_postfix,
+                            instance_xtra->x_velocity,
+                            public_xtra->print_velocities_single,
+                            public_xtra->print_velocities_error_bound);
 
         sprintf(file_postfix, "vely.%05d", instance_xtra->file_number);
-        WritePFBinary(file_prefix, file_postfix,
-                      instance_xtra->y_velocity);
+        WritePFBinaryOutput(file_prefix, file_postfix,
+                            instance_xtra->y_velocity,
+                            public_xtra->print_velocities_single,
+                            public_xtra->print_velocities_error_bound);
 
         sprintf(file_postfix, "velz.%05d", instance_xtra->file_number);
-        WritePFBinary(file_prefix, file_postfix,
-                      instance_xtra->z_velocity);
+        WritePFBinaryOutput(file_prefix, file_postfix,
+                            instance_xtra->z_velocity,
+                            public_xtra->print_velocities_single,
+                            public_xtra->print_velocities_error_bound);
         any_file_dumped = 1;
 
         // Update with new timesteps
@@ -2972,8 +3413,10 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
       {
         sprintf(file_postfix, "satur.%05d",
                 instance_xtra->file_number);
-        WritePFBinary(file_prefix, file_postfix,
-                      instance_xtra->saturation);
+        WritePFBinaryOutput(file_prefix, file_postfix,
+                            instance_xtra->saturation,
+                            public_xtra->print_satur_single,
+                            public_xtra->print_satur_error_bound);
         any_file_dumped = 1;
 
         // Update with new timesteps
@@ -3017,7 +3460,8 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
       {
         sprintf(file_postfix, "evaptrans.%05d",
                 instance_xtra->file_number);
-        WritePFBinary(file_prefix, file_postfix, evap_trans);
+        WritePFBinarySingle(file_prefix, file_postfix, evap_trans,
+                            public_xtra->print_evaptrans_single);
         any_file_dumped = 1;
 
         // Update with new timesteps
@@ -3075,7 +3519,8 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
         {
           sprintf(file_postfix, "evaptranssum.%05d",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix, evap_trans_sum);
+          WritePFBinarySingle(file_prefix, file_postfix, evap_trans_sum,
+                              public_xtra->print_evaptrans_sum_single);
           any_file_dumped = 1;
         }
 
@@ -3121,7 +3566,8 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
         {
           sprintf(file_postfix, "overlandsum.%05d",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix, overland_sum);
+          WritePFBinarySingle(file_prefix, file_postfix, overland_sum,
+                              public_xtra->print_overland_sum_single);
           any_file_dumped = 1;
         }
 
@@ -3153,8 +3599,9 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
       {
         sprintf(file_postfix, "overland_bc_flux.%05d",
                 instance_xtra->file_number);
-        WritePFBinary(file_prefix, file_postfix,
-                      instance_xtra->ovrl_bc_flx);
+        WritePFBinarySingle(file_prefix, file_postfix,
+                            instance_xtra->ovrl_bc_flx,
+                            public_xtra->print_overland_bc_flux_single);
         any_file_dumped = 1;
 
         // Update with new timesteps
@@ -3301,6 +3748,12 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
                   instance_xtra->file_number, "Infiltration");
         clm_file_dumped = 1;
 
+        sprintf(file_type, "qflx_top_soil");
+        WriteSilo(file_prefix, file_type, file_postfix,
+                  instance_xtra->qflx_top_soil, t,
+                  instance_xtra->file_number, "TopSoilFlux");
+        clm_file_dumped = 1;
+
         sprintf(file_type, "swe_out");
         WriteSilo(file_prefix, file_type, file_postfix,
                   instance_xtra->swe_out, t,
@@ -3386,6 +3839,10 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
         WriteCLMNC(file_prefix, nc_postfix, t,
                    instance_xtra->qflx_infl,
                    public_xtra->numCLMVarTimeVariant, "qflx_infl", 2);
+        WriteCLMNC(file_prefix, nc_postfix, t,
+                   instance_xtra->qflx_top_soil,
+                   public_xtra->numCLMVarTimeVariant, "qflx_top_soil",
+                   2);
         WriteCLMNC(file_prefix, nc_postfix, t, instance_xtra->swe_out,
                    public_xtra->numCLMVarTimeVariant, "swe_out", 2);
         WriteCLMNC(file_prefix, nc_postfix, t, instance_xtra->t_grnd,
@@ -3462,8 +3919,9 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
            * a different extension since PFB is hard-wired */
           sprintf(file_postfix, "clm_output.%05d.C",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix,
-                        instance_xtra->clm_out_grid);
+          WritePFBinarySingle(file_prefix, file_postfix,
+                              instance_xtra->clm_out_grid,
+                              public_xtra->print_CLM_single);
           clm_file_dumped = 1;
           // Update with new timesteps
           /* No initial call to add the field and no support for .C.pfb files in vtkParFlowMetaReader yet.
@@ -3478,80 +3936,100 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
           // Otherwise do the old output
           sprintf(file_postfix, "eflx_lh_tot.%05d",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix,
-                        instance_xtra->eflx_lh_tot);
+          WritePFBinarySingle(file_prefix, file_postfix,
+                              instance_xtra->eflx_lh_tot,
+                              public_xtra->print_CLM_single);
           clm_file_dumped = 1;
 
           sprintf(file_postfix, "eflx_lwrad_out.%05d",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix,
-                        instance_xtra->eflx_lwrad_out);
+          WritePFBinarySingle(file_prefix, file_postfix,
+                              instance_xtra->eflx_lwrad_out,
+                              public_xtra->print_CLM_single);
           clm_file_dumped = 1;
 
           sprintf(file_postfix, "eflx_sh_tot.%05d",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix,
-                        instance_xtra->eflx_sh_tot);
+          WritePFBinarySingle(file_prefix, file_postfix,
+                              instance_xtra->eflx_sh_tot,
+                              public_xtra->print_CLM_single);
           clm_file_dumped = 1;
 
           sprintf(file_postfix, "eflx_soil_grnd.%05d",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix,
-                        instance_xtra->eflx_soil_grnd);
+          WritePFBinarySingle(file_prefix, file_postfix,
+                              instance_xtra->eflx_soil_grnd,
+                              public_xtra->print_CLM_single);
           clm_file_dumped = 1;
 
           sprintf(file_postfix, "qflx_evap_tot.%05d",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix,
-                        instance_xtra->qflx_evap_tot);
+          WritePFBinarySingle(file_prefix, file_postfix,
+                              instance_xtra->qflx_evap_tot,
+                              public_xtra->print_CLM_single);
           clm_file_dumped = 1;
 
           sprintf(file_postfix, "qflx_evap_grnd.%05d",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix,
-                        instance_xtra->qflx_evap_grnd);
+          WritePFBinarySingle(file_prefix, file_postfix,
+                              instance_xtra->qflx_evap_grnd,
+                              public_xtra->print_CLM_single);
           clm_file_dumped = 1;
 
           sprintf(file_postfix, "qflx_evap_soi.%05d",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix,
-                        instance_xtra->qflx_evap_soi);
+          WritePFBinarySingle(file_prefix, file_postfix,
+                              instance_xtra->qflx_evap_soi,
+                              public_xtra->print_CLM_single);
           clm_file_dumped = 1;
 
           sprintf(file_postfix, "qflx_evap_veg.%05d",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix,
-                        instance_xtra->qflx_evap_veg);
+          WritePFBinarySingle(file_prefix, file_postfix,
+                              instance_xtra->qflx_evap_veg,
+                              public_xtra->print_CLM_single);
           clm_file_dumped = 1;
 
           sprintf(file_postfix, "qflx_tran_veg.%05d",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix,
-                        instance_xtra->qflx_tran_veg);
+          WritePFBinarySingle(file_prefix, file_postfix,
+                              instance_xtra->qflx_tran_veg,
+                              public_xtra->print_CLM_single);
           clm_file_dumped = 1;
 
           sprintf(file_postfix, "qflx_infl.%05d",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix,
-                        instance_xtra->qflx_infl);
+          WritePFBinarySingle(file_prefix, file_postfix,
+                              instance_xtra->qflx_infl,
+                              public_xtra->print_CLM_single);
+          clm_file_dumped = 1;
+
+          sprintf(file_postfix, "qflx_top_soil.%05d",
+                  instance_xtra->file_number);
+          WritePFBinarySingle(file_prefix, file_postfix,
+                              instance_xtra->qflx_top_soil,
+                              public_xtra->print_CLM_single);
           clm_file_dumped = 1;
 
           sprintf(file_postfix, "swe_out.%05d",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix,
-                        instance_xtra->swe_out);
+          WritePFBinarySingle(file_prefix, file_postfix,
+                              instance_xtra->swe_out,
+                              public_xtra->print_CLM_single);
           clm_file_dumped = 1;
 
           sprintf(file_postfix, "t_grnd.%05d",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix,
-                        instance_xtra->t_grnd);
+          WritePFBinarySingle(file_prefix, file_postfix,
+                              instance_xtra->t_grnd,
+                              public_xtra->print_CLM_single);
           clm_file_dumped = 1;
 
           sprintf(file_postfix, "t_soil.%05d",
                   instance_xtra->file_number);
-          WritePFBinary(file_prefix, file_postfix,
-                        instance_xtra->tsoil);
+          WritePFBinarySingle(file_prefix, file_postfix,
+                              instance_xtra->tsoil,
+                              public_xtra->print_CLM_single);
           clm_file_dumped = 1;
 
           // IMF: irrigation applied to surface -- spray or drip
@@ -3560,8 +4038,9 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
           {
             sprintf(file_postfix, "qflx_qirr.%05d",
                     instance_xtra->file_number);
-            WritePFBinary(file_prefix, file_postfix,
-                          instance_xtra->qflx_qirr);
+            WritePFBinarySingle(file_prefix, file_postfix,
+                                instance_xtra->qflx_qirr,
+                                public_xtra->print_CLM_single);
             clm_file_dumped = 1;
           }
 
@@ -3570,8 +4049,9 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
           {
             sprintf(file_postfix, "qflx_qirr_inst.%05d",
                     instance_xtra->file_number);
-            WritePFBinary(file_prefix, file_postfix,
-                          instance_xtra->qflx_qirr_inst);
+            WritePFBinarySingle(file_prefix, file_postfix,
+                                instance_xtra->qflx_qirr_inst,
+                                public_xtra->print_CLM_single);
             clm_file_dumped = 1;
           }
         }                       // end of multi-file output - NBE
@@ -3856,6 +4336,9 @@ TeardownRichards(PFModule * this_module)
 
   int start_count = ProblemStartCount(problem);
 
+  /* All output must be on disk before the run is considered done */
+  FlushBackgroundWriter();
+
   FinalizeMetadata(this_module, GlobalsOutFileName);
 
   FreeVector(instance_xtra->saturation);
@@ -3889,6 +4372,12 @@ TeardownRichards(PFModule * this_module)
       FreeVector(instance_xtra->clm_out_grid);
     }
 
+    if (instance_xtra->clm_rst)
+    {
+      FreeVector(instance_xtra->clm_rst);
+      instance_xtra->clm_rst = NULL;
+    }
+
     FreeVector(instance_xtra->eflx_lh_tot);
     FreeVector(instance_xtra->eflx_lwrad_out);
     FreeVector(instance_xtra->eflx_sh_tot);
@@ -3899,10 +4388,27 @@ TeardownRichards(PFModule * this_module)
     FreeVector(instance_xtra->qflx_evap_veg);
     FreeVector(instance_xtra->qflx_tran_veg);
     FreeVector(instance_xtra->qflx_infl);
+    FreeVector(instance_xtra->qflx_top_soil);
     FreeVector(instance_xtra->swe_out);
     FreeVector(instance_xtra->t_grnd);
     FreeVector(instance_xtra->tsoil);
 
+    /* Nothing may be read into the forcing vectors any more */
+    if (public_xtra->clm_metreadahead)
+    {
+      FinishMetForcingReads(public_xtra, instance_xtra);
+      tfree(instance_xtra->met_reads);
+      FreeBackgroundReader();
+    }
+
+    if (instance_xtra->evap_trans_next)
+    {
+      FinishReadPFBinary(instance_xtra->evap_trans_read);
+      FreeVector(instance_xtra->evap_trans_next);
+      instance_xtra->evap_trans_next = NULL;
+      FreeBackgroundReader();
+    }
+
     /*IMF Initialize variables for CLM irrigation output */
     FreeVector(instance_xtra->irr_flag);
     FreeVector(instance_xtra->qflx_qirr);
@@ -4154,7 +4660,10 @@ SolverRichardsInitInstanceXtra()
     subgrid = SubgridArraySubgrid(all_subgrids, i);
     new_subgrid = DuplicateSubgrid(subgrid);
     SubgridIZ(new_subgrid) = 0;
-    SubgridNZ(new_subgrid) = public_xtra->clm_metnt;
+    /* With read ahead only the ring of time steps is held */
+    SubgridNZ(new_subgrid) = public_xtra->clm_metreadahead
+                             ? public_xtra->clm_metreadahead + 1
+                             : public_xtra->clm_metnt;
     AppendSubgrid(new_subgrid, new_all_subgrids);
   }
   new_subgrids = GetGridSubgrids(new_all_subgrids);
@@ -4182,6 +4691,24 @@ SolverRichardsInitInstanceXtra()
     (instance_xtra->snglclm) = snglclm;
   }
 
+  /* Grid for the PFB CLM restart state, one layer per restart value */
+  if (public_xtra->clm_rst_format)
+  {
+    all_subgrids = GridAllSubgrids(grid);
+    new_all_subgrids = NewSubgridArray();
+    ForSubgridI(i, all_subgrids)
+    {
+      subgrid = SubgridArraySubgrid(all_subgrids, i);
+      new_subgrid = DuplicateSubgrid(subgrid);
+      SubgridIZ(new_subgrid) = 0;
+      SubgridNZ(new_subgrid) = PF_CLM_RST_NZ(public_xtra->clm_nz);
+      AppendSubgrid(new_subgrid, new_all_subgrids);
+    }
+    new_subgrids = GetGridSubgrids(new_all_subgrids);
+    instance_xtra->clm_rst_grid = NewGrid(new_subgrids, new_all_subgrids);
+    CreateComputePkgs(instance_xtra->clm_rst_grid);
+  }
+
   /* IMF New grid for Tsoil (nx*ny*10) */
   all_subgrids = GridAllSubgrids(grid);
   new_all_subgrids = NewSubgridArray();
@@ -4424,6 +4951,7 @@ SolverRichardsFreeInstanceXtra()
     FreeGrid((instance_xtra->gridTs));
 
     FreeGrid((instance_xtra->snglclm));         //NBE
+    FreeGrid((instance_xtra->clm_rst_grid));
 #endif
 
     tfree(instance_xtra);
@@ -4455,6 +4983,7 @@ SolverRichardsNewPublicXtra(char *name)
   NameArray irrtype_switch_na;
   NameArray irrcycle_switch_na;
   NameArray irrthresholdtype_switch_na;
+  NameArray rst_format_switch_na;
 #endif
 
   switch_na = NA_NewNameArray("False True");
@@ -4653,6 +5182,20 @@ SolverRichardsNewPublicXtra(char *name)
   }
   public_xtra->clm_daily_rst = switch_value;
 
+  /* Restart files as one binary file per rank written by CLM or as a
+   * single PFB file written by ParFlow */
+  rst_format_switch_na = NA_NewNameArray("Binary PFB");
+  sprintf(key, "%s.CLM.RestartFormat", name);
+  switch_name = GetStringDefault(key, "Binary");
+  switch_value = NA_NameToIndex(rst_format_switch_na, switch_name);
+  if (switch_value < 0)
+  {
+    InputError("Error: invalid value <%s> for key <%s>\n",
+               switch_name, key);
+  }
+  public_xtra->clm_rst_format = switch_value;
+  NA_FreeNameArray(rst_format_switch_na);
+
 
   // -------------------
 
@@ -4753,6 +5296,16 @@ SolverRichardsNewPublicXtra(char *name)
   }
   public_xtra->print_CLM = switch_value;
 
+  sprintf(key, "%s.PrintCLM.SinglePrecision", name);
+  switch_name = GetStringDefault(key, "False");
+  switch_value = NA_NameToIndex(switch_na, switch_name);
+  if (switch_value < 0)
+  {
+    InputError("Error: invalid value <%s> for key <%s>\n",
+               switch_name, key);
+  }
+  public_xtra->print_CLM_single = switch_value;
+
   /* IMF Write CLM Binary (default=True) */
   sprintf(key, "%s.WriteCLMBinary", name);
   switch_name = GetStringDefault(key, "True");
@@ -4848,6 +5401,19 @@ SolverRichardsNewPublicXtra(char *name)
   sprintf(key, "%s.CLM.MetFileNT", name);
   public_xtra->clm_metnt = GetIntDefault(key, 1);
 
+  /* Time steps of 2D/3D met forcing read ahead in the background */
+  sprintf(key, "%s.CLM.MetFileReadAhead", name);
+  public_xtra->clm_metreadahead = GetIntDefault(key, 0);
+  if (public_xtra->clm_metreadahead < 0)
+  {
+    InputError("Error: Invalid value <%s> for key <%s>\n",
+               GetString(key), key);
+  }
+  if (public_xtra->clm_metforce != 2 && public_xtra->clm_metforce != 3)
+  {
+    public_xtra->clm_metreadahead = 0;
+  }
+
   /* IMF added irrigation type, rate, value keys for irrigating in CLM */
   /* IrrigationType -- none, Drip, Spray, Instant (default == none) */
   irrtype_switch_na = NA_NewNameArray("none Spray Drip Instant");
@@ -5097,6 +5663,14 @@ SolverRichardsNewPublicXtra(char *name)
   }
   public_xtra->print_press = switch_value;
 
+  sprintf(key, "%s.PrintPressure.ErrorBound", name);
+  public_xtra->print_press_error_bound = GetDoubleDefault(key, 0.0);
+  if (public_xtra->print_press_error_bound < 0.0)
+  {
+    InputError("Error: Invalid value <%s> for key <%s>\n",
+               GetString(key), key);
+  }
+
   sprintf(key, "%s.PrintVelocities", name);
   switch_name = GetStringDefault(key, "False");
   switch_value = NA_NameToIndex(switch_na, switch_name);
@@ -5107,6 +5681,29 @@ SolverRichardsNewPublicXtra(char *name)
   }
   public_xtra->print_velocities = switch_value;
 
+  sprintf(key, "%s.PrintVelocities.ErrorBound", name);
+  public_xtra->print_velocities_error_bound = GetDoubleDefault(key, 0.0);
+  if (public_xtra->print_velocities_error_bound < 0.0)
+  {
+    InputError("Error: Invalid value <%s> for key <%s>\n",
+               GetString(key), key);
+  }
+
+  sprintf(key, "%s.PrintVelocities.SinglePrecision", name);
+  switch_name = GetStringDefault(key, "False");
+  switch_value = NA_NameToIndex(switch_na, switch_name);
+  if (switch_value < 0)
+  {
+    InputError("Error: invalid print switch value <%s> for key <%s>\n",
+               switch_name, key);
+  }
+  public_xtra->print_velocities_single = switch_value;
+  if (public_xtra->print_velocities_single && (public_xtra->print_velocities_error_bound > 0.0))
+  {
+    InputError("Error: <%s.PrintVelocities.SinglePrecision> can not be combined with <%s.PrintVelocities.ErrorBound>\n",
+               name, name);
+  }
+
   sprintf(key, "%s.PrintSaturation", name);
   switch_name = GetStringDefault(key, "True");
   switch_value = NA_NameToIndex(switch_na, switch_name);
@@ -5117,6 +5714,29 @@ SolverRichardsNewPublicXtra(char *name)
   }
   public_xtra->print_satur = switch_value;
 
+  sprintf(key, "%s.PrintSaturation.ErrorBound", name);
+  public_xtra->print_satur_error_bound = GetDoubleDefault(key, 0.0);
+  if (public_xtra->print_satur_error_bound < 0.0)
+  {
+    InputError("Error: Invalid value <%s> for key <%s>\n",
+               GetString(key), key);
+  }
+
+  sprintf(key, "%s.PrintSaturation.SinglePrecision", name);
+  switch_name = GetStringDefault(key, "False");
+  switch_value = NA_NameToIndex(switch_na, switch_name);
+  if (switch_value < 0)
+  {
+    InputError("Error: invalid print switch value <%s> for key <%s>\n",
+               switch_name, key);
+  }
+  public_xtra->print_satur_single = switch_value;
+  if (public_xtra->print_satur_single && (public_xtra->print_satur_error_bound > 0.0))
+  {
+    InputError("Error: <%s.PrintSaturation.SinglePrecision> can not be combined with <%s.PrintSaturation.ErrorBound>\n",
+               name, name);
+  }
+
   sprintf(key, "%s.PrintConcentration", name);
   switch_name = GetStringDefault(key, "True");
   switch_value = NA_NameToIndex(switch_na, switch_name);
@@ -5157,6 +5777,16 @@ SolverRichardsNewPublicXtra(char *name)
   }
   public_xtra->print_evaptrans = switch_value;
 
+  sprintf(key, "%s.PrintEvapTrans.SinglePrecision", name);
+  switch_name = GetStringDefault(key, "False");
+  switch_value = NA_NameToIndex(switch_na, switch_name);
+  if (switch_value < 0)
+  {
+    InputError("Error: invalid print switch value <%s> for key <%s>\n",
+               switch_name, key);
+  }
+  public_xtra->print_evaptrans_single = switch_value;
+
   sprintf(key, "%s.PrintEvapTransSum", name);
   switch_name = GetStringDefault(key, "False");
   switch_value = NA_NameToIndex(switch_na, switch_name);
@@ -5167,6 +5797,16 @@ SolverRichardsNewPublicXtra(char *name)
   }
   public_xtra->print_evaptrans_sum = switch_value;
 
+  sprintf(key, "%s.PrintEvapTransSum.SinglePrecision", name);
+  switch_name = GetStringDefault(key, "False");
+  switch_value = NA_NameToIndex(switch_na, switch_name);
+  if (switch_value < 0)
+  {
+    InputError("Error: invalid print switch value <%s> for key <%s>\n",
+               switch_name, key);
+  }
+  public_xtra->print_evaptrans_sum_single = switch_value;
+
   sprintf(key, "%s.PrintOverlandSum", name);
   switch_name = GetStringDefault(key, "False");
   switch_value = NA_NameToIndex(switch_na, switch_name);
@@ -5177,6 +5817,16 @@ SolverRichardsNewPublicXtra(char *name)
   }
   public_xtra->print_overland_sum = switch_value;
 
+  sprintf(key, "%s.PrintOverlandSum.SinglePrecision", name);
+  switch_name = GetStringDefault(key, "False");
+  switch_value = NA_NameToIndex(switch_na, switch_name);
+  if (switch_value < 0)
+  {
+    InputError("Error: invalid print switch value <%s> for key <%s>\n",
+               switch_name, key);
+  }
+  public_xtra->print_overland_sum_single = switch_value;
+
   sprintf(key, "%s.PrintOverlandBCFlux", name);
   switch_name = GetStringDefault(key, "False");
   switch_value = NA_NameToIndex(switch_na, switch_name);
@@ -5187,6 +5837,16 @@ SolverRichardsNewPublicXtra(char *name)
   }
   public_xtra->print_overland_bc_flux = switch_value;
 
+  sprintf(key, "%s.PrintOverlandBCFlux.SinglePrecision", name);
+  switch_name = GetStringDefault(key, "False");
+  switch_value = NA_NameToIndex(switch_na, switch_name);
+  if (switch_value < 0)
+  {
+    InputError("Error: invalid print switch value <%s> for key <%s>\n",
+               switch_name, key);
+  }
+  public_xtra->print_overland_bc_flux_single = switch_value;
+
   sprintf(key, "%s.PrintWells", name);
   switch_name = GetStringDefault(key, "True");
   switch_value = NA_NameToIndex(switch_na, switch_name);
@@ -5838,6 +6498,9 @@ SolverRichardsNewPublicXtra(char *name)
   sprintf(key, "%s.EvapTrans.FileName", name);
   public_xtra->evap_trans_filename = GetStringDefault(key, "");
 
+  sprintf(key, "%s.EvapTrans.StackFileName", name);
+  public_xtra->evap_trans_stack_filename = GetStringDefault(key, "");
+
 
   /* Initialize silo if necessary */
   if (public_xtra->write_silopmpio_subsurf_data ||
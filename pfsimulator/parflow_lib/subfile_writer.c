@@ -0,0 +1,216 @@
+/*BHEADER*********************************************************************
+ *
+ *  Copyright (c) 1995-2009, Lawrence Livermore National Security,
+ *  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+ *  by the Parflow Team (see the CONTRIBUTORS file)
+ *  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+ *
+ *  This file is part of Parflow. For details, see
+ *  http://www.llnl.gov/casc/parflow
+ *
+ *  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+ *  for the GNU Lesser General Public License.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License (as published
+ *  by the Free Software Foundation) version 2.1 dated February 1999.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+ *  and conditions of the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+ *  USA
+ **********************************************************************EHEADER*/
+/*****************************************************************************
+* NewSubfileWriter, FreeSubfileWriter, SubfileWriterSubfile,
+* SubfileWriterNumSubfiles, SubfileWriterStart, SubfileWriterWrite
+*
+* Subfiled PFB output, see PFB.Writer Subfile.
+*
+* The ranks are split into groups, either the ranks sharing a node or
+* blocks of PFB.Writer.SubfileRanks consecutive ranks.  The ranks of a
+* group write their data blocks into one subfile, named with
+* PFB_SUBFILE_NAME, with a collective MPI-IO write over the group, so
+* there is one file per group instead of one per rank and no locking
+* between groups.  WritePFBinaryEncoded records the subfile and offset
+* of every block in the index of the main file, which rank 0 writes.
+*
+*****************************************************************************/
+
+#include "parflow.h"
+
+#include <string.h>
+#include <sys/param.h>
+
+#ifdef PARFLOW_HAVE_MPI
+
+static struct {
+  MPI_Comm comm;                /* ranks writing the same subfile */
+  int subfile;                  /* number of this rank's subfile */
+  int num_subfiles;
+} subfile_writer = { MPI_COMM_NULL, 0, 0 };
+
+#endif
+
+
+/*--------------------------------------------------------------------------
+ * NewSubfileWriter
+ *
+ * Split the ranks into subfile groups.  If num_ranks is 0 the ranks on a
+ * node form a group, otherwise num_ranks consecutive ranks do.  Must be
+ * called by all ranks.
+ *--------------------------------------------------------------------------*/
+
+void   NewSubfileWriter(int num_ranks)
+{
+#ifdef PARFLOW_HAVE_MPI
+  int p = amps_Rank(amps_CommWorld);
+  int P = amps_Size(amps_CommWorld);
+
+#if MPI_VERSION < 3
+  /* Nodes can not be detected, fall back to one rank per subfile */
+  if (num_ranks == 0)
+  {
+    num_ranks = 1;
+  }
+#endif
+
+  if (num_ranks > 0)
+  {
+    subfile_writer.subfile = p / num_ranks;
+    subfile_writer.num_subfiles = (P + num_ranks - 1) / num_ranks;
+
+    MPI_Comm_split(amps_CommWorld, subfile_writer.subfile, p,
+                   &subfile_writer.comm);
+  }
+#if MPI_VERSION >= 3
+  else
+  {
+    int is_first, group_rank;
+
+    MPI_Comm_split_type(amps_CommWorld, MPI_COMM_TYPE_SHARED, p,
+                        MPI_INFO_NULL, &subfile_writer.comm);
+
+    /* Number the nodes by their first rank */
+    MPI_Comm_rank(subfile_writer.comm, &group_rank);
+    is_first = (group_rank == 0);
+
+    subfile_writer.subfile = 0;
+    MPI_Exscan(&is_first, &subfile_writer.subfile, 1, MPI_INT, MPI_SUM,
+               amps_CommWorld);
+    if (p == 0)
+    {
+      subfile_writer.subfile = 0;
+    }
+    MPI_Bcast(&subfile_writer.subfile, 1, MPI_INT, 0, subfile_writer.comm);
+
+    MPI_Allreduce(&is_first, &subfile_writer.num_subfiles, 1, MPI_INT,
+                  MPI_SUM, amps_CommWorld);
+  }
+#endif
+#else
+  PF_UNUSED(num_ranks);
+#endif
+}
+
+
+/*--------------------------------------------------------------------------
+ * FreeSubfileWriter
+ *--------------------------------------------------------------------------*/
+
+void   FreeSubfileWriter()
+{
+#ifdef PARFLOW_HAVE_MPI
+  if (subfile_writer.comm != MPI_COMM_NULL)
+  {
+    MPI_Comm_free(&subfile_writer.comm);
+  }
+#endif
+}
+
+
+/*--------------------------------------------------------------------------
+ * SubfileWriterSubfile, SubfileWriterNumSubfiles
+ *
+ * Return the number of this rank's subfile and the number of subfiles.
+ *--------------------------------------------------------------------------*/
+
+int    SubfileWriterSubfile()
+{
+#ifdef PARFLOW_HAVE_MPI
+  return subfile_writer.subfile;
+#else
+  return 0;
+#endif
+}
+
+int    SubfileWriterNumSubfiles()
+{
+#ifdef PARFLOW_HAVE_MPI
+  return subfile_writer.num_subfiles;
+#else
+  return 1;
+#endif
+}
+
+
+/*--------------------------------------------------------------------------
+ * SubfileWriterStart
+ *
+ * Return the offset of this rank's size bytes in its subfile; the ranks
+ * of a group are stored in rank order.  Must be called by all ranks.
+ *--------------------------------------------------------------------------*/
+
+long   SubfileWriterStart(long size)
+{
+  long start = 0;
+
+#ifdef PARFLOW_HAVE_MPI
+  int group_rank;
+
+  MPI_Exscan(&size, &start, 1, MPI_LONG, MPI_SUM, subfile_writer.comm);
+
+  MPI_Comm_rank(subfile_writer.comm, &group_rank);
+  if (group_rank == 0)
+  {
+    start = 0;
+  }
+#else
+  PF_UNUSED(size);
+#endif
+
+  return start;
+}
+
+
+/*--------------------------------------------------------------------------
+ * SubfileWriterWrite
+ *
+ * Write the size bytes in buffer as this rank's part of the subfile of
+ * filename and release the buffer.  Must be called by all ranks.
+ *--------------------------------------------------------------------------*/
+
+void   SubfileWriterWrite(
+                          char *filename,
+                          char *buffer,
+                          long  size)
+{
+  char subfile_name[MAXPATHLEN];
+
+  sprintf(subfile_name, PFB_SUBFILE_NAME, filename, SubfileWriterSubfile());
+
+#ifdef PARFLOW_HAVE_MPI
+  WritePFBinaryCollective(subfile_writer.comm, subfile_name, buffer, 1,
+                          &size, FALSE);
+#else
+  PF_UNUSED(size);
+  amps_Printf("Error: subfiled PFB output requires MPI\n");
+  exit(1);
+#endif
+
+  tfree(buffer);
+}
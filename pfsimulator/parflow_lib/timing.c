@@ -60,6 +60,7 @@ void  NewTiming()
   RegisterTiming("CLM");
   RegisterTiming("PFSOL Read");
   RegisterTiming("Clustering");
+  RegisterTiming("BC File Read");
 #ifdef VECTOR_UPDATE_TIMING
   RegisterTiming("VectorUpdate");
 #endif
@@ -76,6 +77,7 @@ int  RegisterTiming(
   amps_Clock_t     *old_time = (timing->time);
   amps_CPUClock_t  *old_cpu_time = (timing->cpu_time);
   FLOPType         *old_flops = (timing->flops);
+  long             *old_count = (timing->count);
   char            **old_name = (timing->name);
   int old_size = (timing->size);
 
@@ -85,6 +87,7 @@ int  RegisterTiming(
   (timing->time) = ctalloc(amps_Clock_t, (old_size + 1));
   (timing->cpu_time) = ctalloc(amps_CPUClock_t, (old_size + 1));
   (timing->flops) = ctalloc(FLOPType, (old_size + 1));
+  (timing->count) = ctalloc(long, (old_size + 1));
   (timing->name) = ctalloc(char *, (old_size + 1));
 
   (timing->size)++;
@@ -94,12 +97,14 @@ int  RegisterTiming(
     (timing->time)[i] = old_time[i];
     (timing->cpu_time)[i] = old_cpu_time[i];
     (timing->flops)[i] = old_flops[i];
+    (timing->count)[i] = old_count[i];
     (timing->name)[i] = old_name[i];
   }
 
   tfree(old_time);
   tfree(old_cpu_time);
   tfree(old_flops);
+  tfree(old_count);
   tfree(old_name);
 
   (timing->name)[old_size] = ctalloc(char, 50);
@@ -121,15 +126,18 @@ void  PrintTiming()
   double time_ticks[timing->size];
   double cpu_ticks[timing->size];
   double mflops[timing->size];
+  long counts[timing->size];
 
   int i;
 
-  max_invoice = amps_NewInvoice("%*d%*d", timing->size, &time_ticks, timing->size, &cpu_ticks);
+  max_invoice = amps_NewInvoice("%*d%*d%*l", timing->size, &time_ticks, timing->size, &cpu_ticks,
+                                timing->size, &counts);
 
   for (i = 0; i < (timing->size); i++)
   {
     time_ticks[i] = (double)((timing->time)[i]);
     cpu_ticks[i] = (double)((timing->cpu_time)[i]);
+    counts[i] = (timing->count)[i];
   }
 
   amps_AllReduce(amps_CommWorld, max_invoice, amps_Max);
@@ -152,6 +160,10 @@ void  PrintTiming()
                    time_ticks[i] / AMPS_TICKS_PER_SEC);
       amps_Fprintf(file, "  wall MFLOPS = %f (%g)\n", mflops[i],
                    (timing->flops)[i]);
+      if (counts[i])
+      {
+        amps_Fprintf(file, "  count             = %ld\n", counts[i]);
+      }
 #ifdef CPUTiming
       if (AMPS_CPU_TICKS_PER_SEC)
       {
@@ -186,6 +198,27 @@ void  PrintTiming()
     fclose(file);
   }
 
+#ifdef AMPS_EXCHANGE_NEIGHBOR
+  /* Per neighbor halo exchange counters, one file per process */
+  if (amps_exchange_timing)
+  {
+    FILE *file;
+    char filename[2048];
+
+    sprintf(filename, "%s.halo.%05d.csv", GlobalsOutFileName,
+            amps_Rank(amps_CommWorld));
+
+    if ((file = fopen(filename, "w")) == NULL)
+    {
+      InputError("Error: can't open output file %s%s\n", filename, "");
+    }
+
+    amps_PrintExchangeTiming(file);
+
+    fclose(file);
+  }
+#endif
+
 #ifdef VECTOR_UPDATE_TIMING
   {
     FILE *file;
@@ -230,6 +263,7 @@ void  FreeTiming()
   tfree(timing->time);
   tfree(timing->cpu_time);
   tfree(timing->flops);
+  tfree(timing->count);
   tfree(timing->name);
 
   tfree(timing);
@@ -49,8 +49,9 @@
 #define CLMTimingIndex  7
 #define PFSOLReadTimingIndex  8
 #define ClusteringTimingIndex 9
+#define BCFileTimingIndex 10
 #ifdef VECTOR_UPDATE_TIMING
-#define VectorUpdateTimingIndex  10
+#define VectorUpdateTimingIndex  11
 #endif
 
 
@@ -65,6 +66,7 @@ typedef struct {
   amps_Clock_t     *time;
   amps_CPUClock_t  *cpu_time;
   FLOPType         *flops;
+  long             *count;
   char            **name;
 
   int size;
@@ -89,6 +91,7 @@ amps_ThreadLocalDcl(extern TimingType *, timing_ptr);
 #define TimingTime(i)    (timing->time[(i)])
 #define TimingCPUTime(i) (timing->cpu_time[(i)])
 #define TimingFLOPS(i)   (timing->flops[(i)])
+#define TimingCount(i)   (timing->count[(i)])
 #define TimingName(i)    (timing->name[(i)])
 
 #define TimingSize       (timing->size)
@@ -102,6 +105,7 @@ amps_ThreadLocalDcl(extern TimingType *, timing_ptr);
  *--------------------------------------------------------------------------*/
 
 #define IncFLOPCount(inc) TimingFLOPCount += (FLOPType)inc
+#define IncTimingCount(i) TimingCount(i)++
 #define StartTiming()     TimingTimeCount -= amps_Clock(); \
   TimingCPUCount -= amps_CPUClock()
 #define StopTiming()      TimingTimeCount += amps_Clock(); \
@@ -164,6 +168,7 @@ extern EventTiming[][6];
  *--------------------------------------------------------------------------*/
 
 #define IncFLOPCount(inc)
+#define IncTimingCount(i)
 #define StartTiming()
 #define StopTiming()
 #define BeginTiming(i) if (i == 0)
@@ -318,7 +318,16 @@ static void     AllocateVectorData(
 
     SubvectorDataSize(subvector) = data_size;
 
+#ifdef AMPS_EXCHANGE_SHARED
+    /* Place the data in the node arena for the shared halo exchange */
+    double  *data = amps_SharedCTAlloc(double, data_size);
+    if (!data)
+    {
+      data = ctalloc_amps(double, data_size);
+    }
+#else
     double  *data = ctalloc_amps(double, data_size);
+#endif
     VectorSubvector(vector, i)->allocated = TRUE;
 
     SubvectorData(VectorSubvector(vector, i)) = data;
@@ -638,7 +647,18 @@ void FreeSubvector(Subvector *subvector)
 {
   if (subvector->allocated)
   {
+#ifdef AMPS_EXCHANGE_SHARED
+    if (amps_SharedMemoryOffset(SubvectorData(subvector)) >= 0)
+    {
+      amps_SharedFree(SubvectorData(subvector));
+    }
+    else
+    {
+      tfree_amps(SubvectorData(subvector));
+    }
+#else
     tfree_amps(SubvectorData(subvector));
+#endif
   }
   tfree(subvector);
 }
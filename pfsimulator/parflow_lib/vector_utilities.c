@@ -41,6 +41,9 @@
  * PFVInv(x, z)                      z_i = 1 / x_i
  * PFVAddConst(x, b, z)              z_i = x_i + b
  * PFVDotProd(x, y)                  Returns x dot y
+ * PFVDotProdMulti(n, x, y, d)       d_j = x dot y_j for j < n, one reduction
+ * PFVDotProdPairsInit(n, x, y, d)   Starts d_j = x_j dot y_j for j < n
+ * PFVDotProdPairsFinalize(h)        Completes PFVDotProdPairsInit
  * PFVMaxNorm(x)                     Returns ||x||_{max}
  * PFVWrmsNorm(x, w)                 Returns sqrt((sum_i (x_i + w_i)^2)/length)
  * PFVWL2Norm(x, w)                  Returns sqrt(sum_i (x_i * w_i)^2)
@@ -740,6 +743,140 @@ double PFVDotProd(
   return(sum);
 }
 
+/* Sum of x_i * y_i over the subgrids of this process */
+static double PFVLocalDotProd(
+                              Vector *x,
+                              Vector *y)
+{
+  Grid       *grid = VectorGrid(x);
+  Subgrid    *subgrid;
+
+  Subvector  *x_sub;
+  Subvector  *y_sub;
+
+  const double * __restrict__ yp;
+  const double * __restrict__ xp;
+  double sum = ZERO;
+
+  int ix, iy, iz;
+  int nx, ny, nz;
+  int nx_x, ny_x, nz_x;
+  int nx_y, ny_y, nz_y;
+
+  int sg, i, j, k, i_x, i_y;
+
+  ForSubgridI(sg, GridSubgrids(grid))
+  {
+    subgrid = GridSubgrid(grid, sg);
+
+    x_sub = VectorSubvector(x, sg);
+    y_sub = VectorSubvector(y, sg);
+
+    ix = SubgridIX(subgrid);
+    iy = SubgridIY(subgrid);
+    iz = SubgridIZ(subgrid);
+
+    nx = SubgridNX(subgrid);
+    ny = SubgridNY(subgrid);
+    nz = SubgridNZ(subgrid);
+
+    nx_x = SubvectorNX(x_sub);
+    ny_x = SubvectorNY(x_sub);
+    nz_x = SubvectorNZ(x_sub);
+
+    nx_y = SubvectorNX(y_sub);
+    ny_y = SubvectorNY(y_sub);
+    nz_y = SubvectorNZ(y_sub);
+
+    xp = SubvectorElt(x_sub, ix, iy, iz);
+    yp = SubvectorElt(y_sub, ix, iy, iz);
+
+    i_x = 0;
+    i_y = 0;
+
+    BoxLoopReduceI2(sum,
+                    i, j, k, ix, iy, iz, nx, ny, nz,
+                    i_x, nx_x, ny_x, nz_x, 1, 1, 1,
+                    i_y, nx_y, ny_y, nz_y, 1, 1, 1,
+    {
+      ReduceSum(sum, xp[i_x] * yp[i_y]);
+    });
+  }
+
+  return(sum);
+}
+
+void PFVDotProdMulti(
+/* DotProdMulti : dots_j = x dot y_j, j < nvec, with a single global
+ * reduction */
+                     int     nvec,
+                     Vector *x,
+                     Vector **y,
+                     double *dots)
+{
+  amps_Invoice result_invoice;
+  int n;
+
+  for (n = 0; n < nvec; n++)
+  {
+    dots[n] = PFVLocalDotProd(x, y[n]);
+  }
+
+  result_invoice = amps_NewInvoice("%*d", nvec, dots);
+  amps_AllReduce(amps_CommWorld, result_invoice, amps_Add);
+  amps_FreeInvoice(result_invoice);
+
+  IncFLOPCount(2 * nvec * VectorSize(x));
+}
+
+amps_Handle PFVDotProdPairsInit(
+/* DotProdPairsInit : start dots_j = x_j dot y_j, j < nvec, as a single
+ * non-blocking global reduction; dots is valid after
+ * PFVDotProdPairsFinalize */
+                                int      nvec,
+                                Vector **x,
+                                Vector **y,
+                                double  *dots)
+{
+  amps_Invoice result_invoice;
+  int n;
+
+  for (n = 0; n < nvec; n++)
+  {
+    dots[n] = PFVLocalDotProd(x[n], y[n]);
+  }
+
+  IncFLOPCount(2 * nvec * VectorSize(x[0]));
+
+  result_invoice = amps_NewInvoice("%*d", nvec, dots);
+
+#ifdef AMPS_HANDLE_REDUCE
+  return amps_IAllReduce(amps_CommWorld, result_invoice, amps_Add);
+#else
+  amps_AllReduce(amps_CommWorld, result_invoice, amps_Add);
+  amps_FreeInvoice(result_invoice);
+
+  return NULL;
+#endif
+}
+
+void PFVDotProdPairsFinalize(
+                             amps_Handle handle)
+{
+#ifdef AMPS_HANDLE_REDUCE
+  amps_Invoice result_invoice;
+
+  if (handle)
+  {
+    result_invoice = handle->invoice;
+    amps_Wait(handle);
+    amps_FreeInvoice(result_invoice);
+  }
+#else
+  (void)handle;
+#endif
+}
+
 double PFVMaxNorm(
 /* MaxNorm = || x ||_{max}   */
                   Vector *x)
@@ -213,7 +213,7 @@ int LookUpCLMInventory(char * varName, varNCData **myVarNCData, int *clmIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
     (*myVarNCData)->dimSize = 4;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = clmIDs[1];
@@ -251,7 +251,7 @@ int LookUpCLMInventory(char * varName, varNCData **myVarNCData, int *clmIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
     (*myVarNCData)->dimSize = 3;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = clmIDs[1];
@@ -287,7 +287,7 @@ int LookUpCLMInventory(char * varName, varNCData **myVarNCData, int *clmIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
     (*myVarNCData)->dimSize = 3;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = clmIDs[1];
@@ -323,7 +323,7 @@ int LookUpCLMInventory(char * varName, varNCData **myVarNCData, int *clmIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
     (*myVarNCData)->dimSize = 3;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = clmIDs[1];
@@ -359,7 +359,7 @@ int LookUpCLMInventory(char * varName, varNCData **myVarNCData, int *clmIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
     (*myVarNCData)->dimSize = 3;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = clmIDs[1];
@@ -395,7 +395,7 @@ int LookUpCLMInventory(char * varName, varNCData **myVarNCData, int *clmIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
     (*myVarNCData)->dimSize = 3;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = clmIDs[1];
@@ -431,7 +431,7 @@ int LookUpCLMInventory(char * varName, varNCData **myVarNCData, int *clmIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
     (*myVarNCData)->dimSize = 3;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = clmIDs[1];
@@ -467,7 +467,7 @@ int LookUpCLMInventory(char * varName, varNCData **myVarNCData, int *clmIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
     (*myVarNCData)->dimSize = 3;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = clmIDs[1];
@@ -503,7 +503,7 @@ int LookUpCLMInventory(char * varName, varNCData **myVarNCData, int *clmIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
     (*myVarNCData)->dimSize = 3;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = clmIDs[1];
@@ -539,7 +539,7 @@ int LookUpCLMInventory(char * varName, varNCData **myVarNCData, int *clmIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
     (*myVarNCData)->dimSize = 3;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = clmIDs[1];
@@ -575,7 +575,7 @@ int LookUpCLMInventory(char * varName, varNCData **myVarNCData, int *clmIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
     (*myVarNCData)->dimSize = 3;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = clmIDs[1];
@@ -607,11 +607,47 @@ int LookUpCLMInventory(char * varName, varNCData **myVarNCData, int *clmIDs)
     return qInflVarID;
   }
 
+  if (strcmp(varName, "qflx_top_soil") == 0)
+  {
+    *myVarNCData = malloc(sizeof(varNCData));
+    (*myVarNCData)->varName = varName;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
+    (*myVarNCData)->dimSize = 3;
+    (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
+    (*myVarNCData)->dimIDs[0] = clmIDs[1];
+    (*myVarNCData)->dimIDs[1] = clmIDs[3];
+    (*myVarNCData)->dimIDs[2] = clmIDs[4];
+    int qTopSoilVarID;
+    int res = nc_def_var(clmIDs[0], varName, (*myVarNCData)->ncType, (*myVarNCData)->dimSize,
+                         (*myVarNCData)->dimIDs, &qTopSoilVarID);
+    if (res != NC_ENAMEINUSE)
+    {
+      char *switch_name;
+      char key[IDB_MAX_KEY_LEN];
+      char *default_val = "None";
+      sprintf(key, "NetCDF.Chunking");
+      switch_name = GetStringDefault(key, "None");
+      if (strcmp(switch_name, default_val) != 0)
+      {
+        size_t chunksize[(*myVarNCData)->dimSize];
+        chunksize[0] = 1;
+        chunksize[1] = GetInt("NetCDF.ChunkY");
+        chunksize[2] = GetInt("NetCDF.ChunkX");
+        nc_def_var_chunking(clmIDs[0], qTopSoilVarID, NC_CHUNKED, chunksize);
+      }
+    }
+    if (res == NC_ENAMEINUSE)
+    {
+      res = nc_inq_varid(clmIDs[0], varName, &qTopSoilVarID);
+    }
+    return qTopSoilVarID;
+  }
+
   if (strcmp(varName, "swe_out") == 0)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
     (*myVarNCData)->dimSize = 3;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = clmIDs[1];
@@ -647,7 +683,7 @@ int LookUpCLMInventory(char * varName, varNCData **myVarNCData, int *clmIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
     (*myVarNCData)->dimSize = 3;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = clmIDs[1];
@@ -683,7 +719,7 @@ int LookUpCLMInventory(char * varName, varNCData **myVarNCData, int *clmIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
     (*myVarNCData)->dimSize = 3;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = clmIDs[1];
@@ -719,7 +755,7 @@ int LookUpCLMInventory(char * varName, varNCData **myVarNCData, int *clmIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteCLM.SinglePrecision");
     (*myVarNCData)->dimSize = 4;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = clmIDs[1];
@@ -34,38 +34,853 @@
 #include "parflow.h"
 
 #include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/param.h>
+
+#ifdef PARFLOW_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/*--------------------------------------------------------------------------
+ * PFBPackInt, PFBPackDouble, PFBPackFloat
+ *
+ * Copy values into a byte buffer using the XDR (big endian) representation
+ * written by amps_WriteInt/amps_WriteDouble.  PFBPackFloat rounds the
+ * doubles to single precision.  Return the next free byte of the
+ * buffer.  The loops are kept simple so the byte swap vectorizes when
+ * called on whole rows of a subvector.
+ *--------------------------------------------------------------------------*/
+
+char      *PFBPackInt(
+                      char *buf,
+                      int * ptr,
+                      int   len)
+{
+#ifdef CASC_HAVE_BIGENDIAN
+  memcpy(buf, ptr, (size_t)len * amps_SizeofInt);
+#else
+  int i;
+
+  for (i = 0; i < len; i++)
+  {
+    uint32_t x;
+
+    memcpy(&x, &ptr[i], sizeof(x));
+    x = PFByteSwap32(x);
+    memcpy(&buf[(size_t)i * amps_SizeofInt], &x, sizeof(x));
+  }
+#endif
+
+  return buf + (size_t)len * amps_SizeofInt;
+}
+
+char      *PFBPackDouble(
+                         char *  buf,
+                         double *ptr,
+                         int     len)
+{
+#ifdef CASC_HAVE_BIGENDIAN
+  memcpy(buf, ptr, (size_t)len * amps_SizeofDouble);
+#else
+  int i;
+
+  for (i = 0; i < len; i++)
+  {
+    uint64_t x;
+
+    memcpy(&x, &ptr[i], sizeof(x));
+    x = PFByteSwap64(x);
+    memcpy(&buf[(size_t)i * amps_SizeofDouble], &x, sizeof(x));
+  }
+#endif
+
+  return buf + (size_t)len * amps_SizeofDouble;
+}
+
+char      *PFBPackFloat(
+                        char *  buf,
+                        double *ptr,
+                        int     len)
+{
+  int i;
+
+  for (i = 0; i < len; i++)
+  {
+    float f = (float)ptr[i];
+    uint32_t x;
+
+    memcpy(&x, &f, sizeof(x));
+#ifndef CASC_HAVE_BIGENDIAN
+    x = PFByteSwap32(x);
+#endif
+    memcpy(&buf[(size_t)i * amps_SizeofFloat], &x, sizeof(x));
+  }
+
+  return buf + (size_t)len * amps_SizeofFloat;
+}
+
+char      *PFBPackLong(
+                       char *buf,
+                       long  value)
+{
+  uint64_t x = (uint64_t)value;
+
+#ifndef CASC_HAVE_BIGENDIAN
+  x = PFByteSwap64(x);
+#endif
+  memcpy(buf, &x, sizeof(x));
+
+  return buf + sizeof(x);
+}
+
+/*--------------------------------------------------------------------------
+ * PackPFBinaryHeader
+ *
+ * Pack the global PFB/PFSB header written by rank 0.
+ *--------------------------------------------------------------------------*/
+
+char      *PackPFBinaryHeader(
+                              char *buf,
+                              int   nx,
+                              int   ny,
+                              int   nz,
+                              int   num_subgrids)
+{
+  buf = PFBPackDouble(buf, &BackgroundX(GlobalsBackground), 1);
+  buf = PFBPackDouble(buf, &BackgroundY(GlobalsBackground), 1);
+  buf = PFBPackDouble(buf, &BackgroundZ(GlobalsBackground), 1);
+
+  buf = PFBPackInt(buf, &nx, 1);
+  buf = PFBPackInt(buf, &ny, 1);
+  buf = PFBPackInt(buf, &nz, 1);
+
+  buf = PFBPackDouble(buf, &BackgroundDX(GlobalsBackground), 1);
+  buf = PFBPackDouble(buf, &BackgroundDY(GlobalsBackground), 1);
+  buf = PFBPackDouble(buf, &BackgroundDZ(GlobalsBackground), 1);
+
+  buf = PFBPackInt(buf, &num_subgrids, 1);
+
+  return buf;
+}
+
+/*--------------------------------------------------------------------------
+ * PackPFBinarySubgridHeader
+ *--------------------------------------------------------------------------*/
+
+char      *PackPFBinarySubgridHeader(
+                                     char *   buf,
+                                     Subgrid *subgrid)
+{
+  buf = PFBPackInt(buf, &SubgridIX(subgrid), 1);
+  buf = PFBPackInt(buf, &SubgridIY(subgrid), 1);
+  buf = PFBPackInt(buf, &SubgridIZ(subgrid), 1);
+
+  buf = PFBPackInt(buf, &SubgridNX(subgrid), 1);
+  buf = PFBPackInt(buf, &SubgridNY(subgrid), 1);
+  buf = PFBPackInt(buf, &SubgridNZ(subgrid), 1);
+
+  buf = PFBPackInt(buf, &SubgridRX(subgrid), 1);
+  buf = PFBPackInt(buf, &SubgridRY(subgrid), 1);
+  buf = PFBPackInt(buf, &SubgridRZ(subgrid), 1);
+
+  return buf;
+}
+
+/*--------------------------------------------------------------------------
+ * PFBinaryFileOrder
+ *
+ * Return the indices into the grid's subgrid array in the order the
+ * subgrids are stored in a PFB file: in rank order with each rank's
+ * subgrids in their local order.  If first is not NULL it is set to the
+ * file position of this rank's first subgrid.
+ *--------------------------------------------------------------------------*/
+
+static int *PFBinaryFileOrder(
+                              Grid *grid,
+                              int * first_local)
+{
+  SubgridArray   *all_subgrids = GridAllSubgrids(grid);
+
+  int num_procs = amps_Size(amps_CommWorld);
+  int num_subgrids = SubgridArraySize(all_subgrids);
+  int            *first;
+  int            *order;
+  int g, p;
+
+  /* Bucket the subgrids by process, keeping their relative order */
+  first = ctalloc(int, num_procs + 1);
+  order = talloc(int, num_subgrids);
+
+  ForSubgridI(g, all_subgrids)
+  {
+    first[SubgridProcess(SubgridArraySubgrid(all_subgrids, g)) + 1]++;
+  }
+  for (p = 0; p < num_procs; p++)
+  {
+    first[p + 1] += first[p];
+  }
+
+  if (first_local)
+  {
+    *first_local = first[amps_Rank(amps_CommWorld)];
+  }
+
+  ForSubgridI(g, all_subgrids)
+  {
+    order[first[SubgridProcess(SubgridArraySubgrid(all_subgrids, g))]++] = g;
+  }
+
+  tfree(first);
+
+  return order;
+}
+
+/*--------------------------------------------------------------------------
+ * SizeofPFBinaryIndex, PackPFBinaryIndex
+ *
+ * The optional PFB index (see PFB.Index) is appended after the last
+ * subgrid by the last rank.  It holds a copy of every subgrid header
+ * followed by the byte offset of the subgrid's data, in file order, and
+ * ends with a fixed size trailer:
+ *
+ *    long index_offset, int version, char magic[4]
+ *
+ * Readers that do not know about the index stop after the last subgrid,
+ * so indexed files remain readable by them.  The offsets are computed
+ * from the grid's subgrid array; subgrids are stored in rank order with
+ * each rank's subgrids in their local order.
+ *--------------------------------------------------------------------------*/
+
+long SizeofPFBinaryIndex(
+                         int num_subgrids)
+{
+  return (long)num_subgrids * PFB_INDEX_ENTRY_SIZE + PFB_INDEX_TRAILER_SIZE;
+}
+
+char      *PackPFBinaryIndex(
+                             char *buf,
+                             Grid *grid)
+{
+  SubgridArray   *all_subgrids = GridAllSubgrids(grid);
+  Subgrid        *subgrid;
+
+  int num_subgrids = SubgridArraySize(all_subgrids);
+  int            *order = PFBinaryFileOrder(grid, NULL);
+  int version = PFB_INDEX_VERSION;
+  int g;
+
+  long offset;
+
+  offset = 6 * amps_SizeofDouble + 4 * amps_SizeofInt;
+  for (g = 0; g < num_subgrids; g++)
+  {
+    subgrid = SubgridArraySubgrid(all_subgrids, order[g]);
+
+    offset += 9 * amps_SizeofInt;
+
+    buf = PackPFBinarySubgridHeader(buf, subgrid);
+    buf = PFBPackLong(buf, offset);
+
+    offset += (long)SubgridNX(subgrid) * SubgridNY(subgrid) * SubgridNZ(subgrid)
+              * amps_SizeofDouble;
+  }
+
+  /* offset is now the start of the index */
+  buf = PFBPackLong(buf, offset);
+  buf = PFBPackInt(buf, &version, 1);
+  memcpy(buf, PFB_INDEX_MAGIC, 4);
+  buf += 4;
+
+  tfree(order);
+
+  return buf;
+}
+
+/*--------------------------------------------------------------------------
+ * SizeofPFBinaryEncodedHeader, PackPFBinaryEncodedHeader
+ *
+ * An encoded PFB file (see PFB.Compression) starts with the regular
+ * header with the number of subgrids negated, which tells it apart from
+ * a plain PFB file.  The encoding, for quantized files the error bound,
+ * and a block index with one entry per subgrid, in file order, follow:
+ *
+ *    int encoding
+ *    double error_bound                 (PFB_ENCODING_QUANTIZE only)
+ *    int num_subfiles, int subfile      (PFB_ENCODING_SUBFILE only, one
+ *                                        subfile per subgrid)
+ *    int ix, iy, iz, nx, ny, nz, rx, ry, rz, long offset, long size
+ *
+ * where offset and size locate the encoded data of the subgrid.  The
+ * blocks follow the header in the same order.  block_sizes holds the
+ * size of every block in file order.  For PFB_ENCODING_SUBFILE the
+ * blocks are stored in the subfiles instead, block_subfiles and
+ * block_offsets give the subfile of every block and its offset in it.
+ *--------------------------------------------------------------------------*/
+
+long SizeofPFBinaryEncodedHeader(
+                                 int num_subgrids,
+                                 int encoding)
+{
+  long size = 6 * amps_SizeofDouble + 5 * amps_SizeofInt
+              + (long)num_subgrids * PFB_ENCODED_ENTRY_SIZE;
+
+  if (encoding & PFB_ENCODING_QUANTIZE)
+  {
+    size += amps_SizeofDouble;
+  }
+
+  if (encoding & PFB_ENCODING_SUBFILE)
+  {
+    size += (long)(1 + num_subgrids) * amps_SizeofInt;
+  }
+
+  return size;
+}
+
+char      *PackPFBinaryEncodedHeader(
+                                     char * buf,
+                                     Grid * grid,
+                                     int    encoding,
+                                     double error_bound,
+                                     long * block_sizes,
+                                     int    num_subfiles,
+                                     int *  block_subfiles,
+                                     long * block_offsets)
+{
+  SubgridArray   *all_subgrids = GridAllSubgrids(grid);
+  Subgrid        *subgrid;
+
+  int num_subgrids = SubgridArraySize(all_subgrids);
+  int            *order = PFBinaryFileOrder(grid, NULL);
+  int g;
+
+  long offset = SizeofPFBinaryEncodedHeader(num_subgrids, encoding);
+
+  buf = PackPFBinaryHeader(buf,
+                           SubgridNX(GridBackground(grid)),
+                           SubgridNY(GridBackground(grid)),
+                           SubgridNZ(GridBackground(grid)),
+                           -num_subgrids);
+  buf = PFBPackInt(buf, &encoding, 1);
+
+  if (encoding & PFB_ENCODING_QUANTIZE)
+  {
+    buf = PFBPackDouble(buf, &error_bound, 1);
+  }
+
+  if (encoding & PFB_ENCODING_SUBFILE)
+  {
+    buf = PFBPackInt(buf, &num_subfiles, 1);
+    buf = PFBPackInt(buf, block_subfiles, num_subgrids);
+  }
+
+  for (g = 0; g < num_subgrids; g++)
+  {
+    subgrid = SubgridArraySubgrid(all_subgrids, order[g]);
+
+    if (encoding & PFB_ENCODING_SUBFILE)
+    {
+      offset = block_offsets[g];
+    }
+
+    buf = PackPFBinarySubgridHeader(buf, subgrid);
+    buf = PFBPackLong(buf, offset);
+    buf = PFBPackLong(buf, block_sizes[g]);
+
+    offset += block_sizes[g];
+  }
+
+  tfree(order);
+
+  return buf;
+}
+
+/*--------------------------------------------------------------------------
+ * PFBShuffle
+ *
+ * Regroup the bytes of n values of width bytes each so byte b of every
+ * value is stored together.  The exponent bytes of neighbouring cells are
+ * mostly equal, which is what makes the data compress well.
+ *--------------------------------------------------------------------------*/
+
+void       PFBShuffle(
+                      char *dst,
+                      char *src,
+                      long  n,
+                      int   width)
+{
+  long i;
+  int b;
+
+  for (b = 0; b < width; b++)
+  {
+    for (i = 0; i < n; i++)
+    {
+      dst[b * n + i] = src[i * width + b];
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------
+ * PFBQuantize
+ *
+ * Pack the n values of data as the block of a quantized PFB file:
+ *
+ *    double min, int bits, n values of bits bits each
+ *
+ * Value i is stored as the integer q_i = round((data_i - min) / step)
+ * with step = 2 error_bound, so min + q_i step is within error_bound of
+ * data_i.  The integers are packed most significant bit first without
+ * padding between values.  If the integers would need more than
+ * PFB_QUANTIZE_MAX_BITS bits, the data is not finite or the rounding of
+ * the reconstruction exceeds the bound, bits is set to 64 and the XDR
+ * doubles are stored instead, so the bound always holds.  Return the end
+ * of the block.
+ *--------------------------------------------------------------------------*/
+
+char      *PFBQuantize(
+                       char *  buf,
+                       double *data,
+                       long    n,
+                       double  error_bound)
+{
+  double step = 2.0 * error_bound;
+  double min, max;
+  double range;
+
+  unsigned char  *ptr;
+  uint64_t acc;
+  uint64_t q;
+  uint64_t max_q;
+  int bits;
+  int num_acc;
+  long i;
+
+  min = max = (n > 0) ? data[0] : 0.0;
+  for (i = 1; i < n; i++)
+  {
+    min = pfmin(min, data[i]);
+    max = pfmax(max, data[i]);
+  }
+
+  range = (max - min) / step;
+  if (!(range < (double)(((uint64_t)1) << PFB_QUANTIZE_MAX_BITS)))
+  {
+    bits = 64;
+  }
+  else
+  {
+    max_q = (uint64_t)(range + 0.5);
+    for (bits = 0; (bits < 64) && (max_q >> bits); bits++)
+      ;
+
+    for (i = 0; i < n; i++)
+    {
+      q = (uint64_t)((data[i] - min) / step + 0.5);
+      if (!(fabs(min + (double)q * step - data[i]) <= error_bound))
+      {
+        bits = 64;
+        break;
+      }
+    }
+  }
+
+  buf = PFBPackDouble(buf, &min, 1);
+  buf = PFBPackInt(buf, &bits, 1);
+
+  if (bits == 64)
+  {
+    for (i = 0; i < n; i++)
+    {
+      buf = PFBPackDouble(buf, &data[i], 1);
+    }
+    return buf;
+  }
+
+  /* Shift the values into an accumulator and flush whole bytes */
+  ptr = (unsigned char*)buf;
+  acc = 0;
+  num_acc = 0;
+  for (i = 0; i < n; i++)
+  {
+    q = (uint64_t)((data[i] - min) / step + 0.5);
+
+    acc = (acc << bits) | q;
+    num_acc += bits;
+    while (num_acc >= 8)
+    {
+      num_acc -= 8;
+      *ptr++ = (unsigned char)(acc >> num_acc);
+    }
+  }
+  if (num_acc > 0)
+  {
+    *ptr++ = (unsigned char)(acc << (8 - num_acc));
+  }
+
+  return (char*)ptr;
+}
+
+/*--------------------------------------------------------------------------
+ * SizeofPFBinaryEncodedSubvector, PackPFBinaryEncodedSubvector
+ *
+ * Encode the data of a subvector as one block of an encoded PFB file.
+ * The size is an upper bound of the block size, the pack routine returns
+ * the end of the block.  For PFB_ENCODING_QUANTIZE the values are packed
+ * by PFBQuantize, otherwise they are stored as XDR doubles, or floats for
+ * PFB_ENCODING_FLOAT.  For PFB_ENCODING_DEFLATE the values are shuffled
+ * and the block is compressed with zlib at the given level.
+ *--------------------------------------------------------------------------*/
+
+long SizeofPFBinaryEncodedSubvector(
+                                    Subgrid *subgrid,
+                                    int      encoding)
+{
+  long size = (long)SubgridNX(subgrid) * SubgridNY(subgrid) * SubgridNZ(subgrid)
+              * PFBEncodedValueSize(encoding);
+
+  if (encoding & PFB_ENCODING_QUANTIZE)
+  {
+    size += amps_SizeofDouble + amps_SizeofInt;
+  }
+
+#ifdef PARFLOW_HAVE_ZLIB
+  if (encoding & PFB_ENCODING_DEFLATE)
+  {
+    return (long)compressBound((uLong)size);
+  }
+#endif
+
+  return size;
+}
+
+char      *PackPFBinaryEncodedSubvector(
+                                        char *     buf,
+                                        Subvector *subvector,
+                                        Subgrid *  subgrid,
+                                        int        encoding,
+                                        int        level,
+                                        double     error_bound)
+{
+  int ix = SubgridIX(subgrid);
+  int iy = SubgridIY(subgrid);
+  int iz = SubgridIZ(subgrid);
+
+  int nx = SubgridNX(subgrid);
+  int ny = SubgridNY(subgrid);
+  int nz = SubgridNZ(subgrid);
+
+  long n = (long)nx * ny * nz;
+  long size = SizeofPFBinaryEncodedSubvector(subgrid,
+                                             encoding & ~PFB_ENCODING_DEFLATE);
+
+  int j, k;
+  char           *values;
+  char           *ptr;
+
+  if (!(encoding & PFB_ENCODING_DEFLATE))
+  {
+    values = buf;
+  }
+  else
+  {
+    values = talloc(char, size);
+  }
+
+  if (encoding & PFB_ENCODING_QUANTIZE)
+  {
+    double *data = talloc(double, n);
+    double *dst = data;
+
+    for (k = iz; k < iz + nz; k++)
+    {
+      for (j = iy; j < iy + ny; j++)
+      {
+        memcpy(dst, SubvectorElt(subvector, ix, j, k), nx * sizeof(double));
+        dst += nx;
+      }
+    }
+
+    ptr = PFBQuantize(values, data, n, error_bound);
+
+    tfree(data);
+  }
+  else
+  {
+    ptr = values;
+    for (k = iz; k < iz + nz; k++)
+    {
+      for (j = iy; j < iy + ny; j++)
+      {
+        if (encoding & PFB_ENCODING_FLOAT)
+        {
+          ptr = PFBPackFloat(ptr, SubvectorElt(subvector, ix, j, k), nx);
+        }
+        else
+        {
+          ptr = PFBPackDouble(ptr, SubvectorElt(subvector, ix, j, k), nx);
+        }
+      }
+    }
+  }
+
+  if (!(encoding & PFB_ENCODING_DEFLATE))
+  {
+    return ptr;
+  }
+
+#ifdef PARFLOW_HAVE_ZLIB
+  {
+    char   *shuffled = values;
+    uLongf len = compressBound((uLong)size);
+
+    /* Quantized blocks are packed densely already */
+    size = (long)(ptr - values);
+    if (!(encoding & PFB_ENCODING_QUANTIZE))
+    {
+      shuffled = talloc(char, size);
+      PFBShuffle(shuffled, values, n, PFBEncodedValueSize(encoding));
+    }
+
+    if (compress2((Bytef*)buf, &len, (Bytef*)shuffled, (uLong)size, level)
+        != Z_OK)
+    {
+      amps_Printf("Error: can't compress PFB data\n");
+      exit(1);
+    }
+
+    if (shuffled != values)
+    {
+      tfree(shuffled);
+    }
+    buf += len;
+  }
+#else
+  PF_UNUSED(level);
+#endif
+
+  tfree(values);
+
+  return buf;
+}
+
+/*--------------------------------------------------------------------------
+ * WritePFBinaryCollective
+ *
+ * Write the bytes in buffer to filename using collective MPI-IO over
+ * comm.  The buffer holds num_parts consecutive parts with the given
+ * sizes, normally the single part written by this rank.  Every rank's
+ * contribution is placed after the contributions of the lower ranks,
+ * which is the same layout amps_FFopen produces.  If write_dist is set
+ * the matching .dist file with the start of every part is written so
+ * existing readers work unchanged.
+ *--------------------------------------------------------------------------*/
+
+void       WritePFBinaryCollective(
+                                   amps_Comm comm,
+                                   char *    filename,
+                                   char *    buffer,
+                                   int       num_parts,
+                                   long *    part_sizes,
+                                   int       write_dist)
+{
+#ifdef PARFLOW_HAVE_MPI
+  MPI_File fh;
+  MPI_Info info;
+  MPI_Status status;
+
+  long size = 0;
+  long start = 0;
+  long *starts;
+  long *all_starts = NULL;
+  int *counts = NULL;
+  int *displs = NULL;
+
+  int p, P;
+
+  /* Largest single write, keeps counts within int for MPI */
+  long max_chunk = 1L << 30;
+  long num_chunks, max_num_chunks, chunk, offset;
+  int i, rc;
+
+  MPI_Comm_rank(comm, &p);
+  MPI_Comm_size(comm, &P);
+
+  for (i = 0; i < num_parts; i++)
+  {
+    size += part_sizes[i];
+  }
+
+  MPI_Exscan(&size, &start, 1, MPI_LONG, MPI_SUM, comm);
+  if (p == 0)
+  {
+    start = 0;
+  }
+
+  /* Remove any existing file so a shorter file is not left with stale data */
+  if (p == 0)
+  {
+    MPI_File_delete(filename, MPI_INFO_NULL);
+  }
+  MPI_Barrier(comm);
+
+  /* Ask ROMIO for two-phase collective buffering */
+  MPI_Info_create(&info);
+  MPI_Info_set(info, "romio_cb_write", "enable");
+
+  rc = MPI_File_open(comm, filename,
+                     MPI_MODE_WRONLY | MPI_MODE_CREATE, info, &fh);
+  if (rc != MPI_SUCCESS)
+  {
+    amps_Printf("Error: can't open output file %s\n", filename);
+    exit(1);
+  }
+
+  MPI_File_set_view(fh, (MPI_Offset)start, MPI_BYTE, MPI_BYTE, "native", info);
+
+  /* Collective writes must be matched on every rank */
+  num_chunks = (size + max_chunk - 1) / max_chunk;
+  MPI_Allreduce(&num_chunks, &max_num_chunks, 1, MPI_LONG, MPI_MAX, comm);
+
+  for (chunk = 0, offset = 0; chunk < max_num_chunks; chunk++)
+  {
+    int count = (int)pfmin(max_chunk, size - offset);
+    MPI_File_write_all(fh, buffer + offset, count, MPI_BYTE, &status);
+    offset += count;
+  }
+
+  MPI_File_close(&fh);
+  MPI_Info_free(&info);
+
+  /* Write the distribution file used by amps_FFopen when reading */
+  if (!write_dist)
+  {
+    return;
+  }
+
+  starts = talloc(long, num_parts);
+  for (i = 0; i < num_parts; i++)
+  {
+    starts[i] = start;
+    start += part_sizes[i];
+  }
+
+  if (p == 0)
+  {
+    counts = talloc(int, P);
+    displs = talloc(int, P);
+  }
+
+  MPI_Gather(&num_parts, 1, MPI_INT, counts, 1, MPI_INT, 0, comm);
+
+  if (p == 0)
+  {
+    displs[0] = 0;
+    for (i = 1; i < P; i++)
+    {
+      displs[i] = displs[i - 1] + counts[i - 1];
+    }
+
+    all_starts = talloc(long, displs[P - 1] + counts[P - 1]);
+  }
+
+  MPI_Gatherv(starts, num_parts, MPI_LONG,
+              all_starts, counts, displs, MPI_LONG, 0, comm);
+
+  if (p == 0)
+  {
+    char dist_filename[MAXPATHLEN];
+    FILE *dfile;
+
+    sprintf(dist_filename, "%s.dist", filename);
+
+    if ((dfile = fopen(dist_filename, "w")) == NULL)
+    {
+      amps_Printf("Error: can't open the distribution file %s\n", dist_filename);
+      exit(1);
+    }
+
+    for (i = 0; i < displs[P - 1] + counts[P - 1]; i++)
+    {
+      fprintf(dfile, "%ld\n", all_starts[i]);
+    }
+
+    fclose(dfile);
+
+    tfree(all_starts);
+    tfree(counts);
+    tfree(displs);
+  }
+
+  tfree(starts);
+#else
+  PF_UNUSED(comm);
+  PF_UNUSED(filename);
+  PF_UNUSED(buffer);
+  PF_UNUSED(num_parts);
+  PF_UNUSED(part_sizes);
+  PF_UNUSED(write_dist);
+  amps_Printf("Error: collective PFB output requires MPI\n");
+  exit(1);
+#endif
+}
+
+/*--------------------------------------------------------------------------
+ * NewPFBinaryBuffer, WritePFBinaryBuffer
+ *
+ * Get the buffer a rank's part of a PFB/PFSB file is packed into and
+ * write the packed buffer with the PFB.Writer strategy, which is not
+ * AMPS.  WritePFBinaryBuffer releases the buffer.  PFSB files are not
+ * subfiled, with PFB.Writer Subfile they are written like with MPIIO.
+ *--------------------------------------------------------------------------*/
+
+char      *NewPFBinaryBuffer(
+                             long size)
+{
+  if (GlobalsPFBWriter == PFB_WRITER_BACKGROUND)
+  {
+    return BackgroundWriterBuffer(size);
+  }
+
+  return talloc(char, size);
+}
+
+void       WritePFBinaryBuffer(
+                               char *filename,
+                               char *buffer,
+                               long  size,
+                               int   write_dist)
+{
+  switch (GlobalsPFBWriter)
+  {
+    case PFB_WRITER_BACKGROUND:
+      BackgroundWriterSubmit(filename, buffer, size, write_dist);
+      break;
+
+    case PFB_WRITER_IOSERVER:
+      IOServerWrite(filename, buffer, size, write_dist);
+      break;
+
+    default:
+      WritePFBinaryCollective(amps_CommWorld, filename, buffer, 1, &size,
+                              write_dist);
+      tfree(buffer);
+      break;
+  }
+}
 
 long SizeofPFBinarySubvector(
                              Subvector *subvector,
                              Subgrid *  subgrid)
 {
-  int ix = SubgridIX(subgrid);
-  int iy = SubgridIY(subgrid);
-  int iz = SubgridIZ(subgrid);
-
   int nx = SubgridNX(subgrid);
   int ny = SubgridNY(subgrid);
   int nz = SubgridNZ(subgrid);
 
-  int nx_v = SubvectorNX(subvector);
-  int ny_v = SubvectorNY(subvector);
-  int nz_v = SubvectorNZ(subvector);
-
-  int i, j, k, ai;
-
-  long size;
-
-  size = 9 * amps_SizeofInt;
-
-  ai = 0;
-  BoxLoopI1(i, j, k,
-            ix, iy, iz, nx, ny, nz,
-            ai, nx_v, ny_v, nz_v, 1, 1, 1,
-  {
-    size += amps_SizeofDouble;
-  });
+  (void)subvector;
 
-  return size;
+  return 9 * amps_SizeofInt + (long)nx * ny * nz * amps_SizeofDouble;
 }
 
 
@@ -73,6 +888,26 @@ void       WritePFBinary_Subvector(
                                    amps_File  file,
                                    Subvector *subvector,
                                    Subgrid *  subgrid)
+{
+  long size = SizeofPFBinarySubvector(subvector, subgrid);
+  char           *buffer;
+
+  /* Convert the whole subgrid into a staging buffer and write it with
+   * a single call instead of one amps_WriteDouble per cell */
+  buffer = talloc(char, size);
+
+  PackPFBinary_Subvector(buffer, subvector, subgrid);
+
+  amps_WriteChar(file, buffer, size);
+
+  tfree(buffer);
+}
+
+
+char      *PackPFBinary_Subvector(
+                                  char *     buf,
+                                  Subvector *subvector,
+                                  Subgrid *  subgrid)
 {
   int ix = SubgridIX(subgrid);
   int iy = SubgridIY(subgrid);
@@ -82,38 +917,186 @@ void       WritePFBinary_Subvector(
   int ny = SubgridNY(subgrid);
   int nz = SubgridNZ(subgrid);
 
-  int nx_v = SubvectorNX(subvector);
-  int ny_v = SubvectorNY(subvector);
-  int nz_v = SubvectorNZ(subvector);
-
-  int i, j, k, ai;
+  int j, k;
   double         *data;
 
-  amps_WriteInt(file, &ix, 1);
-  amps_WriteInt(file, &iy, 1);
-  amps_WriteInt(file, &iz, 1);
+  buf = PackPFBinarySubgridHeader(buf, subgrid);
 
-  amps_WriteInt(file, &nx, 1);
-  amps_WriteInt(file, &ny, 1);
-  amps_WriteInt(file, &nz, 1);
+  /* x-rows are contiguous in the subvector, convert a row at a time */
+  for (k = iz; k < iz + nz; k++)
+  {
+    for (j = iy; j < iy + ny; j++)
+    {
+      data = SubvectorElt(subvector, ix, j, k);
+      buf = PFBPackDouble(buf, data, nx);
+    }
+  }
 
-  amps_WriteInt(file, &SubgridRX(subgrid), 1);
-  amps_WriteInt(file, &SubgridRY(subgrid), 1);
-  amps_WriteInt(file, &SubgridRZ(subgrid), 1);
+  return buf;
+}
 
-  data = SubvectorElt(subvector, ix, iy, iz);
 
-  /* SGS Note:
-   *  this is way to slow we need better boxloops that operate
-   *  on arrays */
+/*--------------------------------------------------------------------------
+ * WritePFBinaryEncoded
+ *
+ * Write v as an encoded PFB file.  Every rank encodes its own subgrids,
+ * so the compression runs in parallel and only the encoded bytes are
+ * written.  The block sizes are then summed over all ranks so rank 0
+ * can pack the block index in the header.  error_bound is only used with
+ * PFB_ENCODING_QUANTIZE.  With PFB.Writer Subfile the blocks are written
+ * to the subfiles and rank 0 writes the header alone to filename.
+ *--------------------------------------------------------------------------*/
+
+static void WritePFBinaryEncoded(
+                                 char *  filename,
+                                 Vector *v,
+                                 int     encoding,
+                                 double  error_bound)
+{
+  Grid           *grid = VectorGrid(v);
+  SubgridArray   *subgrids = GridSubgrids(grid);
+  Subgrid        *subgrid;
 
-  ai = 0;
-  BoxLoopI1(i, j, k,
-            ix, iy, iz, nx, ny, nz,
-            ai, nx_v, ny_v, nz_v, 1, 1, 1,
+  int p = amps_Rank(amps_CommWorld);
+  int num_subgrids = SubgridArraySize(GridAllSubgrids(grid));
+  int first;
+  int g;
+
+  long header_size;
+  long size;
+  long start;
+  long           *block_sizes;
+  long           *block_offsets = NULL;
+  int            *block_subfiles = NULL;
+
+  char           *buffer;
+  char           *ptr;
+  char           *block;
+
+  amps_Invoice invoice;
+  amps_File file;
+
+  tfree(PFBinaryFileOrder(grid, &first));
+
+  if (GlobalsPFBWriter == PFB_WRITER_SUBFILE)
   {
-    amps_WriteDouble(file, &data[ai], 1);
-  });
+    encoding |= PFB_ENCODING_SUBFILE;
+  }
+
+  header_size = (p == 0) ? SizeofPFBinaryEncodedHeader(num_subgrids, encoding) : 0;
+
+  /* The header is not part of the subfiles */
+  if (encoding & PFB_ENCODING_SUBFILE)
+  {
+    header_size = 0;
+  }
+
+  size = header_size;
+  ForSubgridI(g, subgrids)
+  {
+    size += SizeofPFBinaryEncodedSubvector(SubgridArraySubgrid(subgrids, g),
+                                           encoding);
+  }
+
+  buffer = NewPFBinaryBuffer(size);
+  block_sizes = ctalloc(long, num_subgrids);
+
+  ptr = buffer + header_size;
+  ForSubgridI(g, subgrids)
+  {
+    subgrid = SubgridArraySubgrid(subgrids, g);
+
+    block = ptr;
+    ptr = PackPFBinaryEncodedSubvector(ptr, VectorSubvector(v, g), subgrid,
+                                       encoding, GlobalsPFBCompressionLevel,
+                                       error_bound);
+    block_sizes[first + g] = (long)(ptr - block);
+  }
+  size = (long)(ptr - buffer);
+
+  if (encoding & PFB_ENCODING_SUBFILE)
+  {
+    block_offsets = ctalloc(long, num_subgrids);
+    block_subfiles = ctalloc(int, num_subgrids);
+
+    start = SubfileWriterStart(size);
+    ForSubgridI(g, subgrids)
+    {
+      block_offsets[first + g] = start;
+      block_subfiles[first + g] = SubfileWriterSubfile();
+      start += block_sizes[first + g];
+    }
+
+    invoice = amps_NewInvoice("%*l%*l%*i", num_subgrids, block_sizes,
+                              num_subgrids, block_offsets,
+                              num_subgrids, block_subfiles);
+  }
+  else
+  {
+    invoice = amps_NewInvoice("%*l", num_subgrids, block_sizes);
+  }
+  amps_AllReduce(amps_CommWorld, invoice, amps_Add);
+  amps_FreeInvoice(invoice);
+
+  if (encoding & PFB_ENCODING_SUBFILE)
+  {
+    if (p == 0)
+    {
+      FILE *header_file;
+      char *header;
+
+      header_size = SizeofPFBinaryEncodedHeader(num_subgrids, encoding);
+      header = talloc(char, header_size);
+
+      PackPFBinaryEncodedHeader(header, grid, encoding, error_bound,
+                                block_sizes, SubfileWriterNumSubfiles(),
+                                block_subfiles, block_offsets);
+
+      if (((header_file = fopen(filename, "wb")) == NULL) ||
+          (fwrite(header, 1, header_size, header_file) != (size_t)header_size))
+      {
+        amps_Printf("Error: can't write output file %s\n", filename);
+        exit(1);
+      }
+      fclose(header_file);
+
+      tfree(header);
+    }
+
+    tfree(block_sizes);
+    tfree(block_offsets);
+    tfree(block_subfiles);
+
+    SubfileWriterWrite(filename, buffer, size);
+    return;
+  }
+
+  if (p == 0)
+  {
+    PackPFBinaryEncodedHeader(buffer, grid, encoding, error_bound,
+                              block_sizes, 0, NULL, NULL);
+  }
+
+  tfree(block_sizes);
+
+  /* The block index replaces the .dist file */
+  if (GlobalsPFBWriter != PFB_WRITER_AMPS)
+  {
+    WritePFBinaryBuffer(filename, buffer, size, FALSE);
+    return;
+  }
+
+  if ((file = amps_FFopen(amps_CommWorld, filename, "wb", size)) == NULL)
+  {
+    amps_Printf("Error: can't open output file %s\n", filename);
+    exit(1);
+  }
+
+  amps_WriteChar(file, buffer, size);
+
+  amps_FFclose(file);
+
+  tfree(buffer);
 }
 
 
@@ -129,6 +1112,7 @@ void     WritePFBinary(
 
   int g;
   int p;
+  int write_index;
 
   long size;
 
@@ -156,10 +1140,14 @@ void     WritePFBinary(
   /* open file */
   sprintf(filename, "%s.%s.%s", file_prefix, file_suffix, file_extn);
 
-  if ((file = amps_FFopen(amps_CommWorld, filename, "wb", size)) == NULL)
+  /* Subfiles are only written in the encoded format */
+  if ((GlobalsPFBCompression != PFB_ENCODING_NONE) ||
+      (GlobalsPFBWriter == PFB_WRITER_SUBFILE))
   {
-    amps_Printf("Error: can't open output file %s\n", filename);
-    exit(1);
+    WritePFBinaryEncoded(filename, v, GlobalsPFBCompression, 0.0);
+
+    EndTiming(PFBTimingIndex);
+    return;
   }
 
   /* Compute number of patches to write */
@@ -172,6 +1160,53 @@ void     WritePFBinary(
     amps_FreeInvoice(invoice);
   }
 
+  /* The last rank appends the subgrid index */
+  write_index = GlobalsPFBIndex && (p == amps_Size(amps_CommWorld) - 1);
+  if (write_index)
+  {
+    size += SizeofPFBinaryIndex(num_subgrids);
+  }
+
+  if (GlobalsPFBWriter != PFB_WRITER_AMPS)
+  {
+    char *buffer = NewPFBinaryBuffer(size);
+    char *ptr = buffer;
+
+    if (p == 0)
+    {
+      ptr = PackPFBinaryHeader(ptr,
+                               SubgridNX(GridBackground(grid)),
+                               SubgridNY(GridBackground(grid)),
+                               SubgridNZ(GridBackground(grid)),
+                               num_subgrids);
+    }
+
+    ForSubgridI(g, subgrids)
+    {
+      subgrid = SubgridArraySubgrid(subgrids, g);
+      subvector = VectorSubvector(v, g);
+
+      ptr = PackPFBinary_Subvector(ptr, subvector, subgrid);
+    }
+
+    if (write_index)
+    {
+      ptr = PackPFBinaryIndex(ptr, grid);
+    }
+
+    /* An indexed file does not need a .dist file */
+    WritePFBinaryBuffer(filename, buffer, size, !GlobalsPFBIndex);
+
+    EndTiming(PFBTimingIndex);
+    return;
+  }
+
+  if ((file = amps_FFopen(amps_CommWorld, filename, "wb", size)) == NULL)
+  {
+    amps_Printf("Error: can't open output file %s\n", filename);
+    exit(1);
+  }
+
 
   if (p == 0)
   {
@@ -198,11 +1233,124 @@ void     WritePFBinary(
     WritePFBinary_Subvector(file, subvector, subgrid);
   }
 
+  if (write_index)
+  {
+    long index_size = SizeofPFBinaryIndex(num_subgrids);
+    char *buffer = talloc(char, index_size);
+
+    PackPFBinaryIndex(buffer, grid);
+    amps_WriteChar(file, buffer, index_size);
+
+    tfree(buffer);
+  }
+
   amps_FFclose(file);
 
   EndTiming(PFBTimingIndex);
 }
 
+/*--------------------------------------------------------------------------
+ * WritePFBinaryQuantized
+ *
+ * Write v like WritePFBinary, but quantized so every value in the file is
+ * within error_bound of the value in v (see PFBQuantize).  The file is
+ * also compressed if PFB.Compression is set.  An error_bound of zero
+ * writes the plain, lossless file.
+ *--------------------------------------------------------------------------*/
+
+void     WritePFBinaryQuantized(
+                                char *  file_prefix,
+                                char *  file_suffix,
+                                Vector *v,
+                                double  error_bound)
+{
+  char filename[255];
+
+#ifdef AMPS_SPLIT_FILE
+  /* Split files can only hold the plain format */
+  error_bound = 0.0;
+#endif
+
+  if (error_bound <= 0.0)
+  {
+    WritePFBinary(file_prefix, file_suffix, v);
+    return;
+  }
+
+  BeginTiming(PFBTimingIndex);
+
+  sprintf(filename, "%s.%s.pfb", file_prefix, file_suffix);
+
+  WritePFBinaryEncoded(filename, v,
+                       GlobalsPFBCompression | PFB_ENCODING_QUANTIZE,
+                       error_bound);
+
+  EndTiming(PFBTimingIndex);
+}
+
+/*--------------------------------------------------------------------------
+ * WritePFBinarySingle
+ *
+ * Write v like WritePFBinary, but with the values rounded to single
+ * precision (PFB_ENCODING_FLOAT), which halves the file size.  The file
+ * is also compressed if PFB.Compression is set.  If single_precision is
+ * FALSE the plain, double precision file is written.
+ *--------------------------------------------------------------------------*/
+
+void     WritePFBinarySingle(
+                             char *  file_prefix,
+                             char *  file_suffix,
+                             Vector *v,
+                             int     single_precision)
+{
+  char filename[255];
+
+#ifdef AMPS_SPLIT_FILE
+  /* Split files can only hold the plain format */
+  single_precision = FALSE;
+#endif
+
+  if (!single_precision)
+  {
+    WritePFBinary(file_prefix, file_suffix, v);
+    return;
+  }
+
+  BeginTiming(PFBTimingIndex);
+
+  sprintf(filename, "%s.%s.pfb", file_prefix, file_suffix);
+
+  WritePFBinaryEncoded(filename, v,
+                       GlobalsPFBCompression | PFB_ENCODING_FLOAT, 0.0);
+
+  EndTiming(PFBTimingIndex);
+}
+
+/*--------------------------------------------------------------------------
+ * WritePFBinaryOutput
+ *
+ * Write an output field with the encoding chosen for it: single precision
+ * if single_precision is set, quantized if error_bound is positive, the
+ * plain file otherwise.  The two can not both be set for a field.
+ *--------------------------------------------------------------------------*/
+
+void     WritePFBinaryOutput(
+                             char *  file_prefix,
+                             char *  file_suffix,
+                             Vector *v,
+                             int     single_precision,
+                             double  error_bound)
+{
+  if (single_precision)
+  {
+    WritePFBinarySingle(file_prefix, file_suffix, v, TRUE);
+  }
+  else
+  {
+    WritePFBinaryQuantized(file_prefix, file_suffix, v, error_bound);
+  }
+}
+
 long SizeofPFSBinarySubvector(
                               Subvector *subvector,
                               Subgrid *  subgrid,
@@ -309,6 +1457,62 @@ void       WritePFSBinary_Subvector(
   });
 }
 
+
+char      *PackPFSBinary_Subvector(
+                                   char *     buf,
+                                   Subvector *subvector,
+                                   Subgrid *  subgrid,
+                                   double     drop_tolerance)
+{
+  int ix = SubgridIX(subgrid);
+  int iy = SubgridIY(subgrid);
+  int iz = SubgridIZ(subgrid);
+
+  int nx = SubgridNX(subgrid);
+  int ny = SubgridNY(subgrid);
+  int nz = SubgridNZ(subgrid);
+
+  int nx_v = SubvectorNX(subvector);
+  int ny_v = SubvectorNY(subvector);
+  int nz_v = SubvectorNZ(subvector);
+
+  int i, j, k, ai, n;
+  double         *data;
+
+  buf = PackPFBinarySubgridHeader(buf, subgrid);
+
+  data = SubvectorElt(subvector, ix, iy, iz);
+
+  ai = 0; n = 0;
+  BoxLoopI1(i, j, k,
+            ix, iy, iz, nx, ny, nz,
+            ai, nx_v, ny_v, nz_v, 1, 1, 1,
+  {
+    if (fabs(data[ai]) > drop_tolerance)
+    {
+      n++;
+    }
+  });
+
+  buf = PFBPackInt(buf, &n, 1);
+
+  ai = 0;
+  BoxLoopI1(i, j, k,
+            ix, iy, iz, nx, ny, nz,
+            ai, nx_v, ny_v, nz_v, 1, 1, 1,
+  {
+    if (fabs(data[ai]) > drop_tolerance)
+    {
+      buf = PFBPackInt(buf, &i, 1);
+      buf = PFBPackInt(buf, &j, 1);
+      buf = PFBPackInt(buf, &k, 1);
+      buf = PFBPackDouble(buf, &data[ai], 1);
+    }
+  });
+
+  return buf;
+}
+
 void     WritePFSBinary(
                         char *  file_prefix,
                         char *  file_suffix,
@@ -350,6 +1554,34 @@ void     WritePFSBinary(
   /* open file */
   sprintf(filename, "%s.%s.%s", file_prefix, file_suffix, file_extn);
 
+  if (GlobalsPFBWriter != PFB_WRITER_AMPS)
+  {
+    char *buffer = NewPFBinaryBuffer(size);
+    char *ptr = buffer;
+
+    if (p == 0)
+    {
+      ptr = PackPFBinaryHeader(ptr,
+                               BackgroundNX(GlobalsBackground),
+                               BackgroundNY(GlobalsBackground),
+                               BackgroundNZ(GlobalsBackground),
+                               P);
+    }
+
+    ForSubgridI(g, subgrids)
+    {
+      subgrid = SubgridArraySubgrid(subgrids, g);
+      subvector = VectorSubvector(v, g);
+
+      ptr = PackPFSBinary_Subvector(ptr, subvector, subgrid, drop_tolerance);
+    }
+
+    WritePFBinaryBuffer(filename, buffer, size, TRUE);
+
+    EndTiming(PFSBTimingIndex);
+    return;
+  }
+
   if ((file = amps_FFopen(amps_CommWorld, filename, "wb", size)) == NULL)
   {
     amps_Printf("Error: can't open output file %s\n", filename);
@@ -371,6 +371,30 @@ void CloseNC(int ncID)
 #endif
 }
 
+/* Returns the external NetCDF type for a field; NC_FLOAT when the
+ * given SinglePrecision key is True.  NetCDF converts the double
+ * buffers written by PutDataInNC to the variable type on the fly. */
+int NCFieldType(char *key)
+{
+#ifdef PARFLOW_HAVE_NETCDF
+  char *switch_name = GetStringDefault(key, "False");
+
+  if (strcmp(switch_name, "True") == 0)
+  {
+    return NC_FLOAT;
+  }
+  else if (strcmp(switch_name, "False") != 0)
+  {
+    InputError("Error: invalid value <%s> for key <%s>\n",
+               switch_name, key);
+  }
+  return NC_DOUBLE;
+#else
+  PF_UNUSED(key);
+  return 0;
+#endif
+}
+
 int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
 {
 #ifdef PARFLOW_HAVE_NETCDF
@@ -434,7 +458,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteSaturation.SinglePrecision");
     (*myVarNCData)->dimSize = 4;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = netCDFIDs[1];
@@ -844,7 +868,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteEvapTrans.SinglePrecision");
     (*myVarNCData)->dimSize = 4;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = netCDFIDs[1];
@@ -882,7 +906,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteEvapTransSum.SinglePrecision");
     (*myVarNCData)->dimSize = 4;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = netCDFIDs[1];
@@ -919,7 +943,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteOverlandSum.SinglePrecision");
     (*myVarNCData)->dimSize = 3;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = netCDFIDs[1];
@@ -955,7 +979,7 @@ int LookUpInventory(char * varName, varNCData **myVarNCData, int *netCDFIDs)
   {
     *myVarNCData = malloc(sizeof(varNCData));
     (*myVarNCData)->varName = varName;
-    (*myVarNCData)->ncType = NC_DOUBLE;
+    (*myVarNCData)->ncType = NCFieldType("NetCDF.WriteOverlandBCFlux.SinglePrecision");
     (*myVarNCData)->dimSize = 3;
     (*myVarNCData)->dimIDs = malloc((*myVarNCData)->dimSize * sizeof(int));
     (*myVarNCData)->dimIDs[0] = netCDFIDs[1];
@@ -277,6 +277,7 @@ void     WriteSiloInit(char *file_prefix)
                              "qflx_evap_veg",
                              "qflx_tran_veg",
                              "qflx_infl",
+                             "qflx_top_soil",
                              "swe_out",
                              "t_grnd",
                              "t_soil",
@@ -288,7 +289,7 @@ void     WriteSiloInit(char *file_prefix)
                              "overland_bc_flux", };
 
     // IMF -- added second '+2' to next line...
-    for (i = 0; i < 31 + 2; i++)
+    for (i = 0; i < 31 + 3; i++)
     {
       sprintf(filename, "%s/%s", file_prefix, output_types[i]);
       pf_mk_dir(filename);
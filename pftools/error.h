@@ -115,6 +115,7 @@ static char *GETSUBBOXUSAGE = "Usage: pfgetsubbox dataset il jl kl iu ju ku\n";
 static char *ENLARGEBOXUSAGE = "Usage: pfenlargebox dataset new_nx new_ny new_nz\n";
 static char *LOADPFUSAGE = "Usage: pfload [-filetype] filename\n       file types: pfb pfsb sa sb rsa\n";
 static char *RELOADUSAGE = "Usage: pfreload dataset\n";
+static char *LOADSUBBOXUSAGE = "Usage: pfloadsubbox filename il jl kl iu ju ku [default_value]\n";
 static char *SAVEPFUSAGE = "Usage: pfsave dataset -filetype filename\n       file types: pfb sa sb\n";
 static char *GETLISTUSAGE = "Usage: pfgetlist [dataset]\n";
 static char *GETELTUSAGE = "Usage: pfgetelt dataset i j k\n";
@@ -72,6 +72,7 @@ namespace eval Parflow {
     namespace export pfenlargebox
     namespace export pfload
     namespace export pfreload
+    namespace export pfloadsubbox
     namespace export pfreloadall
     namespace export pfdist
     namespace export pfsave
@@ -270,7 +271,13 @@ proc Parflow::pfrun { runname args } {
 	set R 1
     }
 
-    set NumProcs [expr $P * $Q * $R]
+    if [pfexists Process.IOServers] {
+	set IOServers [pfget Process.IOServers]
+    } {
+	set IOServers 0
+    }
+
+    set NumProcs [expr $P * $Q * $R + $IOServers]
 
     # Run parflow
     if [pfexists Process.Command] {
@@ -142,6 +142,8 @@ EXPORT(int, Parflow_Init)(Tcl_Interp * interp)
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfreload", (Tcl_CmdProc*)ReLoadPFCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
+  Tcl_CreateCommand(interp, "Parflow::pfloadsubbox", (Tcl_CmdProc*)LoadSubBoxCommand,
+                    (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfdist", (Tcl_CmdProc*)PFDistCommand,
                     (ClientData)data, (Tcl_CmdDeleteProc*)NULL);
   Tcl_CreateCommand(interp, "Parflow::pfsave", (Tcl_CmdProc*)SavePFCommand,
@@ -491,6 +491,17 @@ proc Parflow::pfhelp {{cmd all}} {
 from disk\n"
 }
 
+    pfloadsubbox  {
+
+                    puts "Usage      : pfloadsubbox filename il jl kl iu ju ku \[default_value\]\n"
+                    puts "Description: This command loads the subbox starting at il, jl, kl"
+                    puts "             and going to iu, ju, ku of a ParFlow binary file"
+                    puts "             without reading the rest of the file.  Files written"
+                    puts "             with a subgrid index (PFB.Index) are read by seeking"
+                    puts "             directly to the requested data.  An identifier used"
+                    puts "             to represent the data set is returned.\n"
+                  }
+
     pfloadsds     {
 
                     puts "Usage      : pfloadsds filename dsnum\n"
@@ -1207,6 +1207,93 @@ int            LoadPFCommand(
   return TCL_OK;
 }
 
+/*-----------------------------------------------------------------------
+ * routine for `pfloadsubbox' command
+ * Description: Load the cells il <= i < iu, jl <= j < ju, kl <= k < ku
+ *              of a ParFlow binary file without reading the rest of the
+ *              file.
+ * Cmd. syntax: pfloadsubbox filename il jl kl iu ju ku [default_value]
+ *-----------------------------------------------------------------------*/
+
+int            LoadSubBoxCommand(
+                                 ClientData  clientData,
+                                 Tcl_Interp *interp,
+                                 int         argc,
+                                 char *      argv[])
+{
+  Data       *data = (Data*)clientData;
+
+  Databox    *databox;
+
+  char       *filename;
+  char newhashkey[MAX_KEY_SIZE];
+
+  int lower[3], upper[3];
+  int i;
+
+  double default_value = 0.0;
+
+
+  if ((argc != 8) && (argc != 9))
+  {
+    WrongNumArgsError(interp, LOADSUBBOXUSAGE);
+    return TCL_ERROR;
+  }
+
+  filename = argv[1];
+
+  /* Make sure il jl kl iu ju and ku are all integers */
+
+  for (i = 0; i < 3; i++)
+  {
+    if (Tcl_GetInt(interp, argv[2 + i], &lower[i]) == TCL_ERROR)
+    {
+      NotAnIntError(interp, 2 + i, LOADSUBBOXUSAGE);
+      return TCL_ERROR;
+    }
+  }
+
+  for (i = 0; i < 3; i++)
+  {
+    if (Tcl_GetInt(interp, argv[5 + i], &upper[i]) == TCL_ERROR)
+    {
+      NotAnIntError(interp, 5 + i, LOADSUBBOXUSAGE);
+      return TCL_ERROR;
+    }
+  }
+
+  if (argc == 9)
+  {
+    if (Tcl_GetDouble(interp, argv[8], &default_value) == TCL_ERROR)
+    {
+      NotADoubleError(interp, 8, LOADSUBBOXUSAGE);
+      return TCL_ERROR;
+    }
+  }
+
+  databox = ReadParflowBSubBox(filename,
+                               lower[0], lower[1], lower[2],
+                               upper[0], upper[1], upper[2],
+                               default_value);
+
+  if (databox)
+  {
+    if (!AddData(data, databox, filename, newhashkey))
+      FreeDatabox(databox);
+    else
+    {
+      Tcl_AppendElement(interp, newhashkey);
+    }
+  }
+  else
+  {
+    ReadWriteError(interp);
+    return TCL_ERROR;
+  }
+
+  return TCL_OK;
+}
+
 #ifdef HAVE_HDF
 
 /*-----------------------------------------------------------------------
@@ -105,6 +105,7 @@ int GetSubBoxCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *
 int EnlargeBoxCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int ReLoadPFCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int LoadPFCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
+int LoadSubBoxCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int LoadSDSCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int SavePFCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
 int SaveSDSCommand(ClientData clientData, Tcl_Interp *interp, int argc, char *argv []);
@@ -41,16 +41,22 @@
 
 #include "readdatabox.h"
 #include "tools_io.h"
+#include "general.h"
 
 #ifdef HAVE_SILO
 #include "silo.h"
 #endif
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <unistd.h>
 
+#ifdef PARFLOW_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 #define round(x) ((x) >= 0 ? (double)((x) + 0.5) : (double)((x) - 0.5))
 
 /*-----------------------------------------------------------------------
@@ -316,6 +322,249 @@ Databox         *ReadSilo(char *filename, double default_value)
 #endif
 }
 
+/*-----------------------------------------------------------------------
+ * read the blocks of an encoded binary `parflow' file
+ *
+ * Encoded files store the negated number of subgrids in the header.
+ * The header is followed by the encoding and a block index holding the
+ * subgrid header, offset and size of every block.  The blocks of the
+ * subgrids overlapping the box il <= i < iu, jl <= j < ju, kl <= k < ku
+ * are decoded into v, which starts at (il, jl, kl).  The blocks of
+ * subfiled files are read from the subfiles of file_name.  Returns 0 on
+ * success.
+ *-----------------------------------------------------------------------*/
+
+static int ReadParflowBEncoded(
+                               FILE *   fp,
+                               char *   file_name,
+                               int      num_subgrids,
+                               Databox *v,
+                               int      il,
+                               int      jl,
+                               int      kl,
+                               int      iu,
+                               int      ju,
+                               int      ku)
+{
+  int encoding;
+  int sg_header[9];
+  int words[2];
+  long index_offset, offset, size, n, i;
+  double error_bound = 0.0;
+
+  unsigned char   *block;
+  unsigned char   *bytes;
+  unsigned char   *ptr;
+  double          *values;
+  uint64_t x;
+
+  int             *subfiles = NULL;
+  FILE            *block_fp = fp;
+  FILE            *subfile_fp = NULL;
+  char subfile_name[2048];
+  int subfile = -1;
+  int status = 0;
+
+  int lx, ly, lz, ux, uy, uz;
+  int nsg, j, k, b;
+  int width;
+  int bits, num_acc;
+  uint64_t acc, mask;
+  double min;
+
+
+  index_offset = 6 * tools_SizeofDouble + 5 * tools_SizeofInt;
+
+  fseek(fp, index_offset - tools_SizeofInt, SEEK_SET);
+  tools_ReadInt(fp, &encoding, 1);
+
+  /* Single precision files store 4 byte floats */
+  width = (encoding & PFB_ENCODING_FLOAT) ? 4 : 8;
+
+  /* Quantized files store the error bound before the index */
+  if (encoding & PFB_ENCODING_QUANTIZE)
+  {
+    tools_ReadDouble(fp, &error_bound, 1);
+    index_offset += tools_SizeofDouble;
+  }
+
+  /* Subfiled files store the subfile of every block before the index */
+  if (encoding & PFB_ENCODING_SUBFILE)
+  {
+    int num_subfiles;
+
+    subfiles = (int*)malloc(num_subgrids * sizeof(int));
+    tools_ReadInt(fp, &num_subfiles, 1);
+    tools_ReadInt(fp, subfiles, num_subgrids);
+    index_offset += (long)(1 + num_subgrids) * tools_SizeofInt;
+  }
+
+  for (nsg = 0; nsg < num_subgrids; nsg++)
+  {
+    fseek(fp, index_offset + (long)nsg * PFB_ENCODED_ENTRY_SIZE, SEEK_SET);
+
+    tools_ReadInt(fp, sg_header, 9);
+
+    /* 64 bit values are stored big endian, high word first */
+    tools_ReadInt(fp, words, 2);
+    offset = ((long)(unsigned int)words[0] << 32) | (unsigned int)words[1];
+    tools_ReadInt(fp, words, 2);
+    size = ((long)(unsigned int)words[0] << 32) | (unsigned int)words[1];
+
+    lx = max(il, sg_header[0]);
+    ly = max(jl, sg_header[1]);
+    lz = max(kl, sg_header[2]);
+    ux = min(iu, sg_header[0] + sg_header[3]);
+    uy = min(ju, sg_header[1] + sg_header[4]);
+    uz = min(ku, sg_header[2] + sg_header[5]);
+
+    if ((lx >= ux) || (ly >= uy) || (lz >= uz))
+      continue;
+
+    n = (long)sg_header[3] * sg_header[4] * sg_header[5];
+
+    if (subfiles && (subfiles[nsg] != subfile))
+    {
+      if (subfile_fp)
+        fclose(subfile_fp);
+
+      subfile = subfiles[nsg];
+      sprintf(subfile_name, PFB_SUBFILE_NAME, file_name, subfile);
+      if ((subfile_fp = fopen(subfile_name, "rb")) == NULL)
+      {
+        status = 1;
+        break;
+      }
+      block_fp = subfile_fp;
+    }
+
+    block = (unsigned char*)malloc(size);
+    fseek(block_fp, offset, SEEK_SET);
+    if (fread(block, 1, size, block_fp) != (size_t)size)
+    {
+      free(block);
+      status = 1;
+      break;
+    }
+
+    bytes = block;
+    if (encoding & PFB_ENCODING_DEFLATE)
+    {
+#ifdef PARFLOW_HAVE_ZLIB
+      long raw_size = n * width;
+      uLongf len;
+
+      if (encoding & PFB_ENCODING_QUANTIZE)
+        raw_size = n * tools_SizeofDouble + tools_SizeofDouble + tools_SizeofInt;
+
+      len = (uLongf)raw_size;
+
+      bytes = (unsigned char*)malloc(len);
+      if ((uncompress(bytes, &len, block, (uLong)size) != Z_OK) ||
+          ((long)len > raw_size) ||
+          (!(encoding & PFB_ENCODING_QUANTIZE) && ((long)len != raw_size)))
+      {
+        free(bytes);
+        free(block);
+        status = 1;
+        break;
+      }
+#else
+      printf("Error: zlib was not used in build\n");
+      free(block);
+      status = 1;
+      break;
+#endif
+    }
+
+    values = (double*)malloc(n * sizeof(double));
+    if (encoding & PFB_ENCODING_QUANTIZE)
+    {
+      /* double min, int bits, then the integers packed msb first, or
+       * plain big endian doubles if bits is 64 */
+      x = 0;
+      for (b = 0; b < 8; b++)
+        x = (x << 8) | bytes[b];
+      memcpy(&min, &x, sizeof(double));
+      bits = (bytes[8] << 24) | (bytes[9] << 16) | (bytes[10] << 8) | bytes[11];
+
+      mask = (bits < 64) ? (((uint64_t)1) << bits) - 1 : 0;
+      acc = 0;
+      num_acc = 0;
+      ptr = bytes + 12;
+      for (i = 0; i < n; i++)
+      {
+        if (bits == 64)
+        {
+          x = 0;
+          for (b = 0; b < 8; b++)
+            x = (x << 8) | *ptr++;
+          memcpy(&values[i], &x, sizeof(double));
+          continue;
+        }
+
+        while (num_acc < bits)
+        {
+          acc = (acc << 8) | *ptr++;
+          num_acc += 8;
+        }
+        num_acc -= bits;
+
+        values[i] = min + (double)((acc >> num_acc) & mask) * 2.0 * error_bound;
+      }
+    }
+    else
+    {
+      /* Assemble the big endian values, which are byte shuffled in
+       * compressed blocks */
+      for (i = 0; i < n; i++)
+      {
+        x = 0;
+        for (b = 0; b < width; b++)
+        {
+          x = (x << 8) | ((encoding & PFB_ENCODING_DEFLATE) ? bytes[b * n + i]
+                          : bytes[i * width + b]);
+        }
+
+        if (width == 4)
+        {
+          uint32_t x32 = (uint32_t)x;
+          float f;
+
+          memcpy(&f, &x32, sizeof(float));
+          values[i] = (double)f;
+        }
+        else
+        {
+          memcpy(&values[i], &x, sizeof(double));
+        }
+      }
+    }
+
+    for (k = lz; k < uz; k++)
+      for (j = ly; j < uy; j++)
+      {
+        memcpy(DataboxCoeff(v, lx - il, j - jl, k - kl),
+               &values[(((long)(k - sg_header[2]) * sg_header[4]
+                         + (j - sg_header[1])) * sg_header[3])
+                       + (lx - sg_header[0])],
+               (ux - lx) * sizeof(double));
+      }
+
+    free(values);
+    if (bytes != block)
+      free(bytes);
+    free(block);
+  }
+
+  if (subfile_fp)
+    fclose(subfile_fp);
+  free(subfiles);
+
+  return status;
+}
+
+
 /*-----------------------------------------------------------------------
  * read a binary `parflow' file
  *-----------------------------------------------------------------------*/
@@ -368,6 +617,18 @@ Databox         *ReadParflowB(
     return((Databox*)NULL);
   }
 
+  if (num_subgrids < 0)
+  {
+    if (ReadParflowBEncoded(fp, file_name, -num_subgrids, v, 0, 0, 0, NX, NY, NZ))
+    {
+      FreeDatabox(v);
+      v = NULL;
+    }
+
+    fclose(fp);
+    return v;
+  }
+
   /* read in the databox data */
   for (nsg = num_subgrids; nsg--;)
   {
@@ -398,6 +659,211 @@ Databox         *ReadParflowB(
 }
 
 
+/*-----------------------------------------------------------------------
+ * read the subgrid index at the end of a binary `parflow' file
+ *
+ * Fills in the extents (x y z nx ny nz) and data offsets of the
+ * subgrids and returns 1 if the file has an index, otherwise 0.
+ *-----------------------------------------------------------------------*/
+
+static int ReadParflowBIndex(
+                             FILE *fp,
+                             int   num_subgrids,
+                             int * extents,
+                             long *offsets)
+{
+  char magic[4];
+  int words[2];
+  int version;
+  long file_size, index_offset;
+  int sg_header[9];
+  int nsg, i;
+
+
+  if (fseek(fp, 0L, SEEK_END) ||
+      ((file_size = ftell(fp)) < PFB_INDEX_TRAILER_SIZE))
+    return 0;
+
+  fseek(fp, file_size - PFB_INDEX_TRAILER_SIZE, SEEK_SET);
+
+  tools_ReadInt(fp, words, 2);
+  tools_ReadInt(fp, &version, 1);
+  if (fread(magic, 1, 4, fp) != 4 || strncmp(magic, PFB_INDEX_MAGIC, 4))
+    return 0;
+
+  /* 64 bit offsets are stored big endian, high word first */
+  index_offset = ((long)(unsigned int)words[0] << 32) | (unsigned int)words[1];
+
+  if ((version != PFB_INDEX_VERSION) ||
+      (index_offset + (long)num_subgrids * PFB_INDEX_ENTRY_SIZE
+       + PFB_INDEX_TRAILER_SIZE != file_size))
+    return 0;
+
+  fseek(fp, index_offset, SEEK_SET);
+
+  for (nsg = 0; nsg < num_subgrids; nsg++)
+  {
+    tools_ReadInt(fp, sg_header, 9);
+    tools_ReadInt(fp, words, 2);
+
+    for (i = 0; i < 6; i++)
+      extents[6 * nsg + i] = sg_header[i];
+
+    offsets[nsg] = ((long)(unsigned int)words[0] << 32) | (unsigned int)words[1];
+  }
+
+  return 1;
+}
+
+
+/*-----------------------------------------------------------------------
+ * read a box from a binary `parflow' file
+ *
+ * Only the cells il <= i < iu, jl <= j < ju, kl <= k < ku are read.
+ * The subgrids are located with the subgrid index when the file has
+ * one, otherwise by seeking from subgrid header to subgrid header.
+ *-----------------------------------------------------------------------*/
+
+Databox         *ReadParflowBSubBox(
+                                    char * file_name,
+                                    int    il,
+                                    int    jl,
+                                    int    kl,
+                                    int    iu,
+                                    int    ju,
+                                    int    ku,
+                                    double default_value)
+{
+  Databox         *v;
+
+  FILE           *fp;
+
+  double X, Y, Z;
+  int NX, NY, NZ;
+  double DX, DY, DZ;
+  int num_subgrids;
+
+  int            *extents;
+  long           *offsets;
+  long offset;
+
+  int sg_header[9];
+  int lx, ly, lz, ux, uy, uz;
+  int nsg, j, k;
+
+  int            *ext;
+
+
+  /* open the input file */
+  if ((fp = fopen(file_name, "rb")) == NULL)
+    return NULL;
+
+  /* read in header info */
+  tools_ReadDouble(fp, &X, 1);
+  tools_ReadDouble(fp, &Y, 1);
+  tools_ReadDouble(fp, &Z, 1);
+
+  tools_ReadInt(fp, &NX, 1);
+  tools_ReadInt(fp, &NY, 1);
+  tools_ReadInt(fp, &NZ, 1);
+
+  tools_ReadDouble(fp, &DX, 1);
+  tools_ReadDouble(fp, &DY, 1);
+  tools_ReadDouble(fp, &DZ, 1);
+
+  tools_ReadInt(fp, &num_subgrids, 1);
+
+  /* clip the box to the grid */
+  il = max(il, 0);
+  jl = max(jl, 0);
+  kl = max(kl, 0);
+  iu = min(iu, NX);
+  ju = min(ju, NY);
+  ku = min(ku, NZ);
+
+  if ((il >= iu) || (jl >= ju) || (kl >= ku))
+  {
+    fclose(fp);
+    return((Databox*)NULL);
+  }
+
+  /* create the new databox structure */
+  if ((v = NewDataboxDefault(iu - il, ju - jl, ku - kl,
+                             X + il * DX, Y + jl * DY, Z + kl * DZ,
+                             DX, DY, DZ, default_value)) == NULL)
+  {
+    fclose(fp);
+    return((Databox*)NULL);
+  }
+
+  if (num_subgrids < 0)
+  {
+    if (ReadParflowBEncoded(fp, file_name, -num_subgrids, v, il, jl, kl, iu, ju, ku))
+    {
+      FreeDatabox(v);
+      v = NULL;
+    }
+
+    fclose(fp);
+    return v;
+  }
+
+  extents = (int*)malloc(6 * (num_subgrids + 1) * sizeof(int));
+  offsets = (long*)malloc((num_subgrids + 1) * sizeof(long));
+
+  /* locate the subgrids */
+  if (!ReadParflowBIndex(fp, num_subgrids, extents, offsets))
+  {
+    offset = 6 * tools_SizeofDouble + 4 * tools_SizeofInt;
+
+    for (nsg = 0; nsg < num_subgrids; nsg++)
+    {
+      fseek(fp, offset, SEEK_SET);
+      tools_ReadInt(fp, sg_header, 9);
+
+      for (j = 0; j < 6; j++)
+        extents[6 * nsg + j] = sg_header[j];
+
+      offset += 9 * tools_SizeofInt;
+      offsets[nsg] = offset;
+      offset += (long)sg_header[3] * sg_header[4] * sg_header[5] * tools_SizeofDouble;
+    }
+  }
+
+  /* read the rows of each subgrid that fall inside the box */
+  for (nsg = 0; nsg < num_subgrids; nsg++)
+  {
+    ext = &extents[6 * nsg];
+
+    lx = max(il, ext[0]);
+    ly = max(jl, ext[1]);
+    lz = max(kl, ext[2]);
+    ux = min(iu, ext[0] + ext[3]);
+    uy = min(ju, ext[1] + ext[4]);
+    uz = min(ku, ext[2] + ext[5]);
+
+    if ((lx >= ux) || (ly >= uy) || (lz >= uz))
+      continue;
+
+    for (k = lz; k < uz; k++)
+      for (j = ly; j < uy; j++)
+      {
+        offset = offsets[nsg] +
+                 ((((long)(k - ext[2]) * ext[4] + (j - ext[1])) * ext[3])
+                  + (lx - ext[0])) * tools_SizeofDouble;
+        fseek(fp, offset, SEEK_SET);
+        tools_ReadDouble(fp, DataboxCoeff(v, lx - il, j - jl, k - kl), ux - lx);
+      }
+  }
+
+  free(extents);
+  free(offsets);
+
+  fclose(fp);
+  return v;
+}
+
+
 /*-----------------------------------------------------------------------
  * read a scattered binary `parflow' file
  *-----------------------------------------------------------------------*/
@@ -450,6 +916,18 @@ Databox         *ReadParflowSB(
     return((Databox*)NULL);
   }
 
+  if (num_subgrids < 0)
+  {
+    if (ReadParflowBEncoded(fp, file_name, -num_subgrids, v, 0, 0, 0, NX, NY, NZ))
+    {
+      FreeDatabox(v);
+      v = NULL;
+    }
+
+    fclose(fp);
+    return v;
+  }
+
   /* read in the databox data */
   for (nsg = num_subgrids; nsg--;)
   {
@@ -59,12 +59,35 @@ extern "C" {
 #define NULL ((void*)0)
 #endif
 
+/*-----------------------------------------------------------------------
+ * Subgrid index optionally appended to binary `parflow' files by the
+ * simulator (PFB.Index), see PackPFBinaryIndex in parflow_lib.
+ *-----------------------------------------------------------------------*/
+
+#define PFB_INDEX_MAGIC        "PFBI"
+#define PFB_INDEX_VERSION      1
+#define PFB_INDEX_ENTRY_SIZE   (9 * 4 + 8)
+#define PFB_INDEX_TRAILER_SIZE (8 + 4 + 4)
+
+/*-----------------------------------------------------------------------
+ * Encoded binary `parflow' files written by the simulator
+ * (PFB.Compression), see PackPFBinaryEncodedHeader in parflow_lib.
+ *-----------------------------------------------------------------------*/
+
+#define PFB_ENCODING_DEFLATE   1
+#define PFB_ENCODING_QUANTIZE  2
+#define PFB_ENCODING_FLOAT     4
+#define PFB_ENCODING_SUBFILE   8
+#define PFB_SUBFILE_NAME       "%s.sub%05d"
+#define PFB_ENCODED_ENTRY_SIZE (9 * 4 + 8 + 8)
+
 /*-----------------------------------------------------------------------
  * function prototypes
  *-----------------------------------------------------------------------*/
 
 /* readdatabox.c */
 Databox *ReadParflowB(char *file_name, double default_value);
+Databox *ReadParflowBSubBox(char *file_name, int il, int jl, int kl, int iu, int ju, int ku, double default_value);
 Databox *ReadParflowSB(char *file_name, double default_value);
 Databox *ReadSimpleA(char *file_name, double default_value);
 Databox *ReadRealSA(char *file_name, double default_value);
@@ -304,6 +304,14 @@ for {set i 0} { $i <= $num_processors } {incr i} {
     file copy drv_clmin.dat drv_clmin.dat.$i
 }
 
+#-----------------------------------------------------------------------------
+# Variants of this problem set setup_only, source this file for the keys
+# above and do their own runs
+#-----------------------------------------------------------------------------
+if [info exists setup_only] {
+    return
+}
+
 #-----------------------------------------------------------------------------
 # Run and Unload the ParFlow output files
 #-----------------------------------------------------------------------------
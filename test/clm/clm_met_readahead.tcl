@@ -0,0 +1,126 @@
+#
+# Run the CLM test case with 2D and 3D met forcing files, read whole
+# and read ahead in the background, and check that the results agree.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set setup_only 1
+source clm.tcl
+
+pfset Solver.Linear.Preconditioner                       NoPC
+
+pfset Solver.WriteSiloCLM                                False
+pfset Solver.WriteSiloEvapTrans                          False
+pfset Solver.WriteSiloOverlandBCFlux                     False
+pfset Solver.PrintCLM                                    False
+
+pfset Solver.CLM.MetFileName                             narr_1hr
+pfset Solver.CLM.MetFilePath                             ./readahead_forcing
+
+#-----------------------------------------------------------------------------
+# Write the 1D forcing as 2D files, one per hour, and as 3D files of 2
+# hours.  The 1D file holds 5 hours, the 6th hour completing the last 3D
+# file repeats the first.  The values vary in x and y so a misplaced time
+# step or cell shows up in the results.
+#-----------------------------------------------------------------------------
+set nx [pfget ComputationalGrid.NX]
+set ny [pfget ComputationalGrid.NY]
+set num_steps 6
+set nt 2
+
+file mkdir readahead_forcing
+set met [open narr_1hr.sc3.txt.0]
+set num_lines 0
+while {[gets $met line] > 0} {
+    incr num_lines
+    set forcing($num_lines) $line
+}
+close $met
+for {set step [expr $num_lines + 1]} {$step <= $num_steps} {incr step} {
+    set forcing($step) $forcing([expr $step - $num_lines])
+}
+
+proc writeForcing {name nx ny values} {
+    set file [open $name.sa w]
+    puts $file "$nx $ny [llength $values]"
+    foreach value $values {
+	for {set j 0} {$j < $ny} {incr j} {
+	    for {set i 0} {$i < $nx} {incr i} {
+		puts $file [expr $value * (1.0 + 0.001 * ($i + 2 * $j))]
+	    }
+	}
+    }
+    close $file
+
+    set data [pfload $name.sa]
+    pfsave $data -pfb $name.pfb
+    pfdelete $data
+    file delete $name.sa
+}
+
+set var 0
+foreach name "DSWR DLWR APCP Temp UGRD VGRD Press SPFH" {
+    for {set step 1} {$step <= $num_steps} {incr step} {
+	writeForcing [format "readahead_forcing/narr_1hr.%s.%06d" $name $step] \
+	    $nx $ny [lindex $forcing($step) $var]
+    }
+    for {set step 1} {$step <= $num_steps} {incr step $nt} {
+	set values ""
+	for {set t 0} {$t < $nt} {incr t} {
+	    lappend values [lindex $forcing([expr $step + $t]) $var]
+	}
+	writeForcing [format "readahead_forcing/narr_1hr.%s.%06d_to_%06d" \
+			  $name $step [expr $step + $nt - 1]] $nx $ny $values
+    }
+    incr var
+}
+
+#-----------------------------------------------------------------------------
+# Run with whole files and with read ahead
+#-----------------------------------------------------------------------------
+pfset Solver.CLM.MetForcing                              2D
+pfrun clm_2d
+pfundist clm_2d
+
+pfset Solver.CLM.MetFileReadAhead                        3
+pfrun clm_2d_readahead
+pfundist clm_2d_readahead
+
+pfset Solver.CLM.MetForcing                              3D
+pfset Solver.CLM.MetFileNT                               $nt
+pfset Solver.CLM.MetFileReadAhead                        0
+pfrun clm_3d
+pfundist clm_3d
+
+pfset Solver.CLM.MetFileReadAhead                        1
+pfrun clm_3d_readahead
+pfundist clm_3d_readahead
+
+#
+# Tests
+#
+set passed 1
+
+foreach run "clm_2d_readahead clm_3d clm_3d_readahead" {
+    for {set i 1} {$i <= 5} {incr i} {
+	set i_string [format "%05d" $i]
+	foreach field "press satur" {
+	    set reference [pfload clm_2d.out.$field.$i_string.pfb]
+	    set data [pfload $run.out.$field.$i_string.pfb]
+	    if {[llength [pfmdiff $reference $data 12]] != 0} {
+		puts "$run: $field for timestep $i_string differs"
+		set passed 0
+	    }
+	    pfdelete $reference
+	    pfdelete $data
+	}
+    }
+}
+
+if $passed {
+    puts "clm_met_readahead : PASSED"
+} {
+    puts "clm_met_readahead : FAILED"
+}
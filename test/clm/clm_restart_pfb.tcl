@@ -0,0 +1,107 @@
+#
+# Run the CLM test case writing its restart state as PFB files, then
+# restart it from one of them on a different process topology and check
+# that the restarted run agrees with the continuous one.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+#
+# The runs are done in their own directory since drv_clmin.dat is changed
+# for the restart
+#
+file delete -force restart_pfb
+file mkdir restart_pfb
+foreach file {drv_clmin.dat drv_vegm.dat drv_vegp.dat narr_1hr.sc3.txt.0} {
+    file copy $file restart_pfb/$file
+}
+cd restart_pfb
+
+set setup_only 1
+source ../clm.tcl
+
+pfset Solver.Linear.Preconditioner                       NoPC
+
+pfset Solver.WriteSiloCLM                                False
+pfset Solver.WriteSiloEvapTrans                          False
+pfset Solver.WriteSiloOverlandBCFlux                     False
+
+pfset Solver.CLM.RestartFormat                           PFB
+pfset Solver.CLM.DailyRST                                False
+pfset Solver.CLM.WriteLastRST                            False
+
+# clm.tcl copied the inputs for the first topology, the restart needs them
+# again for the second
+proc copyInputs {num_processors} {
+    for {set i 0} { $i <= $num_processors } {incr i} {
+	file delete drv_vegm.dat.$i
+	file copy  drv_vegm.dat drv_vegm.dat.$i
+	file delete drv_clmin.dat.$i
+	file copy drv_clmin.dat drv_clmin.dat.$i
+    }
+}
+
+#-----------------------------------------------------------------------------
+# Continuous run, writing a restart file at every step
+#-----------------------------------------------------------------------------
+pfrun clm_full
+pfundist clm_full
+
+#-----------------------------------------------------------------------------
+# Restart after step 2 from the restart file of the continuous run, with
+# the process topology in x and y swapped
+#-----------------------------------------------------------------------------
+set restart_step 2
+set restart_string [format "%05d" $restart_step]
+
+set file [open drv_clmin.dat]
+set clmin [read $file]
+close $file
+regsub -line {^startcode( +)2} $clmin {startcode\11} clmin
+regsub -line {^clm_ic( +)2} $clmin {clm_ic\11} clmin
+set file [open drv_clmin.dat w]
+puts -nonewline $file $clmin
+close $file
+
+pfset Process.Topology.P        [lindex $argv 1]
+pfset Process.Topology.Q        [lindex $argv 0]
+copyInputs [expr [pfget Process.Topology.P] * [pfget Process.Topology.Q] * [pfget Process.Topology.R]]
+
+pfset TimingInfo.StartCount      $restart_step
+pfset TimingInfo.StartTime       $restart_step.0
+pfset Solver.CLM.IstepStart      [expr $restart_step + 1]
+
+pfset ICPressure.Type                                   PFBFile
+pfset Geom.domain.ICPressure.FileName                   clm_full.out.press.$restart_string.pfb
+
+file copy -force clm_full.out.clm_rst.$restart_string.pfb \
+    clm_restart.out.clm_rst.$restart_string.pfb
+
+pfrun clm_restart
+pfundist clm_restart
+
+#
+# Tests
+#
+set passed 1
+
+for {set i [expr $restart_step + 1]} {$i <= 5} {incr i} {
+    set i_string [format "%05d" $i]
+    foreach field "press satur eflx_lh_tot t_grnd t_soil" {
+	set reference [pfload clm_full.out.$field.$i_string.pfb]
+	set data [pfload clm_restart.out.$field.$i_string.pfb]
+	if {[llength [pfmdiff $reference $data 8]] != 0} {
+	    puts "clm_restart: $field for timestep $i_string differs"
+	    set passed 0
+	}
+	pfdelete $reference
+	pfdelete $data
+    }
+}
+
+if $passed {
+    puts "clm_restart_pfb : PASSED"
+} {
+    puts "clm_restart_pfb : FAILED"
+}
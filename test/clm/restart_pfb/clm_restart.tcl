@@ -0,0 +1 @@
+ set istep            5
@@ -0,0 +1,12 @@
+#
+# Run the default_overland PFMG problem with the preconditioner matrix
+# copied into Hypre one cell at a time.  It must match the default box
+# copy of default_overland.pfmg.jac.tcl.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+pfset Solver.Linear.Preconditioner.PFMG.MatrixAssembly   Element
+
+source default_overland.pfmg.jac.tcl
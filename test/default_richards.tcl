@@ -324,6 +324,14 @@ pfset Solver.Linear.Preconditioner                       PFMG
 pfset Solver.Linear.Preconditioner.MGSemi.MaxIter        1
 pfset Solver.Linear.Preconditioner.MGSemi.MaxLevels      100
 
+#-----------------------------------------------------------------------------
+# Variants of this problem set setup_only, source this file for the keys
+# above and do their own runs
+#-----------------------------------------------------------------------------
+if [info exists setup_only] {
+    return
+}
+
 #-----------------------------------------------------------------------------
 # Run and Unload the ParFlow output files
 #-----------------------------------------------------------------------------
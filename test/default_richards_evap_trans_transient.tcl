@@ -0,0 +1,139 @@
+#
+# Run the default_richards problem with a time varying transient evap
+# trans, read from one file per time step, from a single time-stacked
+# file and, looping over fewer time steps, from both.  The files are
+# read one step ahead of their use; the evap trans of every step must be
+# the one of its file and the runs must match.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set setup_only 1
+source default_richards.tcl
+
+pfset TimingInfo.BaseUnit                                0.001
+pfset TimingInfo.StopTime                                0.005
+
+pfset Solver.Linear.Preconditioner                       MGSemi
+
+#-----------------------------------------------------------------------------
+# Evap trans files, one per time step and one with the evap trans of all
+# steps stacked in z.  The values vary in space so a misplaced cell or
+# slice shows up.
+#-----------------------------------------------------------------------------
+pfset Solver.PrintEvapTrans                              True
+pfset Solver.EvapTransFileTransient                      True
+
+set num_steps 5
+set num_loop_steps 3
+
+proc writeEvapTrans {name steps} {
+    set stack [open $name.sa w]
+    puts $stack "10 10 [expr 8 * [llength $steps]]"
+    set n 0
+    foreach step $steps {
+	set file [open [format "%s.%05d.sa" $name $n] w]
+	puts $file "10 10 8"
+	for {set k 0} {$k < 8} {incr k} {
+	    for {set j 0} {$j < 10} {incr j} {
+		for {set i 0} {$i < 10} {incr i} {
+		    set value [expr 1.0e-3 * ($step + 1) * (1.0 + 0.01 * ($i + 10 * $j + 100 * $k))]
+		    puts $file $value
+		    puts $stack $value
+		}
+	    }
+	}
+	close $file
+
+	set data [pfload [format "%s.%05d.sa" $name $n]]
+	pfsave $data -pfb [format "%s.%05d.pfb" $name $n]
+	pfdelete $data
+	file delete [format "%s.%05d.sa" $name $n]
+	incr n
+    }
+    close $stack
+
+    set data [pfload $name.sa]
+    pfsave $data -pfb $name.pfb
+    pfdelete $data
+    file delete $name.sa
+}
+
+set steps ""
+for {set n 0} {$n < $num_steps} {incr n} {
+    lappend steps $n
+}
+writeEvapTrans evap_trans_transient.et $steps
+writeEvapTrans evap_trans_transient.loop [lrange $steps 0 [expr $num_loop_steps - 1]]
+
+#-----------------------------------------------------------------------------
+# Run with one file per step, with the time-stacked file and looping
+# over the first steps with both
+#-----------------------------------------------------------------------------
+pfset Solver.EvapTrans.FileName                          evap_trans_transient.et
+pfrun evap_trans_files
+pfundist evap_trans_files
+
+pfset Solver.EvapTrans.StackFileName                     evap_trans_transient.et.pfb
+pfrun evap_trans_stack
+pfundist evap_trans_stack
+
+pfset Solver.EvapTrans.FileLooping                       True
+pfset Solver.EvapTrans.FileName                          evap_trans_transient.loop
+pfset Solver.EvapTrans.StackFileName                     ""
+pfrun evap_trans_loop_files
+pfundist evap_trans_loop_files
+
+pfset Solver.EvapTrans.StackFileName                     evap_trans_transient.loop.pfb
+pfrun evap_trans_loop_stack
+pfundist evap_trans_loop_stack
+
+#
+# Tests
+#
+set passed 1
+
+foreach run "evap_trans_files evap_trans_stack evap_trans_loop_files evap_trans_loop_stack" {
+    for {set i 1} {$i <= $num_steps} {incr i} {
+	set i_string [format "%05d" $i]
+
+	# Step i uses the file of step i - 1, looping over the first steps
+	if {[string match "evap_trans_loop*" $run]} {
+	    set n [expr ($i - 1) % $num_loop_steps]
+	    set name evap_trans_transient.loop
+	} {
+	    set n [expr $i - 1]
+	    set name evap_trans_transient.et
+	}
+
+	set reference [pfload [format "%s.%05d.pfb" $name $n]]
+	set data [pfload $run.out.evaptrans.$i_string.pfb]
+	if {[llength [pfmdiff $reference $data 12]] != 0} {
+	    puts "$run: evap trans for timestep $i_string differs"
+	    set passed 0
+	}
+	pfdelete $reference
+	pfdelete $data
+    }
+}
+
+foreach {reference run} "evap_trans_files evap_trans_stack evap_trans_loop_files evap_trans_loop_stack" {
+    for {set i 1} {$i <= $num_steps} {incr i} {
+	set i_string [format "%05d" $i]
+	set files [pfload $reference.out.press.$i_string.pfb]
+	set data [pfload $run.out.press.$i_string.pfb]
+	if {[llength [pfmdiff $files $data 12]] != 0} {
+	    puts "$run: pressure for timestep $i_string differs"
+	    set passed 0
+	}
+	pfdelete $files
+	pfdelete $data
+    }
+}
+
+if $passed {
+    puts "default_richards_evap_trans_transient : PASSED"
+} {
+    puts "default_richards_evap_trans_transient : FAILED"
+}
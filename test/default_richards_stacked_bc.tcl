@@ -0,0 +1,132 @@
+#
+# Run the default_richards problem with a time varying flux through the
+# top patch, read once from one flux file per interval and once from a
+# single time-stacked flux file.  Both runs must match.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set setup_only 1
+source default_richards.tcl
+
+pfset TimingInfo.BaseUnit                        0.001
+
+pfset Cycle.Names                                "constant flux"
+pfset Cycle.flux.Names                           "f0 f1 f2"
+pfset Cycle.flux.f0.Length                       2
+pfset Cycle.flux.f1.Length                       2
+pfset Cycle.flux.f2.Length                       2
+pfset Cycle.flux.Repeat                          -1
+
+pfset Patch.top.BCPressure.Type                  FluxFile
+pfset Patch.top.BCPressure.Cycle                 "flux"
+pfset Patch.top.BCPressure.f0.FileName           stacked_bc.flux.0.pfb
+pfset Patch.top.BCPressure.f1.FileName           stacked_bc.flux.1.pfb
+pfset Patch.top.BCPressure.f2.FileName           stacked_bc.flux.2.pfb
+
+pfset Solver.Linear.Preconditioner               MGSemi
+
+#-----------------------------------------------------------------------------
+# Flux files for the top patch, one per interval and one with the fluxes
+# of all intervals stacked in z
+#-----------------------------------------------------------------------------
+set fluxes "-0.05 0.0 -0.1"
+
+set stack [open stacked_bc.flux.sa w]
+puts $stack "10 10 [expr 8 * [llength $fluxes]]"
+set n 0
+foreach flux $fluxes {
+    set file [open stacked_bc.flux.$n.sa w]
+    puts $file "10 10 8"
+    for {set i 0} {$i < 800} {incr i} {
+	puts $file $flux
+	puts $stack $flux
+    }
+    close $file
+
+    set data [pfload stacked_bc.flux.$n.sa]
+    pfsave $data -pfb stacked_bc.flux.$n.pfb
+    pfdelete $data
+    incr n
+}
+close $stack
+
+set data [pfload stacked_bc.flux.sa]
+pfsave $data -pfb stacked_bc.flux.pfb
+pfdelete $data
+
+#-----------------------------------------------------------------------------
+# Run with one file per interval, then with the time-stacked file
+#-----------------------------------------------------------------------------
+
+# The timing files are appended to
+file delete -force stacked_bc_files.out.timing.csv stacked_bc_stack.out.timing.csv
+
+pfrun stacked_bc_files
+pfundist stacked_bc_files
+
+pfset Patch.top.BCPressure.StackFileName         stacked_bc.flux.pfb
+
+pfrun stacked_bc_stack
+pfundist stacked_bc_stack
+
+#
+# Tests
+#
+set passed 1
+
+foreach i "00001 00002 00003 00004 00005" {
+    set files [pfload stacked_bc_files.out.press.$i.pfb]
+    set stack [pfload stacked_bc_stack.out.press.$i.pfb]
+    if {[llength [pfmdiff $files $stack 12]] != 0} {
+	puts "Pressure for timestep $i differs"
+	set passed 0
+    }
+    pfdelete $files
+    pfdelete $stack
+}
+
+# The three intervals of the flux cycle are each read once, however
+# often the boundary conditions are evaluated.  The reads are counted in
+# the timing section of the log.  The timers are only listed in the
+# timing file when timing is enabled, without them the reads can't be
+# checked.
+foreach run "stacked_bc_files stacked_bc_stack" {
+    set timers ""
+    if [file exists $run.out.timing.csv] {
+	set csv [open $run.out.timing.csv]
+	set timers [read $csv]
+	close $csv
+    }
+
+    if ![regexp -line {^BC File Read,} $timers] {
+	puts "$run was run without timing, boundary condition file reads not checked"
+	continue
+    }
+
+    set count 0
+    if [file exists $run.out.log] {
+	set log [open $run.out.log]
+	set timer ""
+	while {[gets $log line] >= 0} {
+	    if [regexp {^(\S.*):$} $line match name] {
+		set timer $name
+	    } elseif {$timer == "BC File Read"} {
+		regexp {count *= *(\d+)} $line match count
+	    }
+	}
+	close $log
+    }
+
+    if {$count != 3} {
+	puts "$run read the boundary condition files $count times"
+	set passed 0
+    }
+}
+
+if $passed {
+    puts "default_richards_stacked_bc : PASSED"
+} {
+    puts "default_richards_stacked_bc : FAILED"
+}
@@ -9,7 +9,12 @@ lappend auto_path $env(PARFLOW_DIR)/bin
 package require parflow
 namespace import Parflow::*
 
-set runname default_richards_wells
+# default_richards_wells_*.tcl run this deck under their own runname and
+# are checked against its regression files, see pftestCorrectFile
+set pftest_base_run default_richards_wells
+if ![info exists runname] {
+    set runname default_richards_wells
+}
 
 # Examples of compression options for SILO
 # Note compression only works for HDF5
@@ -375,10 +380,10 @@ if ![pftestFile $runname.out.perm_z.pfb "Max difference in perm_z" $sig_digits]
 }
 
 foreach i "00000 00001 00002 00003 00004 00005" {
-    if ![pftestFile $runname.out.press.$i.pfb "Max difference in Pressure for timestep $i" $sig_digits] {
+    if ![pftestFileWithKeyBound $runname.out.press.$i.pfb "Max difference in Pressure for timestep $i" $sig_digits Solver.PrintPressure.ErrorBound] {
     set passed 0
 }
-    if ![pftestFile $runname.out.satur.$i.pfb "Max difference in Saturation for timestep $i" $sig_digits] {
+    if ![pftestFileWithKeyBound $runname.out.satur.$i.pfb "Max difference in Saturation for timestep $i" $sig_digits Solver.PrintSaturation.ErrorBound] {
     set passed 0
 }
 }
@@ -0,0 +1,15 @@
+#
+# Run the default_richards_wells problem with PFB/PFSB output written by
+# the background writer thread with a single staging buffer, so every
+# dump waits for the previous one.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname default_richards_wells_background
+
+pfset PFB.Writer                         Background
+pfset PFB.Writer.QueueDepth              1
+
+source default_richards_wells.tcl
@@ -0,0 +1,13 @@
+#
+# Run the default_richards_wells problem with the GMRES basis
+# orthogonalized by classical Gram-Schmidt with reorthogonalization.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname default_richards_wells_cgs2
+
+pfset Solver.Linear.Orthogonalization    ClassicalGS2
+
+source default_richards_wells.tcl
@@ -0,0 +1,15 @@
+#
+# Run the default_richards_wells problem with error-bounded lossy
+# pressure and saturation output, compared with the regression files
+# within the error bounds.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname default_richards_wells_lossy
+
+pfset Solver.PrintPressure.ErrorBound    1.0e-3
+pfset Solver.PrintSaturation.ErrorBound  1.0e-4
+
+source default_richards_wells.tcl
@@ -0,0 +1,14 @@
+#
+# Run the default_richards_wells problem with the pipelined GMRES linear
+# solver.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname default_richards_wells_pipelined
+
+pfset Solver.Linear.KrylovMethod         PipelinedGMRES
+pfset Solver.Linear.PrintHistory         True
+
+source default_richards_wells.tcl
@@ -0,0 +1,15 @@
+#
+# Run the default_richards_wells problem with the saturation files
+# written in single precision and compressed; they agree with the
+# regression files to the tested number of digits.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname default_richards_wells_single
+
+pfset Solver.PrintSaturation.SinglePrecision True
+pfset PFB.Compression                        Deflate
+
+source default_richards_wells.tcl
@@ -5,6 +5,12 @@ lappend auto_path $env(PARFLOW_DIR)/bin
 package require parflow
 namespace import Parflow::*
 
+# default_single_*.tcl run this deck under their own runname and are
+# checked against its regression files, see pftestCorrectFile
+set pftest_base_run default_single
+if ![info exists runname] {
+    set runname default_single
+}
 
 #-----------------------------------------------------------------------------
 # File input version number
@@ -325,8 +331,8 @@ pfset Solver.MaxIter 5
 #-----------------------------------------------------------------------------
 # Run and Unload the ParFlow output files
 #-----------------------------------------------------------------------------
-pfrun default_single
-pfundist default_single
+pfrun $runname
+pfundist $runname
 
 # To run with debugging
 # pfrun default_single -g {0 1}
@@ -341,28 +347,28 @@ set sig_digits 4
 
 set passed 1
 
-if ![pftestFile default_single.out.press.00000.pfb "Max difference in Pressure" $sig_digits] {
+if ![pftestFile $runname.out.press.00000.pfb "Max difference in Pressure" $sig_digits] {
     set passed 0
 }
 
-if ![pftestFile default_single.out.perm_x.pfb "Max difference in perm_x" $sig_digits] {
+if ![pftestFile $runname.out.perm_x.pfb "Max difference in perm_x" $sig_digits] {
     set passed 0
 }
-if ![pftestFile default_single.out.perm_y.pfb "Max difference in perm_y" $sig_digits] {
+if ![pftestFile $runname.out.perm_y.pfb "Max difference in perm_y" $sig_digits] {
     set passed 0
 }
-if ![pftestFile default_single.out.perm_z.pfb "Max difference in perm_z" $sig_digits] {
+if ![pftestFile $runname.out.perm_z.pfb "Max difference in perm_z" $sig_digits] {
     set passed 0
 }
 
 foreach i "00000 00001 00002 00003 00004 00005" {
-    if ![pftestFile default_single.out.concen.0.00.$i.pfsb "Max difference in concen timestep $i" $sig_digits] {
+    if ![pftestFile $runname.out.concen.0.00.$i.pfsb "Max difference in concen timestep $i" $sig_digits] {
     set passed 0
     }
 }
 
 if $passed {
-    puts "default_single : PASSED"
+    puts "$runname : PASSED"
 } {
-    puts "default_single : FAILED"
+    puts "$runname : FAILED"
 }
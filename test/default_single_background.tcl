@@ -0,0 +1,13 @@
+#
+# Run the default_single problem with PFB/PFSB output written by the
+# background writer thread.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname default_single_background
+
+pfset PFB.Writer Background
+
+source default_single.tcl
@@ -0,0 +1,12 @@
+#
+# Run the default_single problem with lossless compressed PFB output.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname default_single_compressed
+
+pfset PFB.Compression Deflate
+
+source default_single.tcl
@@ -0,0 +1,13 @@
+#
+# Run the default_single problem with PFB/PFSB output shipped to two
+# dedicated I/O server ranks.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname default_single_ioservers
+
+pfset Process.IOServers 2
+
+source default_single.tcl
@@ -0,0 +1,13 @@
+#
+# Run the default_single problem with PFB/PFSB output written using
+# collective MPI-IO.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname default_single_mpiio
+
+pfset PFB.Writer MPIIO
+
+source default_single.tcl
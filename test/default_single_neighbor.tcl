@@ -0,0 +1,13 @@
+#
+# Run the default_single problem with halo exchanges done using MPI
+# neighborhood collectives.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname default_single_neighbor
+
+pfset Process.HaloExchange Neighbor
+
+source default_single.tcl
@@ -0,0 +1,14 @@
+#
+# Run the default_single problem with halo exchanges packed into
+# explicit buffers and the per neighbor exchange timing enabled.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname default_single_packed
+
+pfset Process.HaloExchange         Packed
+pfset Process.HaloExchange.Timing  True
+
+source default_single.tcl
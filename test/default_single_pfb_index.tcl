@@ -0,0 +1,13 @@
+#
+# Run the default_single problem with a subgrid index appended to the
+# PFB output, which readers ignore.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname default_single_pfb_index
+
+pfset PFB.Index True
+
+source default_single.tcl
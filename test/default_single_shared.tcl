@@ -0,0 +1,15 @@
+#
+# Run the default_single problem with vector data in the node shared
+# memory arena so halo values of neighbors on the same node are copied
+# directly.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname default_single_shared
+
+pfset Process.HaloExchange               Shared
+pfset Process.HaloExchange.SharedMemory  64
+
+source default_single.tcl
@@ -0,0 +1,14 @@
+#
+# Run the default_single problem with subfiled PFB output, three
+# processes per subfile.
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname default_single_subfile
+
+pfset PFB.Writer              Subfile
+pfset PFB.Writer.SubfileRanks 3
+
+source default_single.tcl
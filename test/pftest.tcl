@@ -18,11 +18,27 @@ proc eps {{base 1}} {
     set eps     [expr {$eps+1e-22}]
 }
 
+#
+# Regression file for an output file.  Variant decks set the keys they
+# exercise and a runname of their own, then source a base deck that
+# names itself in pftest_base_run.  A variant must reproduce the base
+# results, so its outputs are checked against the base regression files.
+#
+proc pftestCorrectFile {file} {
+    global runname pftest_base_run
+    if {[info exists pftest_base_run] && [info exists runname] &&
+	[string first $runname.out. $file] == 0} {
+	return correct_output/$pftest_base_run[string range $file [string length $runname] end]
+    }
+    return correct_output/$file
+}
+
 proc pftestFile {file message sig_digits} {
     if [file exists $file] {
-	if [file exists correct_output/$file] {
+	set correct_file [pftestCorrectFile $file]
+	if [file exists $correct_file] {
 
-	    set correct [pfload correct_output/$file]
+	    set correct [pfload $correct_file]
 	    set new     [pfload                $file]
 	    set diff [pfmdiff $new $correct $sig_digits]
 	    if {[string length $diff] != 0 } {
@@ -53,7 +69,7 @@ proc pftestFile {file message sig_digits} {
 		return 1
 	    }
 	} {
-	    puts "FAILED : regression check output file <correct_output/$file> does not exist"
+	    puts "FAILED : regression check output file <$correct_file> does not exist"
 	}
     } {
 	puts "FAILED : output file <$file> not created"
@@ -63,7 +79,7 @@ proc pftestFile {file message sig_digits} {
 
 proc pftestFileWithAbs {file message sig_digits abs_value} {
     if [file exists $file] {
-	set correct [pfload correct_output/$file]
+	set correct [pfload [pftestCorrectFile $file]]
 	set new     [pfload                $file]
 	set diff [pfmdiff $new $correct $sig_digits]
 	if {[string length $diff] != 0 } {
@@ -97,6 +113,44 @@ proc pftestFileWithAbs {file message sig_digits abs_value} {
     }
 }
 
+#
+# Compare against the regression file allowing an absolute difference
+# of up to bound everywhere, e.g. for output written with an error bound.
+#
+proc pftestFileWithBound {file message bound} {
+    if [file exists $file] {
+	set correct [pfload [pftestCorrectFile $file]]
+	set new     [pfload                $file]
+	set diff [pfmdiff $new $correct 15]
+	if {[string length $diff] != 0 } {
+	    set maxAbsDiff [lindex $diff 1]
+
+	    if [expr $maxAbsDiff > $bound] {
+		puts "FAILED : $message"
+		puts [format "\tMaximum absolute difference = %e exceeds bound %e" \
+			  $maxAbsDiff $bound]
+		return 0
+	    }
+	}
+
+	return 1
+    } {
+	puts "FAILED : output file <$file> not created"
+	return 0
+    }
+}
+
+#
+# Compare as pftestFile does, or within the error bound given by key
+# when the run wrote the file with one.
+#
+proc pftestFileWithKeyBound {file message sig_digits key} {
+    if {[Parflow::pfexists $key] && [pfget $key] > 0.0} {
+	return [pftestFileWithBound $file $message [pfget $key]]
+    }
+    return [pftestFile $file $message $sig_digits]
+}
+
 proc pftestParseAndEvaluateOutputForTCL {file} {
 
     if [file exists $file] {